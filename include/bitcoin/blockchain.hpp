@@ -21,26 +21,47 @@
 #endif
 
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/error.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/version.hpp>
 #include <bitcoin/blockchain/interface/block_chain.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/latency_histogram.hpp>
+#include <bitcoin/blockchain/interface/rate_counter.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/interface/store_accounting.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
+#include <bitcoin/blockchain/interface/utxo_commitment.hpp>
 #include <bitcoin/blockchain/organizers/block_organizer.hpp>
 #include <bitcoin/blockchain/organizers/header_organizer.hpp>
+#include <bitcoin/blockchain/organizers/insert_organizer.hpp>
+#include <bitcoin/blockchain/organizers/notification_queue.hpp>
 #include <bitcoin/blockchain/organizers/transaction_organizer.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/organizers/validation_pools.hpp>
 #include <bitcoin/blockchain/pools/anchor_converter.hpp>
 #include <bitcoin/blockchain/pools/block_entry.hpp>
+#include <bitcoin/blockchain/pools/block_orphan_pool.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/pools/child_closure_calculator.hpp>
 #include <bitcoin/blockchain/pools/conflicting_spend_remover.hpp>
+#include <bitcoin/blockchain/pools/forest.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
 #include <bitcoin/blockchain/pools/header_pool.hpp>
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
 #include <bitcoin/blockchain/pools/parent_closure_calculator.hpp>
+#include <bitcoin/blockchain/pools/pooled_index.hpp>
 #include <bitcoin/blockchain/pools/priority_calculator.hpp>
+#include <bitcoin/blockchain/pools/spend_index.hpp>
 #include <bitcoin/blockchain/pools/stack_evaluator.hpp>
 #include <bitcoin/blockchain/pools/transaction_entry.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics_cache.hpp>
 #include <bitcoin/blockchain/pools/transaction_order_calculator.hpp>
+#include <bitcoin/blockchain/pools/transaction_orphan_pool.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool_state.hpp>
 #include <bitcoin/blockchain/populate/populate_base.hpp>
@@ -48,6 +69,7 @@
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
 #include <bitcoin/blockchain/populate/populate_header.hpp>
 #include <bitcoin/blockchain/populate/populate_transaction.hpp>
+#include <bitcoin/blockchain/populate/prefetch_block.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 #include <bitcoin/blockchain/validate/validate_header.hpp>
 #include <bitcoin/blockchain/validate/validate_input.hpp>
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ERROR_HPP
+#define LIBBITCOIN_BLOCKCHAIN_ERROR_HPP
+
+#include <string>
+#include <system_error>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Codes of the "blockchain" category, for conditions that have no
+/// equivalent in the system error codes.
+enum class chain_error
+{
+    /// The block body or transaction is retained (or not) by the store, but
+    /// is below the pruned height and so is not served.
+    pruned = 1
+};
+
+class BCB_API chain_error_category
+  : public std::error_category
+{
+public:
+    static const chain_error_category& singleton();
+
+    virtual const char* name() const BC_NOEXCEPT;
+    virtual std::string message(int value) const;
+};
+
+BCB_API code make_error_code(chain_error value);
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+namespace std {
+
+template <>
+struct is_error_code_enum<bc::blockchain::chain_error>
+  : public true_type
+{
+};
+
+} // namespace std
+
+#endif
@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_FOREST_IPP
+#define LIBBITCOIN_BLOCKCHAIN_FOREST_IPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+template <typename Element>
+size_t forest<Element>::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return nodes_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+size_t forest<Element>::roots() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return roots_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+bool forest<Element>::add(Element element, const hash_digest& hash,
+    const hash_digest& parent, size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (nodes_.find(hash) != nodes_.end())
+        return false;
+
+    auto& added = nodes_[hash];
+    added.element = std::move(element);
+    added.parent = parent;
+    added.height = height;
+    added.root = roots_.end();
+
+    // Add a back pointer from the parent for clearing the path later.
+    const auto it = nodes_.find(parent);
+
+    if (it == nodes_.end())
+        plant(hash, added);
+    else
+        it->second.children.push_back(hash);
+
+    publish({ hash }, {});
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+bool forest<Element>::replace(const hash_digest& hash, Element element)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    const auto it = nodes_.find(hash);
+
+    if (it == nodes_.end())
+        return false;
+
+    // Membership is unchanged, so the snapshot is not republished.
+    it->second.element = std::move(element);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+void forest<Element>::remove(const hash_list& hashes)
+{
+    hash_list orphans;
+    hash_list removed;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto& hash: hashes)
+    {
+        const auto it = nodes_.find(hash);
+
+        if (it == nodes_.end())
+            continue;
+
+        const auto& children = it->second.children;
+        orphans.insert(orphans.end(), children.begin(), children.end());
+
+        if (is_root(it->second))
+            roots_.erase(it->second.root);
+
+        nodes_.erase(it);
+        removed.push_back(hash);
+    }
+
+    // Move all children that we have orphaned to the root.
+    for (const auto& hash: orphans)
+    {
+        const auto it = nodes_.find(hash);
+
+        // Except for sub-branches all children should have been deleted above.
+        if (it != nodes_.end() && !is_root(it->second))
+            plant(hash, it->second);
+    }
+
+    publish({}, removed);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+hash_list forest<Element>::prune(size_t minimum_height)
+{
+    hash_list expired;
+    hash_list pruned;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Roots are height ordered, so iteration stops at the first current root.
+    while (!roots_.empty() && roots_.begin()->first < minimum_height)
+    {
+        expired.push_back(roots_.begin()->second);
+        roots_.erase(roots_.begin());
+    }
+
+    if (expired.empty())
+        return pruned;
+
+    // Delete expired nodes and span their children, replanting current ones.
+    while (!expired.empty())
+    {
+        const auto hash = expired.back();
+        expired.pop_back();
+        const auto it = nodes_.find(hash);
+
+        if (it == nodes_.end())
+            continue;
+
+        for (const auto& child: it->second.children)
+        {
+            const auto next = nodes_.find(child);
+
+            if (next == nodes_.end())
+                continue;
+
+            if (next->second.height < minimum_height)
+                expired.push_back(child);
+            else
+                plant(child, next->second);
+        }
+
+        nodes_.erase(it);
+        pruned.push_back(hash);
+    }
+
+    publish({}, pruned);
+    return pruned;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+bool forest<Element>::contains(const hash_digest& hash) const
+{
+    const auto shard = std::atomic_load(&snapshot_[hash.front()]);
+    return shard && shard->find(hash) != shard->end();
+}
+
+template <typename Element>
+Element forest<Element>::find(const hash_digest& hash) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto it = nodes_.find(hash);
+    return it == nodes_.end() ? Element{} : it->second.element;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+Element forest<Element>::root(size_t height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto it = roots_.find(height);
+
+    if (it == roots_.end())
+        return{};
+
+    return nodes_.find(it->second)->second.element;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+bool forest<Element>::ancestors(elements& out_ancestors,
+    const hash_digest& hash, const hash_digest& parent) const
+{
+    out_ancestors.clear();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (nodes_.find(hash) != nodes_.end())
+        return false;
+
+    for (auto it = nodes_.find(parent); it != nodes_.end();
+        it = nodes_.find(it->second.parent))
+        out_ancestors.push_back(it->second.element);
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+template <typename Element>
+bool forest<Element>::is_root(const node& node) const
+{
+    return node.root != roots_.end();
+}
+
+// private
+template <typename Element>
+void forest<Element>::plant(const hash_digest& hash, node& node)
+{
+    node.root = roots_.emplace(node.height, hash);
+}
+
+// private
+// Copy on write of each changed shard, once per write, so that readers hold
+// no lock and the cost of a write is proportional to the shards it changes.
+template <typename Element>
+void forest<Element>::publish(const hash_list& added,
+    const hash_list& removed)
+{
+    std::map<size_t, std::shared_ptr<hash_set>> changes;
+
+    const auto change = [&](const hash_digest& hash) -> hash_set&
+    {
+        const size_t index = hash.front();
+        auto& shard = changes[index];
+
+        if (!shard)
+        {
+            const auto& current = snapshot_[index];
+            shard = current ? std::make_shared<hash_set>(*current) :
+                std::make_shared<hash_set>();
+        }
+
+        return *shard;
+    };
+
+    for (const auto& hash: added)
+        change(hash).insert(hash);
+
+    for (const auto& hash: removed)
+        change(hash).erase(hash);
+
+    for (const auto& shard: changes)
+        std::atomic_store(&snapshot_[shard.first], hash_set_ptr(shard.second));
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
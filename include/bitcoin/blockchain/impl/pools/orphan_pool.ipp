@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ORPHAN_POOL_IPP
+#define LIBBITCOIN_BLOCKCHAIN_ORPHAN_POOL_IPP
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+template <typename Element>
+orphan_pool<Element>::orphan_pool(size_t maximum_count, size_t maximum_bytes)
+  : maximum_count_(maximum_count),
+    maximum_bytes_(maximum_bytes),
+    bytes_(0)
+{
+}
+
+template <typename Element>
+size_t orphan_pool<Element>::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return entries_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+size_t orphan_pool<Element>::bytes() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return bytes_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+bool orphan_pool<Element>::add(Element element, const hash_digest& hash,
+    hash_list parents, size_t size)
+{
+    if (maximum_count_ == 0 || size > maximum_bytes_ || parents.empty())
+        return false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (hashes_.find(hash) != hashes_.end())
+        return false;
+
+    evict(maximum_count_ - 1u, maximum_bytes_ - size);
+
+    for (const auto& parent: parents)
+        parents_.emplace(parent, hash);
+
+    bytes_ += size;
+    entries_.push_back({ std::move(element), hash, std::move(parents), size });
+    hashes_.emplace(hash, std::prev(entries_.end()));
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+template <typename Element>
+typename orphan_pool<Element>::elements orphan_pool<Element>::remove(
+    const hash_digest& parent)
+{
+    elements children;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    // Copy child hashes as erasure invalidates the parent index range.
+    hash_list hashes;
+    const auto range = parents_.equal_range(parent);
+    for (auto it = range.first; it != range.second; ++it)
+        hashes.push_back(it->second);
+
+    for (const auto& hash: hashes)
+    {
+        const auto it = hashes_.find(hash);
+
+        if (it == hashes_.end())
+            continue;
+
+        children.push_back(it->second->element);
+        erase(it->second);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    return children;
+}
+
+template <typename Element>
+bool orphan_pool<Element>::exists(const hash_digest& hash) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return hashes_.find(hash) != hashes_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+template <typename Element>
+void orphan_pool<Element>::erase(iterator it)
+{
+    const auto hash = it->hash;
+
+    // Remove only the links of this child, siblings remain indexed.
+    for (const auto& parent: it->parents)
+    {
+        const auto range = parents_.equal_range(parent);
+
+        for (auto link = range.first; link != range.second; ++link)
+        {
+            if (link->second == hash)
+            {
+                parents_.erase(link);
+                break;
+            }
+        }
+    }
+
+    bytes_ -= it->size;
+    hashes_.erase(hash);
+    entries_.erase(it);
+}
+
+// private
+// Evict oldest entries until the buffer is within the specified limits.
+template <typename Element>
+void orphan_pool<Element>::evict(size_t count, size_t bytes)
+{
+    while (!entries_.empty() && (entries_.size() > count || bytes_ > bytes))
+        erase(entries_.begin());
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -24,14 +24,24 @@
 #include <cstdint>
 #include <ctime>
 #include <functional>
+#include <mutex>
 #include <vector>
+#include <boost/filesystem.hpp>
 #include <bitcoin/database.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/interface/store_accounting.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
+#include <bitcoin/blockchain/interface/utxo_commitment.hpp>
 #include <bitcoin/blockchain/organizers/block_organizer.hpp>
 #include <bitcoin/blockchain/organizers/header_organizer.hpp>
+#include <bitcoin/blockchain/organizers/insert_organizer.hpp>
 #include <bitcoin/blockchain/organizers/transaction_organizer.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/organizers/validation_pools.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 
@@ -98,6 +108,12 @@ public:
         const chain::output_point& outpoint, size_t branch_height,
         bool require_confirmed) const;
 
+    /// Get the outputs at the indexes of one previous transaction.
+    bool get_outputs(chain::output::list& out_outputs, size_t& out_height,
+        uint32_t& out_median_time_past, bool& out_coinbase,
+        const hash_digest& hash, const std::vector<uint32_t>& indexes,
+        size_t branch_height, bool require_confirmed) const;
+
     /// Determine if an unspent transaction exists with the given hash.
     bool get_is_unspent_transaction(const hash_digest& hash,
         size_t branch_height, bool require_confirmed) const;
@@ -106,6 +122,17 @@ public:
     bool get_transaction_position(size_t& out_height, size_t& out_position,
         const hash_digest& hash, bool require_confirmed) const;
 
+    /// Get the cached metrics of a pool transaction, empty if not cached.
+    transaction_metrics::const_ptr get_transaction_metrics(
+        const hash_digest& hash) const;
+
+    /// Get the validated forks of an indexed pool transaction.
+    bool get_pooled_forks(uint32_t& out_forks,
+        const hash_digest& hash) const;
+
+    /// Fault in the store pages of the output referenced by the outpoint.
+    void prefetch_output(const chain::output_point& outpoint) const;
+
     /////// Get the transaction of the given hash and its block height.
     ////transaction_ptr get_transaction(size_t& out_block_height,
     ////    const hash_digest& hash, bool require_confirmed) const;
@@ -286,6 +313,10 @@ public:
     /// Organize a block into the block pool if valid.
     void organize(block_const_ptr block, result_handler handler);
 
+    /// Insert a block at a height under the top checkpoint if valid.
+    void organize(block_const_ptr block, size_t height,
+        result_handler handler);
+
     /// Organize a header into the header pool if valid.
     void organize(header_const_ptr header, result_handler handler);
 
@@ -301,6 +332,44 @@ public:
     /// Get a reference to the blockchain configuration settings.
     const settings& chain_settings() const;
 
+    /// The number of block and transaction notifications pending delivery.
+    size_t notification_depth() const;
+
+    /// The number of transaction notifications dropped due to capacity.
+    size_t notification_dropped() const;
+
+    /// The greater of block and transaction notification delivery lags.
+    asio::duration notification_lag() const;
+
+    /// Organizer stage latencies and confirmed throughput.
+    chain_statistics::report statistics() const;
+
+    /// Validation reads of the store by call type (zero if not enabled).
+    store_accounting::counters store_reads() const;
+
+    /// Wait and hold times of the organizer critical section.
+    validation_mutex::report lock_statistics() const;
+
+    /// Processor utilization of each validation pool since the prior call.
+    validation_pools::utilizations pool_utilization() const;
+
+    /// Write retained trace spans to the file (requires WITH_TRACING).
+    bool dump_trace(const boost::filesystem::path& file) const;
+
+    /// Block bodies below this height are not served (zero if not pruned).
+    /// This includes the bodies of a store bootstrapped from a utxo snapshot.
+    /// Pruning is serving-only, pruned bodies are not deleted from the store.
+    size_t pruned_height() const;
+
+    /// The unspent output set commitment and the height of its top block,
+    /// false if the commitment is not synchronized with the store.
+    bool get_utxo_commitment(hash_digest& out_commitment,
+        size_t& out_height) const;
+
+    /// Recompute the commitment by scanning the store and persist it. This
+    /// holds the validation critical section for the duration of the scan.
+    bool rebuild_utxo_commitment();
+
 protected:
 
     /// Determine if work should terminate early with service stopped code.
@@ -319,25 +388,77 @@ private:
         result_handler handler) const;
     void handle_block(const code& ec, block_const_ptr block,
         result_handler handler) const;
-    void handle_reorganize(const code& ec, block_const_ptr top,
+    void handle_reorganize(const code& ec,
+        block_const_ptr_list_const_ptr incoming_blocks,
+        block_const_ptr_list_const_ptr outgoing_blocks,
         result_handler handler);
+    void log_statistics();
+
+    // Pruning.
+    //-------------------------------------------------------------------------
+
+    bool is_pruned(size_t height) const;
+    bool is_bootstrapped(size_t height) const;
+    void load_bootstrap();
+
+    // UTXO commitment.
+    //-------------------------------------------------------------------------
+
+    bool get_top(hash_digest& out_hash, size_t& out_height) const;
+    bool get_prevout(chain::output& out_output,
+        const chain::output_point& outpoint) const;
+    bool index_headers();
+    void index_headers(block_const_ptr_list_const_ptr incoming_blocks,
+        block_const_ptr_list_const_ptr outgoing_blocks);
+    void load_commitment();
+    bool scan_commitment(utxo_commitment& out_commitment,
+        size_t top_height) const;
+    void update_commitment(block_const_ptr_list_const_ptr incoming_blocks,
+        block_const_ptr_list_const_ptr outgoing_blocks);
+    void persist_commitment() const;
+    bool store_commitment(const hash_digest& top, size_t height,
+        const hash_digest& value) const;
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     const settings& settings_;
     const time_t notify_limit_seconds_;
+    const size_t prune_depth_;
+    const asio::seconds statistics_interval_;
     bc::atomic<block_const_ptr> last_block_;
     bc::atomic<transaction_const_ptr> last_transaction_;
     const populate_chain_state chain_state_populator_;
-    bc::atomic<chain::chain_state::ptr> pool_state_;
+    mutable bc::atomic<chain::chain_state::ptr> pool_state_;
     database::data_base database_;
+    const boost::filesystem::path spends_file_;
+    const boost::filesystem::path bootstrap_file_;
+
+    // This is set at start, before the chain is started.
+    size_t bootstrap_height_;
+
+    // These are protected by commitment mutex.
+    const boost::filesystem::path commitment_file_;
+    bool commitment_current_;
+    size_t commitment_height_;
+    hash_digest commitment_top_;
+    utxo_commitment commitment_;
+    mutable shared_mutex commitment_mutex_;
+
+    // This serializes writes of the commitment file.
+    mutable std::mutex persist_mutex_;
+
+    // This is protected by the validation mutex.
+    asio::time_point statistics_logged_;
 
     // These are thread safe.
-    mutable prioritized_mutex validation_mutex_;
-    mutable threadpool priority_pool_;
-    mutable dispatcher dispatch_;
+    mutable validation_mutex validation_mutex_;
+    mutable validation_pools pools_;
+    chain_statistics statistics_;
+    mutable store_accounting accounting_;
+    header_index headers_;
     header_organizer header_organizer_;
     block_organizer block_organizer_;
+    insert_organizer insert_organizer_;
     transaction_organizer transaction_organizer_;
 };
 
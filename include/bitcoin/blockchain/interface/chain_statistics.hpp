@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_CHAIN_STATISTICS_HPP
+#define LIBBITCOIN_BLOCKCHAIN_CHAIN_STATISTICS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/latency_histogram.hpp>
+#include <bitcoin/blockchain/interface/rate_counter.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe (lock free).
+/// Latency histograms for each organizer stage of blocks, headers and
+/// transactions, and rolling throughput of confirmed blocks.
+class BCB_API chain_statistics
+{
+public:
+    enum class subject
+    {
+        block,
+        header,
+        transaction
+    };
+
+    enum class stage
+    {
+        /// Waiting on the validation mutex.
+        wait,
+
+        /// Context free checks.
+        check,
+
+        /// Chain state and prevout population.
+        populate,
+
+        /// Contextual checks (other than scripts).
+        accept,
+
+        /// Script validation.
+        connect,
+
+        /// Store write (reorganize or push).
+        store,
+
+        /// Enqueue through subscriber notification.
+        notify
+    };
+
+    static const size_t subjects = 3;
+    static const size_t stages = 7;
+
+    typedef std::array<latency_histogram::summary, stages> stage_summaries;
+
+    struct report
+    {
+        std::array<stage_summaries, subjects> latencies;
+        uint64_t blocks;
+        uint64_t transactions;
+        uint64_t inputs;
+        uint64_t bytes;
+        double blocks_per_second;
+        double transactions_per_second;
+        double inputs_per_second;
+        double bytes_per_second;
+        size_t notification_depth;
+        size_t notification_dropped;
+        asio::duration notification_lag;
+    };
+
+    chain_statistics();
+
+    /// Record the latency of a stage.
+    void record(subject kind, stage step, const asio::duration& latency);
+
+    /// Record the latency of a stage from its start, returning the end.
+    asio::time_point record(subject kind, stage step,
+        const asio::time_point& start);
+
+    /// Count blocks that have been written to the chain.
+    void confirmed(const block_const_ptr_list& blocks);
+
+    /// A snapshot of all statistics (notification fields are not set).
+    report snapshot() const;
+
+    /// The name of a subject or stage.
+    static std::string to_string(subject kind);
+    static std::string to_string(stage step);
+
+    /// A single line summary of a report, for logging.
+    static std::string to_string(const report& values);
+
+private:
+    std::array<std::array<latency_histogram, stages>, subjects> histograms_;
+    rate_counter blocks_;
+    rate_counter transactions_;
+    rate_counter inputs_;
+    rate_counter bytes_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -20,9 +20,12 @@
 #define LIBBITCOIN_BLOCKCHAIN_FAST_CHAIN_HPP
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 #include <bitcoin/database.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -83,6 +86,14 @@ public:
         const chain::output_point& outpoint, size_t branch_height,
         bool require_confirmed) const = 0;
 
+    /// Get the outputs at the indexes of one previous transaction, with a
+    /// single transaction read. Outputs at invalid indexes are invalid.
+    virtual bool get_outputs(chain::output::list& out_outputs,
+        size_t& out_height, uint32_t& out_median_time_past,
+        bool& out_coinbase, const hash_digest& hash,
+        const std::vector<uint32_t>& indexes, size_t branch_height,
+        bool require_confirmed) const = 0;
+
     /// Determine if an unspent transaction exists with the given hash.
     virtual bool get_is_unspent_transaction(const hash_digest& hash,
         size_t branch_height, bool require_confirmed) const = 0;
@@ -92,6 +103,19 @@ public:
         size_t& out_position, const hash_digest& hash,
         bool require_confirmed) const = 0;
 
+    /// Get the cached metrics of a pool transaction, empty if not cached.
+    virtual transaction_metrics::const_ptr get_transaction_metrics(
+        const hash_digest& hash) const = 0;
+
+    /// Get the validated forks of an indexed pool transaction, without a
+    /// store read. False if not indexed, which does not imply not pooled.
+    virtual bool get_pooled_forks(uint32_t& out_forks,
+        const hash_digest& hash) const = 0;
+
+    /// Fault in the store pages of the output referenced by the outpoint.
+    /// This is advisory and may be called concurrently with writes.
+    virtual void prefetch_output(const chain::output_point& outpoint) const = 0;
+
     /////// Get the transaction of the given hash and its block height.
     ////virtual transaction_ptr get_transaction(size_t& out_block_height,
     ////    const hash_digest& hash, bool require_confirmed) const = 0;
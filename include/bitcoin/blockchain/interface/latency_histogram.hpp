@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_LATENCY_HISTOGRAM_HPP
+#define LIBBITCOIN_BLOCKCHAIN_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe (lock free).
+/// A log-linear histogram of latencies in microseconds. Each power of two
+/// range is split into sixteen buckets, so that percentiles are reported to
+/// within about six percent of the recorded value.
+class BCB_API latency_histogram
+{
+public:
+    /// Latencies are in microseconds.
+    struct summary
+    {
+        uint64_t count;
+        uint64_t total;
+        uint64_t mean;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t maximum;
+    };
+
+    latency_histogram();
+
+    /// Record a latency, negative durations are recorded as zero.
+    void record(const asio::duration& latency);
+
+    /// Record a latency in microseconds.
+    void record(uint64_t microseconds);
+
+    /// A summary of the recorded latencies, consistent only when quiescent.
+    summary snapshot() const;
+
+protected:
+    static const size_t sub_buckets = 16;
+    static const size_t buckets = 528;
+
+    static size_t bucket(uint64_t microseconds);
+    static uint64_t value(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, buckets> counts_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> total_;
+    std::atomic<uint64_t> maximum_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_RATE_COUNTER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_RATE_COUNTER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe (lock free).
+/// A rolling per second rate over a window of whole seconds. A slot that is
+/// rolled over concurrently with an add may lose that add (approximate).
+class BCB_API rate_counter
+{
+public:
+    /// The window is limited to fifteen seconds.
+    rate_counter(size_t window_seconds=10);
+
+    /// Add to the count of the current second.
+    void add(uint64_t value);
+
+    /// The total of all values added.
+    uint64_t total() const;
+
+    /// The average per second over the window, excluding the current second.
+    double rate() const;
+
+protected:
+    static const size_t slots = 16;
+
+    void add(uint64_t value, uint64_t second);
+    double rate(uint64_t second) const;
+
+    static uint64_t now();
+
+private:
+    struct slot
+    {
+        std::atomic<uint64_t> second;
+        std::atomic<uint64_t> value;
+    };
+
+    const size_t window_;
+    std::array<slot, slots> slots_;
+    std::atomic<uint64_t> total_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
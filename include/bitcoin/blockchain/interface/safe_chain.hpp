@@ -83,6 +83,8 @@ public:
     // Node Queries.
     // ------------------------------------------------------------------------
 
+    /// Block and spent transaction fetches below the pruned height of a
+    /// pruned chain return chain_error::pruned (not error::not_found).
     virtual void fetch_block(size_t height, bool witness,
         block_fetch_handler handler) const = 0;
 
@@ -174,6 +176,8 @@ public:
     //-------------------------------------------------------------------------
 
     virtual void organize(block_const_ptr block, result_handler handler) = 0;
+    virtual void organize(block_const_ptr block, size_t height,
+        result_handler handler) = 0;
     virtual void organize(header_const_ptr header, result_handler handler) = 0;
     virtual void organize(transaction_const_ptr tx, result_handler handler) = 0;
 
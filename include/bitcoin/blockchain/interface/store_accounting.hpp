@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_STORE_ACCOUNTING_HPP
+#define LIBBITCOIN_BLOCKCHAIN_STORE_ACCOUNTING_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe (lock free).
+/// Counts and times validation reads of the store by call type. Block reads
+/// are also accumulated separately, for attribution to the validated block.
+/// Faults are the major page faults incurred by the reading thread during the
+/// read (zero where not supported), distinguishing reads that were served
+/// from memory from those that waited on the file system.
+class BCB_API store_accounting
+{
+public:
+    enum class call
+    {
+        /// get_transaction_position (pool discovery).
+        transaction_position,
+
+        /// get_is_unspent_transaction (duplicate transaction).
+        unspent_transaction,
+
+        /// get_output (previous output).
+        output,
+
+        /// get_block_hash, get_header, get_bits, get_timestamp, get_version.
+        header,
+
+        /// get_branch_work.
+        branch_work
+    };
+
+    static const size_t calls = 5;
+
+    struct counter
+    {
+        uint64_t count;
+        uint64_t microseconds;
+        uint64_t faults;
+    };
+
+    typedef std::array<counter, calls> counters;
+
+    /// Times a read from construction to destruction (if enabled).
+    class BCB_API timer
+    {
+    public:
+        timer(store_accounting& accounting, call type, bool block);
+        ~timer();
+
+    private:
+        store_accounting& accounting_;
+        const call type_;
+        const bool block_;
+        const asio::time_point start_;
+        const uint64_t faults_;
+    };
+
+    store_accounting(bool enabled);
+
+    /// Accounting is disabled by configuration.
+    bool enabled() const;
+
+    /// Record a read, accumulating to the block if specified.
+    void record(call type, bool block, const asio::duration& elapsed,
+        uint64_t faults);
+
+    /// The counters of all reads.
+    counters totals() const;
+
+    /// Take and clear the block reads accumulated since the last take.
+    counters take_block();
+
+    /// The name of a call type.
+    static std::string to_string(call type);
+
+    /// A single line summary of counters, for logging.
+    static std::string to_string(const counters& values);
+
+protected:
+    static uint64_t faults();
+
+private:
+    struct atomic_counter
+    {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> microseconds;
+        std::atomic<uint64_t> faults;
+    };
+
+    typedef std::array<atomic_counter, calls> atomic_counters;
+
+    const bool enabled_;
+    atomic_counters totals_;
+    atomic_counters block_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_TRACER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_TRACER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+// Spans are recorded only if the library is built with tracing. Otherwise
+// these expand to nothing and their arguments are not evaluated.
+#ifdef WITH_TRACING
+    #define BCB_TRACE_BEGIN(start) \
+        const auto start = bc::asio::steady_clock::now()
+    #define BCB_TRACE_END(start, name, block) \
+        bc::blockchain::tracer::record(name, block, start)
+#else
+    #define BCB_TRACE_BEGIN(start)
+    #define BCB_TRACE_END(start, name, block)
+#endif
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Records block processing spans into a ring buffer per thread, retaining
+/// the most recent spans of each thread. The buffers are exported in the
+/// Chrome trace event format, which is also read by Perfetto.
+class BCB_API tracer
+{
+public:
+    /// The number of spans retained by each thread.
+    static const size_t capacity = 4096;
+
+    struct span
+    {
+        const char* name;
+        hash_digest hash;
+        size_t height;
+        asio::time_point start;
+        asio::time_point end;
+    };
+
+    /// True if the library is built with tracing (WITH_TRACING).
+    static bool enabled();
+
+    /// Record a span of the block from start to now, on the calling thread.
+    /// The height is that of the block's chain state (zero if not populated).
+    static void record(const char* name, const chain::block& block,
+        const asio::time_point& start);
+
+    /// Record a span on the calling thread.
+    static void record(const span& value);
+
+    /// Write all retained spans to the file, false if tracing is disabled or
+    /// the file cannot be written.
+    static bool dump(const boost::filesystem::path& file);
+
+    /// Discard all retained spans.
+    static void clear();
+
+protected:
+    struct thread_spans;
+    typedef std::shared_ptr<thread_spans> thread_spans_ptr;
+
+    static thread_spans& local();
+    static std::vector<thread_spans_ptr> buffers();
+    static std::vector<thread_spans_ptr>& registry();
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_UTXO_COMMITMENT_HPP
+#define LIBBITCOIN_BLOCKCHAIN_UTXO_COMMITMENT_HPP
+
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is NOT thread safe.
+/// A rolling commitment to a set of unspent outputs. Each element is hashed
+/// and the hashes are summed modulo 2^256, so that the commitment is
+/// independent of the order in which outputs are added and removed.
+class BCB_API utxo_commitment
+{
+public:
+    /// The commitment of the empty set.
+    utxo_commitment();
+
+    /// The commitment of a previously obtained value.
+    utxo_commitment(const hash_digest& value);
+
+    /// Add an unspent output to the set.
+    void add(const chain::output_point& point, const chain::output& output);
+
+    /// Remove a spent output from the set.
+    void remove(const chain::output_point& point,
+        const chain::output& output);
+
+    /// Apply the additions and removals accumulated by a delta commitment.
+    void merge(const utxo_commitment& delta);
+
+    /// The commitment value.
+    hash_digest value() const;
+
+    bool operator==(const utxo_commitment& other) const;
+    bool operator!=(const utxo_commitment& other) const;
+
+protected:
+    static uint256_t element(const chain::output_point& point,
+        const chain::output& output);
+
+private:
+    uint256_t sum_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
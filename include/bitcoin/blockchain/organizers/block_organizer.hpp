@@ -25,10 +25,19 @@
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/interface/store_accounting.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
+#include <bitcoin/blockchain/organizers/notification_queue.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/organizers/validation_pools.hpp>
+#include <bitcoin/blockchain/pools/block_orphan_pool.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
+#include <bitcoin/blockchain/populate/prefetch_block.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 
@@ -47,8 +56,10 @@ public:
         block_const_ptr_list_const_ptr> reorganize_subscriber;
 
     /// Construct an instance.
-    block_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-        threadpool& thread_pool, fast_chain& chain, const settings& settings);
+    block_organizer(validation_mutex& mutex, validation_pools& pools,
+        threadpool& thread_pool, fast_chain& chain,
+        const header_index& headers, const settings& settings,
+        chain_statistics& statistics, store_accounting& accounting);
 
     bool start();
     bool stop();
@@ -60,12 +71,25 @@ public:
     /// Remove all message vectors that match block hashes.
     void filter(get_data_ptr message) const;
 
+    /// The notification queue, for depth and delivery lag.
+    const notification_queue& notifications() const;
+
 protected:
     bool stopped() const;
 
 private:
     // Utility.
     bool set_branch_height(branch::ptr branch);
+    bool is_orphan_work(block_const_ptr block) const;
+    void dump_trace(block_const_ptr block,
+        const asio::time_point& start) const;
+
+    // Organize sequence.
+    code organize_block(block_const_ptr block, bool check);
+    code organize_blocks(const block_const_ptr_list& blocks);
+    void organize_orphans(block_const_ptr parent);
+    code accept(branch::const_ptr branch);
+    code commit(block_const_ptr block);
 
     // Verify sub-sequence.
     void handle_check(const code& ec, block_const_ptr block,
@@ -83,17 +107,26 @@ private:
     void notify(size_t branch_height, block_const_ptr_list_const_ptr branch,
         block_const_ptr_list_const_ptr original);
 
-    // This must be protected by the implementation.
+    // These must be protected by the implementation.
     fast_chain& fast_chain_;
+    asio::time_point stage_start_;
 
     // These are thread safe.
-    prioritized_mutex& mutex_;
+    validation_mutex& mutex_;
     std::atomic<bool> stopped_;
     std::promise<code> resume_;
-    dispatcher& dispatch_;
+    dispatcher& query_dispatch_;
+    chain_statistics& statistics_;
+    store_accounting& accounting_;
+    const asio::duration slow_block_;
+    const boost::filesystem::path trace_directory_;
+    const bool orphan_work_floor_;
     block_pool block_pool_;
+    block_orphan_pool orphan_pool_;
+    prefetch_block prefetcher_;
     validate_block validator_;
     reorganize_subscriber::ptr subscriber_;
+    notification_queue::ptr notifications_;
 };
 
 } // namespace blockchain
@@ -24,7 +24,11 @@
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/organizers/validation_pools.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
 #include <bitcoin/blockchain/pools/header_pool.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/validate/validate_header.hpp>
@@ -33,7 +37,7 @@ namespace libbitcoin {
 namespace blockchain {
 
 /// This class is thread safe.
-/// Organises headers via the header pool.
+/// Organises headers into the header index.
 class BCB_API header_organizer
 {
 public:
@@ -41,8 +45,9 @@ public:
     typedef std::shared_ptr<header_organizer> ptr;
 
     /// Construct an instance.
-    header_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-        threadpool& thread_pool, fast_chain& chain, const settings& settings);
+    header_organizer(validation_mutex& mutex, validation_pools& pools,
+        threadpool& thread_pool, fast_chain& chain, header_index& headers,
+        const settings& settings, chain_statistics& statistics);
 
     bool start();
     bool stop();
@@ -59,15 +64,18 @@ private:
     // Verify sub-sequence.
     void handle_check(const code& ec, header_const_ptr header,
         result_handler handler);
-    void handle_accept(const code& ec, header_const_ptr header,
-        result_handler handler);
 
     void signal_completion(const code& ec);
 
+    // This is protected by the mutex.
+    asio::time_point stage_start_;
+
     // These are thread safe.
-    prioritized_mutex& mutex_;
+    validation_mutex& mutex_;
     std::atomic<bool> stopped_;
     std::promise<code> resume_;
+    chain_statistics& statistics_;
+    header_index& headers_;
     ////header_pool header_pool_;
     validate_header validator_;
 };
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_INSERT_ORGANIZER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_INSERT_ORGANIZER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Inserts blocks of arbitrary height under the top checkpoint, concurrently
+/// and in order of arrival, until the gaps up to the checkpoint are closed.
+/// A block is inserted only if its hash is in the header index at its height,
+/// so it is linked, retargeted and checkpointed by its header chain.
+/// Blocks above the top checkpoint are organized by the block organizer.
+class BCB_API insert_organizer
+{
+public:
+    typedef handle0 result_handler;
+    typedef std::shared_ptr<insert_organizer> ptr;
+
+    /// Construct an instance.
+    insert_organizer(validation_mutex& mutex, dispatcher& dispatch,
+        fast_chain& chain, const header_index& headers,
+        const settings& settings);
+
+    bool start();
+
+    /// Waits on inserts in progress, the validation mutex must be held.
+    bool stop();
+
+    /// Check and insert the block at the given height (under checkpoint).
+    void organize(block_const_ptr block, size_t height,
+        result_handler handler);
+
+    /// True if there are gaps remaining up to the top checkpoint.
+    bool active() const;
+
+    /// The number of heights remaining up to the top checkpoint.
+    size_t remaining() const;
+
+protected:
+    bool stopped() const;
+
+private:
+    // A reserved height is linked to its neighbors but not yet stored.
+    struct reservation
+    {
+        hash_digest hash;
+        hash_digest parent;
+    };
+
+    typedef std::unordered_map<size_t, reservation> reservations;
+
+    // Insert sequence.
+    void insert(block_const_ptr block, size_t height,
+        result_handler handler);
+    code reserve(block_const_ptr block, size_t height);
+    void release(size_t height);
+    void close();
+    void abort();
+
+    // These require a lock on the reservations.
+    bool initialize();
+    bool get_hash(hash_digest& out_hash, size_t height) const;
+    bool get_parent(hash_digest& out_parent, size_t height) const;
+
+    // This must be protected by the implementation.
+    fast_chain& fast_chain_;
+
+    // These are thread safe.
+    validation_mutex& validation_mutex_;
+    std::atomic<bool> stopped_;
+    std::atomic<bool> active_;
+    std::atomic<size_t> remaining_;
+    dispatcher& dispatch_;
+    const header_index& headers_;
+    const size_t top_checkpoint_height_;
+
+    // These are protected by mutex.
+    bool initialized_;
+    reservations reserved_;
+    std::condition_variable_any released_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_NOTIFICATION_QUEUE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_NOTIFICATION_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// A bounded queue of subscriber notifications, delivered in order on the
+/// threadpool so that subscriber handlers never run within the validation
+/// critical section. Batched notifications are coalesced over an interval
+/// and delivered by a single threadpool job. Enqueue never blocks, as it is
+/// called under the validation lock, so a full queue drops (and counts) the
+/// notification.
+class BCB_API notification_queue
+  : public enable_shared_from_base<notification_queue>
+{
+public:
+    typedef std::function<void()> notifier;
+    typedef std::shared_ptr<notification_queue> ptr;
+
+    /// A zero capacity implies no limit, a zero interval implies no batching.
+    notification_queue(threadpool& pool, size_t capacity,
+        const asio::duration& batch_interval);
+
+    void start();
+    void stop();
+
+    /// Enqueue a notification, false if stopped or dropped due to capacity.
+    /// Batched notifications are delayed by up to the batch interval.
+    bool enqueue(notifier&& notification, bool batch);
+
+    /// The number of notifications pending delivery.
+    size_t depth() const;
+
+    /// The number of notifications dropped due to capacity.
+    size_t dropped() const;
+
+    /// The enqueue-to-delivery latency of the most recent delivery.
+    asio::duration lag() const;
+
+private:
+    struct item
+    {
+        notifier notification;
+        asio::time_point enqueued;
+    };
+
+    typedef std::vector<item> items;
+
+    void drain();
+    void handle_timer(const code& ec);
+
+    // These are thread safe.
+    threadpool& pool_;
+    const size_t capacity_;
+    const asio::duration batch_interval_;
+    std::atomic<size_t> depth_;
+    std::atomic<size_t> dropped_;
+    std::atomic<asio::duration::rep> lag_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    bool draining_;
+    bool timer_pending_;
+    items queue_;
+    deadline::ptr timer_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
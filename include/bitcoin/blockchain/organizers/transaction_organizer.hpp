@@ -24,10 +24,20 @@
 #include <cstdint>
 #include <future>
 #include <memory>
+#include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/organizers/notification_queue.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/organizers/validation_pools.hpp>
+#include <bitcoin/blockchain/pools/pooled_index.hpp>
+#include <bitcoin/blockchain/pools/spend_index.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics_cache.hpp>
+#include <bitcoin/blockchain/pools/transaction_orphan_pool.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/validate/validate_transaction.hpp>
@@ -48,34 +58,64 @@ public:
     typedef resubscriber<code, transaction_const_ptr> transaction_subscriber;
 
     /// Construct an instance.
-    transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-        threadpool& thread_pool, fast_chain& chain, const settings& settings);
+    transaction_organizer(validation_mutex& mutex, validation_pools& pools,
+        threadpool& thread_pool, fast_chain& chain, const settings& settings,
+        chain_statistics& statistics);
 
     bool start();
     bool stop();
 
     void organize(transaction_const_ptr tx, result_handler handler);
+    void reorganize(block_const_ptr_list_const_ptr incoming_blocks,
+        block_const_ptr_list_const_ptr outgoing_blocks);
     void subscribe(transaction_handler&& handler);
     void unsubscribe();
 
     void fetch_template(merkle_block_fetch_handler) const;
     void fetch_mempool(size_t maximum, inventory_fetch_handler) const;
 
+    /// Get the cached metrics of a pool transaction, empty if not cached.
+    transaction_metrics::const_ptr metrics(const hash_digest& hash) const;
+
+    /// Restore the pool spend index saved by a prior (clean) shutdown.
+    bool load_spends(const boost::filesystem::path& file);
+
+    /// Save the pool spend index, for restoration on startup.
+    bool save_spends(const boost::filesystem::path& file) const;
+
+    /// Get the validated forks of a pool transaction stored since startup.
+    bool pooled_forks(uint32_t& out_forks, const hash_digest& hash) const;
+
+    /// The notification queue, for depth and delivery lag.
+    const notification_queue& notifications() const;
+
 protected:
     bool stopped() const;
-    uint64_t price(transaction_const_ptr tx) const;
+    uint64_t price(const transaction_metrics& metrics) const;
 
 private:
+    typedef std::shared_ptr<std::promise<code>> promise_ptr;
+
+    // Organize sub-sequence.
+    code organize_transaction(transaction_const_ptr tx, bool check);
+    void organize_orphans(transaction_const_ptr parent);
+    void organize_released(transaction_const_ptr_list orphans);
+    code validate(transaction_const_ptr tx, bool check,
+        transaction_metrics::const_ptr& out_metrics);
+    code push(transaction_const_ptr tx);
+    void signal_completion(const code& ec, promise_ptr resume);
+
     // Verify sub-sequence.
     void handle_check(const code& ec, transaction_const_ptr tx,
+        asio::time_point start, transaction_metrics::const_ptr& out_metrics,
         result_handler handler);
     void handle_accept(const code& ec, transaction_const_ptr tx,
+        asio::time_point start, transaction_metrics::const_ptr& out_metrics,
         result_handler handler);
     void handle_connect(const code& ec, transaction_const_ptr tx,
-        result_handler handler);
+        asio::time_point start, result_handler handler);
     void handle_pushed(const code& ec, transaction_const_ptr tx,
         result_handler handler);
-    void signal_completion(const code& ec);
 
     // Subscription.
     void notify(transaction_const_ptr tx);
@@ -84,14 +124,21 @@ private:
     fast_chain& fast_chain_;
 
     // These are thread safe.
-    prioritized_mutex& mutex_;
+    validation_mutex& mutex_;
     std::atomic<bool> stopped_;
-    std::promise<code> resume_;
+    mutable shared_mutex validation_mutex_;
     const settings& settings_;
-    dispatcher& dispatch_;
+    dispatcher& query_dispatch_;
+    dispatcher orphan_dispatch_;
+    chain_statistics& statistics_;
     transaction_pool transaction_pool_;
+    transaction_orphan_pool orphan_pool_;
+    transaction_metrics_cache metrics_;
+    spend_index spend_index_;
+    pooled_index pooled_index_;
     validate_transaction validator_;
     transaction_subscriber::ptr subscriber_;
+    notification_queue::ptr notifications_;
 };
 
 } // namespace blockchain
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_VALIDATION_MUTEX_HPP
+#define LIBBITCOIN_BLOCKCHAIN_VALIDATION_MUTEX_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/latency_histogram.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// The organizer critical section lock. High priority (block and header)
+/// callers are admitted ahead of low priority (transaction) callers, but
+/// once the fairness limit of consecutive high priority grants has been made
+/// while a low priority caller waits, that caller is admitted next. Wait and
+/// hold times are recorded by priority class and by caller.
+class BCB_API validation_mutex
+{
+public:
+    enum class caller
+    {
+        block,
+        header,
+        transaction,
+        chain
+    };
+
+    enum class priority
+    {
+        high,
+        low
+    };
+
+    static const size_t callers = 4;
+    static const size_t priorities = 2;
+
+    typedef std::array<latency_histogram::summary, callers> caller_summaries;
+    typedef std::array<latency_histogram::summary, priorities>
+        priority_summaries;
+
+    struct report
+    {
+        caller_summaries caller_waits;
+        caller_summaries caller_holds;
+        priority_summaries priority_waits;
+        priority_summaries priority_holds;
+
+        /// Low priority grants made ahead of waiting high priority callers.
+        uint64_t fair_grants;
+    };
+
+    /// If not prioritized the classes are admitted in arbitrary order.
+    /// A zero fairness limit implies strict priority (low may starve).
+    validation_mutex(bool prioritize, size_t fairness_limit);
+
+    void lock_high_priority(caller who);
+    void unlock_high_priority();
+
+    void lock_low_priority(caller who);
+    void unlock_low_priority();
+
+    /// Wait and hold time summaries, consistent only when quiescent.
+    report statistics() const;
+
+    /// The name of a caller or priority class.
+    static std::string to_string(caller who);
+    static std::string to_string(priority level);
+
+    /// A single line summary of a report, for logging.
+    static std::string to_string(const report& values);
+
+private:
+    bool is_admissible(priority level) const;
+    void lock(priority level, caller who);
+    void unlock();
+
+    // These are thread safe.
+    const bool prioritize_;
+    const size_t fairness_limit_;
+    std::array<latency_histogram, callers> caller_waits_;
+    std::array<latency_histogram, callers> caller_holds_;
+    std::array<latency_histogram, priorities> priority_waits_;
+    std::array<latency_histogram, priorities> priority_holds_;
+
+    // These are protected by mutex.
+    bool locked_;
+    size_t high_waiting_;
+    size_t low_waiting_;
+    size_t high_streak_;
+    uint64_t fair_grants_;
+    caller holder_;
+    priority level_;
+    asio::time_point acquired_;
+    mutable std::mutex mutex_;
+    std::condition_variable admitted_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_VALIDATION_POOLS_HPP
+#define LIBBITCOIN_BLOCKCHAIN_VALIDATION_POOLS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Distinct threadpools for prevout population (store bound), script and
+/// contextual verification (processor bound) and store queries and writes.
+/// The threads of each pool may be pinned to a set of processors, and the
+/// processor utilization of each pool is sampled from its threads' clocks.
+class BCB_API validation_pools
+{
+public:
+    enum class pool
+    {
+        populate,
+        verify,
+        query
+    };
+
+    static const size_t pools = 3;
+
+    typedef std::array<double, pools> utilizations;
+
+    validation_pools(const settings& settings);
+
+    dispatcher& populate();
+    dispatcher& verify();
+    dispatcher& query();
+
+    /// Register (and pin) the threads of each pool, false if pinning fails.
+    bool start();
+
+    void shutdown();
+    void join();
+
+    /// The processor time of each pool over its thread capacity, since the
+    /// prior call (or start). Zero where thread clocks are not supported.
+    utilizations utilization();
+
+    /// The name of a pool.
+    static std::string to_string(pool which);
+
+    /// A single line summary of utilizations, for logging.
+    static std::string to_string(const utilizations& values);
+
+private:
+    typedef std::vector<uint32_t> processors;
+
+    class member
+    {
+    public:
+        member(const std::string& name, size_t count, bool prioritize,
+            const processors& pinned);
+
+        bool start();
+        double utilization();
+
+        threadpool threads;
+        dispatcher dispatch;
+
+    private:
+        bool enroll(size_t index);
+        uint64_t processor_time() const;
+
+        const processors pinned_;
+
+        // These are protected by mutex.
+        std::vector<int> clocks_;
+        uint64_t processor_time_;
+        asio::time_point sampled_;
+        std::mutex mutex_;
+    };
+
+    member& get(pool which);
+
+    member populate_;
+    member verify_;
+    member query_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
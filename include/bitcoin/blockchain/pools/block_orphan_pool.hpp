@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_BLOCK_ORPHAN_POOL_HPP
+#define LIBBITCOIN_BLOCKCHAIN_BLOCK_ORPHAN_POOL_HPP
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Checked blocks whose parent is neither pooled nor chained are buffered
+/// here, indexed by previous block hash. When the parent is organized its
+/// buffered children are released for organization without being rechecked.
+/// The buffer is bounded by count and by bytes, evicting oldest entries.
+class BCB_API block_orphan_pool
+{
+public:
+    block_orphan_pool(size_t maximum_count, size_t maximum_bytes);
+
+    /// The number of blocks in the buffer.
+    size_t size() const;
+
+    /// The number of (witness serialized) bytes in the buffer.
+    size_t bytes() const;
+
+    /// Add a checked block, false if exists or won't fit.
+    bool add(block_const_ptr block);
+
+    /// Remove and return all blocks waiting on the parent.
+    block_const_ptr_list remove(const hash_digest& parent);
+
+    /// Remove all message vectors that match block hashes.
+    void filter(get_data_ptr message) const;
+
+protected:
+    // This is thread safe.
+    orphan_pool<block_const_ptr> orphans_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -20,29 +20,46 @@
 #define LIBBITCOIN_BLOCKCHAIN_BLOCK_POOL_HPP
 
 #include <cstddef>
-#include <boost/bimap.hpp>
-#include <boost/bimap/multiset_of.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database.hpp>
 #include <bitcoin/blockchain/define.hpp>
-#include <bitcoin/blockchain/pools/block_entry.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/forest.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
 
-/// This class is thread safe against concurrent filtering only.
+/// This class is thread safe.
 /// There is no search within blocks of the block pool (just hashes).
 /// The branch object contains chain query for new (leaf) block validation.
 /// All pool blocks are valid, lacking only sufficient work for reorganzation.
+/// Blocks in excess of the byte budget are spilled to a memory-mapped scratch
+/// file, oldest first, and loaded back when a path through them is traced.
 class BCB_API block_pool
 {
 public:
     block_pool(size_t maximum_depth);
 
+    /// Spilling is disabled if maximum bytes is zero or the file is empty.
+    block_pool(size_t maximum_depth, size_t maximum_bytes,
+        const boost::filesystem::path& scratch_file);
+
+    ~block_pool();
+
     // The number of blocks in the pool.
     size_t size() const;
 
+    /// The number of serialized block bytes held in memory.
+    size_t bytes() const;
+
+    /// The number of blocks held in the scratch file.
+    size_t spilled() const;
+
     /// Add newly-validated block (work insufficient to reorganize).
     void add(block_const_ptr valid_block);
 
@@ -60,26 +77,68 @@ public:
 
     /// Get the root path to and including the new block.
     /// This will be empty if the block already exists in the pool.
+    /// This will be null if a spilled ancestor cannot be read back.
     branch::ptr get_path(block_const_ptr candidate_block) const;
 
 protected:
-    // A bidirectional map is used for efficient block and position retrieval.
-    // This produces the effect of a circular buffer hash table of blocks.
-    typedef boost::bimaps::bimap<
-        boost::bimaps::unordered_set_of<block_entry>,
-        boost::bimaps::multiset_of<size_t>> block_entries;
+    // Blocks are indexed by hash, with roots also indexed by height.
+    typedef forest<block_const_ptr> block_forest;
+
+    // Resident blocks in order of admission, oldest first.
+    typedef std::list<hash_digest> hash_queue;
+
+    struct resident
+    {
+        hash_queue::iterator position;
+        size_t size;
+    };
+
+    struct extent
+    {
+        size_t offset;
+        size_t size;
+    };
+
+    // Released scratch extents by offset, coalesced with their neighbours.
+    typedef std::map<size_t, size_t> free_map;
+
+    typedef std::unordered_map<hash_digest, resident> resident_map;
+    typedef std::unordered_map<hash_digest, extent> extent_map;
 
-    void prune(const hash_list& hashes, size_t minimum_height);
     bool exists(block_const_ptr candidate_block) const;
     block_const_ptr parent(block_const_ptr block) const;
-    ////void log_content() const;
-
-    // This is thread safe.
+    static bool is_spilled(block_const_ptr block);
+
+    // These require a shared lock on the spill state.
+    bool read(block_const_ptr& out_block, block_const_ptr stub) const;
+
+    // These require an exclusive lock on the spill state.
+    void admit(const hash_digest& hash, size_t size) const;
+    void forget(const hash_digest& hash) const;
+    void spill_excess() const;
+    bool spill(const hash_digest& hash) const;
+    block_const_ptr restore(block_const_ptr block) const;
+    size_t allocate(size_t size) const;
+    void release(const extent& extent) const;
+    bool open_scratch() const;
+
+    // These are thread safe.
     const size_t maximum_depth_;
+    const size_t maximum_bytes_;
+    const boost::filesystem::path scratch_file_;
 
-    // This is guarded against filtering concurrent to writing.
-    block_entries blocks_;
-    mutable upgrade_mutex mutex_;
+    // This is thread safe.
+    block_forest blocks_;
+
+    // These are protected by mutex.
+    mutable size_t bytes_;
+    mutable size_t scratch_end_;
+    mutable hash_queue queue_;
+    mutable resident_map residents_;
+    mutable extent_map extents_;
+    mutable free_map free_;
+    mutable std::shared_ptr<database::memory_map> scratch_;
+    mutable shared_mutex mutex_;
 };
 
 } // namespace blockchain
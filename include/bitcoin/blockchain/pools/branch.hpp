@@ -25,6 +25,7 @@
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -35,6 +36,7 @@ class BCB_API branch
 public:
     typedef std::shared_ptr<branch> ptr;
     typedef std::shared_ptr<const branch> const_ptr;
+    typedef std::vector<const_ptr> const_ptr_list;
 
     /// Establish a branch with the given parent height.
     branch(size_t height=0);
@@ -54,8 +56,13 @@ public:
     /////// Populate unspent duplicate state in the context of the branch.
     ////void populate_duplicate(const chain::transaction& tx) const;
 
-    /// Populate prevout validation spend state in the context of the branch.
-    void populate_spent(const chain::output_point& outpoint) const;
+    /// The outpoints spent by all blocks of the branch except the top.
+    outpoint_table spends() const;
+
+    /// Populate prevout validation spend state in the context of the branch,
+    /// given the spends of the branch (excluding the top block).
+    void populate_spent(const outpoint_table& spends,
+        const chain::output_point& outpoint) const;
 
     /// Populate prevout validation output state in the context of the branch.
     void populate_prevout(const chain::output_point& outpoint) const;
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_FOREST_HPP
+#define LIBBITCOIN_BLOCKCHAIN_FOREST_HPP
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// A forest of elements linked by parent hash, connected to the chain at the
+/// root of each tree. Elements are indexed by hash, and roots are indexed by
+/// height, so that expired trees are pruned in order of height. Roots are
+/// deleted, pulling the tree "down", so there is never internal removal.
+/// Membership queries read immutable snapshots and never block on writers.
+/// Snapshots are sharded by hash, so a write republishes only the shards of
+/// the hashes it adds or removes, not the full membership.
+template <typename Element>
+class forest
+{
+public:
+    typedef std::vector<Element> elements;
+
+    /// The number of elements in the forest.
+    size_t size() const;
+
+    /// The number of roots (trees) in the forest.
+    size_t roots() const;
+
+    /// Add an element, as a root if the parent is not in the forest.
+    /// Returns false if an element of the same hash exists.
+    bool add(Element element, const hash_digest& hash,
+        const hash_digest& parent, size_t height);
+
+    /// Replace the element of the given hash, false if not found.
+    bool replace(const hash_digest& hash, Element element);
+
+    /// Remove elements, replanting orphaned children as roots.
+    void remove(const hash_list& hashes);
+
+    /// Remove trees rooted below minimum height, and their descendants also
+    /// below minimum height, replanting remaining children as roots.
+    /// Returns the hashes of the removed elements.
+    hash_list prune(size_t minimum_height);
+
+    /// Determine if the hash exists in the forest (never blocks).
+    bool contains(const hash_digest& hash) const;
+
+    /// Get the element of the given hash, or empty if not found.
+    Element find(const hash_digest& hash) const;
+
+    /// Get the first root at the given height, or empty if not found.
+    Element root(size_t height) const;
+
+    /// Get ancestors in the forest of a new element, nearest first.
+    /// Returns false if the element itself exists in the forest.
+    bool ancestors(elements& out_ancestors, const hash_digest& hash,
+        const hash_digest& parent) const;
+
+private:
+    typedef std::multimap<size_t, hash_digest> root_index;
+    typedef std::unordered_set<hash_digest> hash_set;
+    typedef std::shared_ptr<const hash_set> hash_set_ptr;
+
+    // Hashes are uniformly distributed, so the first byte selects a shard.
+    static const size_t shards = 256;
+    typedef std::array<hash_set_ptr, shards> snapshot;
+
+    struct node
+    {
+        Element element;
+        hash_digest parent;
+        size_t height;
+        hash_list children;
+        typename root_index::iterator root;
+    };
+
+    typedef std::unordered_map<hash_digest, node> node_index;
+
+    bool is_root(const node& node) const;
+    void plant(const hash_digest& hash, node& node);
+    void publish(const hash_list& added, const hash_list& removed);
+
+    // These are protected by mutex.
+    node_index nodes_;
+    root_index roots_;
+    mutable upgrade_mutex mutex_;
+
+    // Shards are published under the mutex and read without it.
+    snapshot snapshot_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#include <bitcoin/blockchain/impl/pools/forest.ipp>
+
+#endif
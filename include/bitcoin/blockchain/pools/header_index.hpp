@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_HEADER_INDEX_HPP
+#define LIBBITCOIN_BLOCKCHAIN_HEADER_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// The chain of headers with the most work anchored at the genesis block,
+/// indexed by height. Each header is linked to its predecessor, its proof of
+/// work and its contextual (chain state) bits and timestamp are verified and
+/// checkpoints are enforced. So a block that matches the index at its height
+/// is an ancestor of every later indexed header. Competing headers within one
+/// retargeting interval of the top are retained as side branches, and a side
+/// branch replaces the indexed branch once its cumulative work is greater.
+class BCB_API header_index
+{
+public:
+    header_index(const settings& settings);
+
+    /// Reset the index to the (trusted) genesis header.
+    void start(const chain::header& genesis);
+
+    /// The height of the top indexed header.
+    size_t top_height() const;
+
+    /// The accumulated work of the indexed headers.
+    uint256_t work() const;
+
+    /// Get the hash indexed at the height, false if not indexed.
+    bool get_hash(hash_digest& out_hash, size_t height) const;
+
+    /// True if the hash is indexed at the height.
+    bool is_indexed(const hash_digest& hash, size_t height) const;
+
+    /// Add linked headers, the first of which must link to the index within
+    /// one retargeting interval of its top, or to a retained side branch.
+    /// Headers already added are skipped.
+    code add(const chain::header::list& headers);
+
+    /// Re-sync the index with a reorganization of the store, retaining the
+    /// outgoing headers and adding the incoming headers.
+    code reorganize(const chain::header::list& incoming,
+        const chain::header::list& outgoing);
+
+protected:
+    struct entry
+    {
+        hash_digest hash;
+        uint32_t bits;
+        uint32_t version;
+        uint32_t timestamp;
+    };
+
+    struct side_entry
+    {
+        entry header;
+        hash_digest parent;
+        size_t height;
+
+        // The cumulative work of the chain to and including the header.
+        uint256_t work;
+    };
+
+    typedef std::vector<entry> entries;
+    typedef std::unordered_map<hash_digest, side_entry> side_map;
+
+    // These require a lock on the index.
+    bool find_indexed(size_t& out_height, const hash_digest& hash) const;
+    bool trace(size_t& out_fork, entries& out_branch, uint256_t& out_work,
+        const hash_digest& parent) const;
+    uint256_t work_at(size_t height) const;
+    const entry& at(size_t height, size_t fork, const entries& branch) const;
+    bool populate(chain::chain_state::data& data, size_t height, size_t fork,
+        const entries& path) const;
+    code validate(const chain::header& header, size_t height, size_t fork,
+        const entries& branch) const;
+    void link(const entry& header, const hash_digest& parent, size_t fork,
+        const entries& branch, const uint256_t& work);
+    void prune();
+
+    // These are thread safe.
+    const uint32_t forks_;
+    const config::checkpoint::list checkpoints_;
+
+    // These are protected by mutex.
+    entries entries_;
+    side_map side_;
+    uint256_t work_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
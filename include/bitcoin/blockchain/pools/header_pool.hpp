@@ -20,18 +20,15 @@
 #define LIBBITCOIN_BLOCKCHAIN_HEADER_POOL_HPP
 
 #include <cstddef>
-#include <boost/bimap.hpp>
-#include <boost/bimap/multiset_of.hpp>
-#include <boost/bimap/unordered_set_of.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
-#include <bitcoin/blockchain/pools/block_entry.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/forest.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
 
-/// This class is thread safe against concurrent filtering only.
+/// This class is thread safe.
 /// There is no search within blocks of the block pool (just hashes).
 /// The branch object contains chain query for new (leaf) block validation.
 /// All pool blocks are valid, lacking only sufficient work for reorganzation.
@@ -63,23 +60,17 @@ public:
     branch::ptr get_path(block_const_ptr candidate_block) const;
 
 protected:
-    // A bidirectional map is used for efficient block and position retrieval.
-    // This produces the effect of a circular buffer hash table of blocks.
-    typedef boost::bimaps::bimap<
-        boost::bimaps::unordered_set_of<block_entry>,
-        boost::bimaps::multiset_of<size_t>> block_entries;
+    // Blocks are indexed by hash, with roots also indexed by height.
+    typedef forest<block_const_ptr> block_forest;
 
-    void prune(const hash_list& hashes, size_t minimum_height);
     bool exists(block_const_ptr candidate_block) const;
     block_const_ptr parent(block_const_ptr block) const;
-    ////void log_content() const;
 
     // This is thread safe.
     const size_t maximum_depth_;
 
-    // This is guarded against filtering concurrent to writing.
-    block_entries blocks_;
-    mutable upgrade_mutex mutex_;
+    // This is thread safe.
+    block_forest blocks_;
 };
 
 } // namespace blockchain
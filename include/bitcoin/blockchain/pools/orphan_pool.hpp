@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ORPHAN_POOL_HPP
+#define LIBBITCOIN_BLOCKCHAIN_ORPHAN_POOL_HPP
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// A buffer of elements waiting on one or more missing parents, indexed by
+/// element hash and by parent hash. When a parent arrives its children are
+/// removed for organization. The buffer is bounded by count and by bytes,
+/// evicting oldest entries.
+template <typename Element>
+class orphan_pool
+{
+public:
+    typedef std::vector<Element> elements;
+
+    orphan_pool(size_t maximum_count, size_t maximum_bytes);
+
+    /// The number of elements in the buffer.
+    size_t size() const;
+
+    /// The number of bytes in the buffer, as sized by the caller.
+    size_t bytes() const;
+
+    /// Add an element waiting on the parents, false if exists or won't fit.
+    bool add(Element element, const hash_digest& hash, hash_list parents,
+        size_t size);
+
+    /// Remove and return all elements waiting on the parent.
+    elements remove(const hash_digest& parent);
+
+    /// Determine if the hash exists in the buffer.
+    bool exists(const hash_digest& hash) const;
+
+private:
+    struct entry
+    {
+        Element element;
+        hash_digest hash;
+        hash_list parents;
+        size_t size;
+    };
+
+    typedef std::list<entry> entries;
+    typedef typename entries::iterator iterator;
+    typedef std::unordered_map<hash_digest, iterator> hash_index;
+    typedef std::unordered_multimap<hash_digest, hash_digest> parent_index;
+
+    void erase(iterator it);
+    void evict(size_t count, size_t bytes);
+
+    // These are thread safe.
+    const size_t maximum_count_;
+    const size_t maximum_bytes_;
+
+    // These are protected by mutex.
+    size_t bytes_;
+    entries entries_;
+    hash_index hashes_;
+    parent_index parents_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#include <bitcoin/blockchain/impl/pools/orphan_pool.ipp>
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_OUTPOINT_TABLE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_OUTPOINT_TABLE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is not thread safe (but is safe for concurrent reads).
+/// The previous outputs spent by the non-coinbase inputs of blocks, sorted by
+/// (hash, index). Outpoints of the same previous transaction are adjacent, so
+/// each distinct previous transaction may be read once, and double spends are
+/// adjacent equal outpoints. References the outpoints of the blocks, which
+/// must outlive the table.
+class BCB_API outpoint_table
+{
+public:
+    typedef std::vector<const chain::output_point*> list;
+    typedef list::const_iterator iterator;
+    typedef std::pair<iterator, iterator> range;
+
+    /// An empty table.
+    outpoint_table();
+
+    /// The outpoints spent by the block.
+    outpoint_table(const chain::block& block);
+
+    /// The outpoints spent by the blocks.
+    outpoint_table(const block_const_ptr_list& blocks);
+
+    /// The number of outpoints.
+    size_t size() const;
+
+    /// The number of distinct previous transactions.
+    size_t groups() const;
+
+    /// The outpoints of the distinct previous transaction at the position.
+    range group(size_t position) const;
+
+    /// True if the outpoint is spent (binary search).
+    bool contains(const chain::output_point& outpoint) const;
+
+    /// True if any outpoint is spent more than once (linear).
+    bool is_double_spend() const;
+
+protected:
+    static bool less(const chain::output_point& left,
+        const chain::output_point& right);
+
+    void add(const chain::block& block);
+    void sort();
+
+private:
+    // Sorted outpoints and the offset of each group, terminated by size.
+    list outpoints_;
+    std::vector<size_t> groups_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
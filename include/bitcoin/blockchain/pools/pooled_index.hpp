@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_POOLED_INDEX_HPP
+#define LIBBITCOIN_BLOCKCHAIN_POOLED_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <boost/circular_buffer.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// An index of unconfirmed (pool) transactions in the store, with the fork
+/// flags under which each was validated, so that block population determines
+/// pooled and current state without a store read. Transactions pooled before
+/// startup are not indexed and capacity is bounded with the oldest entry
+/// dropped, so a miss is not authoritative.
+class BCB_API pooled_index
+{
+public:
+    /// The forks of a transaction pooled by the pop of its block.
+    static const uint32_t unverified;
+
+    pooled_index(size_t capacity);
+
+    /// The number of indexed transactions.
+    size_t size() const;
+
+    /// True and the validated forks if the transaction is indexed.
+    bool find(uint32_t& out_forks, const hash_digest& hash) const;
+
+    /// Index the transaction, as stored under the given forks.
+    void add(const chain::transaction& tx, uint32_t forks);
+
+    /// Index the transactions of blocks popped from the chain (unverified).
+    void add(const block_const_ptr_list& outgoing_blocks);
+
+    /// Remove the transaction (evicted or otherwise no longer pooled).
+    void remove(const hash_digest& hash);
+
+    /// Remove the transactions confirmed by the blocks.
+    void remove(const block_const_ptr_list& incoming_blocks);
+
+private:
+    // Entries are tagged by insertion so that a stale order slot (left by
+    // a remove) cannot evict a subsequent insertion of the same hash.
+    typedef std::pair<uint32_t, uint64_t> entry;
+    typedef std::unordered_map<hash_digest, entry> forks_map;
+    typedef std::pair<hash_digest, uint64_t> slot;
+
+    // This requires a unique lock on the index.
+    void insert(const hash_digest& hash, uint32_t forks);
+
+    // These are protected by mutex.
+    uint64_t sequence_;
+    forks_map pooled_;
+    boost::circular_buffer<slot> order_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
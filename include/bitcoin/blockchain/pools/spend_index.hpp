@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_SPEND_INDEX_HPP
+#define LIBBITCOIN_BLOCKCHAIN_SPEND_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// An index of the previous outputs spent by unconfirmed (pool) transactions.
+/// The store does not mark spends by unconfirmed transactions, so this is the
+/// basis of pool double spend detection, in constant time per input.
+/// The store cannot enumerate its pool, so the index is persisted on close.
+class BCB_API spend_index
+{
+public:
+    /// The number of indexed spends.
+    size_t size() const;
+
+    /// The hash of the pool transaction spending the outpoint, or null_hash.
+    hash_digest spender(const chain::output_point& outpoint) const;
+
+    /// True if any input spends an outpoint indexed to another transaction.
+    bool conflicts(const chain::transaction& tx) const;
+
+    /// Index the spends of the transaction, false (and unchanged) on conflict.
+    bool add(const chain::transaction& tx);
+
+    /// Index the spends of the transactions of blocks popped from the chain.
+    void add(const block_const_ptr_list& outgoing_blocks);
+
+    /// Remove the spends of the transaction.
+    void remove(const hash_digest& tx_hash);
+
+    /// Remove the spends of transactions confirmed by the blocks and evict
+    /// conflicting spenders and their pool descendants, in one pass over the
+    /// block inputs. Returns the hashes of the evicted pool transactions.
+    hash_list remove(const block_const_ptr_list& incoming_blocks);
+
+    /// Replace the index with that saved to the file, which is then deleted
+    /// so that a subsequent unclean shutdown cannot restore a stale index.
+    bool load(const boost::filesystem::path& file);
+
+    /// Save the index to the file, replacing any existing file.
+    bool save(const boost::filesystem::path& file) const;
+
+protected:
+    struct spender
+    {
+        chain::point::list points;
+        uint32_t outputs;
+    };
+
+    typedef std::unordered_map<chain::point, hash_digest> spend_map;
+    typedef std::unordered_map<hash_digest, spender> spender_map;
+
+    void erase(const hash_digest& tx_hash);
+    void evict(const hash_digest& tx_hash, hash_list& evicted);
+
+    // These are protected by mutex.
+    spend_map spends_;
+    spender_map spenders_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
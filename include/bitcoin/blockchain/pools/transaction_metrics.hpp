@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_TRANSACTION_METRICS_HPP
+#define LIBBITCOIN_BLOCKCHAIN_TRANSACTION_METRICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe (immutable).
+/// Size, sigop and fee metrics of a transaction, computed once upon accept.
+/// Prevouts must be populated for computation of fees and embedded sigops.
+class BCB_API transaction_metrics
+{
+public:
+    typedef std::shared_ptr<const transaction_metrics> const_ptr;
+
+    /// Compute metrics, with sigops relative to the specified forks.
+    transaction_metrics(const chain::transaction& tx, uint32_t forks);
+
+    /// The transaction hash.
+    const hash_digest& hash() const;
+
+    /// The transaction hash including witness (bip141 wtxid).
+    const hash_digest& witness_hash() const;
+
+    /// The forks used for sigop computation.
+    uint32_t forks() const;
+
+    /// True if the sigops were computed under the specified rules.
+    bool is_sigops(bool bip16, bool bip141) const;
+
+    /// The sigop count, relative to forks.
+    size_t sigops() const;
+
+    /// The wire serialized size without witness.
+    size_t size() const;
+
+    /// The wire serialized size with witness.
+    size_t witness_size() const;
+
+    /// The bip141 weight (three times size plus witness size).
+    size_t weight() const;
+
+    /// The sum of input values less the sum of output values.
+    uint64_t fees() const;
+
+    /// The number of inputs.
+    size_t inputs() const;
+
+    /// The number of outputs.
+    size_t outputs() const;
+
+private:
+    const hash_digest hash_;
+    const hash_digest witness_hash_;
+    const uint32_t forks_;
+    const size_t sigops_;
+    const size_t size_;
+    const size_t witness_size_;
+    const uint64_t fees_;
+    const size_t inputs_;
+    const size_t outputs_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_TRANSACTION_METRICS_CACHE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_TRANSACTION_METRICS_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <boost/circular_buffer.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Metrics of pool transactions by hash, so that block validation, pricing
+/// and pool entry share a single computation. Capacity is bounded with the
+/// oldest entry dropped, so a miss must always be handled by computation.
+class BCB_API transaction_metrics_cache
+{
+public:
+    transaction_metrics_cache(size_t capacity);
+
+    /// The number of cached entries.
+    size_t size() const;
+
+    /// Add or replace the metrics of a transaction.
+    void add(transaction_metrics::const_ptr metrics);
+
+    /// Get the metrics of the transaction, or empty pointer if not cached.
+    transaction_metrics::const_ptr get(const hash_digest& hash) const;
+
+    /// Remove the metrics of the transaction.
+    void remove(const hash_digest& hash);
+
+    /// Remove the metrics of all transactions of the blocks.
+    void remove(const block_const_ptr_list& blocks);
+
+private:
+    // Entries are tagged by insertion so that a stale order slot (left by
+    // a remove) cannot evict a subsequent insertion of the same hash.
+    typedef std::pair<transaction_metrics::const_ptr, uint64_t> entry;
+    typedef std::unordered_map<hash_digest, entry> metrics_map;
+    typedef std::pair<hash_digest, uint64_t> slot;
+
+    // These are protected by mutex.
+    uint64_t sequence_;
+    metrics_map metrics_;
+    boost::circular_buffer<slot> order_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
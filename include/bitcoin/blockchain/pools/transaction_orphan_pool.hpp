@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_TRANSACTION_ORPHAN_POOL_HPP
+#define LIBBITCOIN_BLOCKCHAIN_TRANSACTION_ORPHAN_POOL_HPP
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Transactions that are missing one or more previous outputs are buffered
+/// here, indexed by the hashes of the missing parents. When a parent is
+/// accepted to the pool or confirmed by a block its buffered children are
+/// released for validation. The buffer is bounded by count and by (witness
+/// serialized) bytes, evicting oldest entries.
+class BCB_API transaction_orphan_pool
+{
+public:
+    transaction_orphan_pool(size_t maximum_count, size_t maximum_bytes);
+
+    /// The number of transactions in the buffer.
+    size_t size() const;
+
+    /// The number of (witness serialized) bytes in the buffer.
+    size_t bytes() const;
+
+    /// Add a transaction whose missing parents are populated as invalid
+    /// prevout caches, false if exists, has no missing parent or won't fit.
+    bool add(transaction_const_ptr tx);
+
+    /// Remove and return all transactions waiting on the parent.
+    transaction_const_ptr_list remove(const hash_digest& parent);
+
+protected:
+    // This is thread safe.
+    orphan_pool<transaction_const_ptr> orphans_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -24,6 +24,7 @@
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 
 namespace libbitcoin {
@@ -47,6 +48,13 @@ protected:
     void populate_prevout(size_t maximum_height,
         const chain::output_point& outpoint, bool require_confirmed) const;
 
+    /// Populate a group of outpoints of one previous transaction.
+    void populate_prevouts(size_t maximum_height,
+        const outpoint_table::range& outpoints, bool require_confirmed) const;
+
+    void populate_spender(size_t maximum_height,
+        const chain::output_point& outpoint) const;
+
     // This is thread safe.
     dispatcher& dispatch_;
 
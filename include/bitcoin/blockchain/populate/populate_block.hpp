@@ -20,10 +20,12 @@
 #define LIBBITCOIN_BLOCKCHAIN_POPULATE_BLOCK_HPP
 
 #include <cstddef>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
 #include <bitcoin/blockchain/populate/populate_base.hpp>
 
 namespace libbitcoin {
@@ -41,6 +43,7 @@ public:
 
 protected:
     typedef branch::const_ptr branch_ptr;
+    typedef std::shared_ptr<const outpoint_table> table_ptr;
 
     void populate_coinbase(branch::const_ptr branch,
         block_const_ptr block) const;
@@ -48,10 +51,11 @@ protected:
     ////void populate_duplicate(branch_ptr branch,
     ////    const chain::transaction& tx) const;
 
-    void populate_transactions(branch::const_ptr branch, size_t bucket,
-        size_t buckets, result_handler handler) const;
+    void populate_transactions(branch::const_ptr branch, table_ptr outpoints,
+        table_ptr spends, size_t bucket, size_t buckets,
+        result_handler handler) const;
 
-    void populate_prevout(branch_ptr branch,
+    void populate_prevout(branch_ptr branch, const outpoint_table& spends,
         const chain::output_point& outpoint) const;
 };
 
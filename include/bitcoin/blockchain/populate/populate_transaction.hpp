@@ -38,6 +38,10 @@ public:
     /// Populate validation state for the transaction.
     void populate(transaction_const_ptr tx, result_handler&& handler) const;
 
+    /// Repopulate against the current chain state, false if the validation
+    /// state of the transaction is no longer valid (forks or prevouts differ).
+    bool repopulate(transaction_const_ptr tx) const;
+
 protected:
     void populate_inputs(transaction_const_ptr tx, size_t chain_height,
         size_t bucket, size_t buckets, result_handler handler) const;
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_PREFETCH_BLOCK_HPP
+#define LIBBITCOIN_BLOCKCHAIN_PREFETCH_BLOCK_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// This class is thread safe.
+/// Reads ahead the store pages of a checked block's prevouts, so that block
+/// population finds them resident. Prevouts are read in the reverse of the
+/// population order, so that the two passes meet rather than contend.
+class BCB_API prefetch_block
+{
+public:
+    prefetch_block(dispatcher& dispatch, const fast_chain& chain,
+        const settings& settings);
+
+    void start();
+    void stop();
+
+    /// Read ahead the prevouts of the block, to be validated at the height.
+    /// This returns immediately, the reads complete on the dispatcher.
+    void prefetch(block_const_ptr block, size_t height) const;
+
+protected:
+    bool stopped() const;
+
+    void prefetch_inputs(block_const_ptr block, size_t bucket,
+        size_t buckets) const;
+
+private:
+    static size_t checkpoint_height(const settings& settings);
+
+    // These are thread safe.
+    const bool enabled_;
+    const size_t checkpoint_height_;
+    std::atomic<bool> stopped_;
+    dispatcher& dispatch_;
+    const fast_chain& fast_chain_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -20,6 +20,7 @@
 #define LIBBITCOIN_BLOCKCHAIN_SETTINGS_HPP
 
 #include <cstdint>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
@@ -40,13 +41,38 @@ public:
     /// Properties.
     uint32_t cores;
     bool priority;
+    uint32_t populate_threads;
+    uint32_t verify_threads;
+    uint32_t query_threads;
+    std::vector<uint32_t> populate_processors;
+    std::vector<uint32_t> verify_processors;
+    std::vector<uint32_t> query_processors;
+    bool prefetch_prevouts;
     bool use_libconsensus;
     float byte_fee_satoshis;
     float sigop_fee_satoshis;
     uint64_t minimum_output_satoshis;
     uint32_t notify_limit_hours;
+    uint32_t notification_batch_milliseconds;
+    uint32_t statistics_interval_seconds;
+    bool store_accounting;
+    uint32_t trace_slow_block_milliseconds;
+    boost::filesystem::path trace_directory;
+    uint32_t validation_fairness_limit;
     uint32_t reorganization_limit;
+    uint32_t prune_depth;
+    uint64_t block_pool_bytes_limit;
+    boost::filesystem::path block_pool_file;
+    uint32_t orphan_transaction_limit;
+    uint64_t orphan_transaction_bytes_limit;
+    uint32_t orphan_block_limit;
+    uint64_t orphan_block_bytes_limit;
+    uint32_t transaction_metrics_limit;
+    uint32_t pooled_transaction_limit;
+    bool utxo_commitment_rebuild;
     config::checkpoint::list checkpoints;
+    config::checkpoint assume_valid;
+    config::hash256 minimum_chain_work;
     bool allow_collisions;
     bool easy_blocks;
     bool retarget;
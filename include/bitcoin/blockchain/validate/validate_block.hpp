@@ -27,6 +27,7 @@
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
 #include <bitcoin/blockchain/populate/populate_block.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 
@@ -39,8 +40,9 @@ class BCB_API validate_block
 public:
     typedef handle0 result_handler;
 
-    validate_block(dispatcher& dispatch, const fast_chain& chain,
-        const settings& settings);
+    validate_block(dispatcher& populate_dispatch,
+        dispatcher& verify_dispatch, const fast_chain& chain,
+        const header_index& headers, const settings& settings);
 
     void start();
     void stop();
@@ -49,6 +51,11 @@ public:
     void accept(branch::const_ptr branch, result_handler handler) const;
     void connect(branch::const_ptr branch, result_handler handler) const;
 
+    /// Connect the top blocks of the branches concurrently, setting the
+    /// validation error of each, invoking the handler when all are complete.
+    void connect(const branch::const_ptr_list& branches,
+        result_handler handler) const;
+
 protected:
     inline bool stopped() const
     {
@@ -56,6 +63,7 @@ protected:
     }
 
     float hit_rate() const;
+    bool is_assumed_valid(branch::const_ptr branch) const;
 
 private:
     typedef std::atomic<size_t> atomic_counter;
@@ -76,6 +84,8 @@ private:
         result_handler handler) const;
     void handle_accepted(const code& ec, block_const_ptr block,
         atomic_counter_ptr sigops, bool bip141, result_handler handler) const;
+    size_t signature_operations(const chain::transaction& tx, bool bip16,
+        bool bip141) const;
     void connect_inputs(block_const_ptr block, size_t bucket,
         size_t buckets, result_handler handler) const;
     void handle_connected(const code& ec, block_const_ptr block,
@@ -84,8 +94,11 @@ private:
     // These are thread safe.
     std::atomic<bool> stopped_;
     const bool use_libconsensus_;
+    const config::checkpoint assume_valid_;
+    const uint256_t minimum_chain_work_;
     const fast_chain& fast_chain_;
-    dispatcher& priority_dispatch_;
+    const header_index& headers_;
+    dispatcher& verify_dispatch_;
     mutable atomic_counter hits_;
     mutable atomic_counter queries_;
 
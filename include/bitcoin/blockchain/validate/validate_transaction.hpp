@@ -31,13 +31,14 @@
 namespace libbitcoin {
 namespace blockchain {
 
-/// This class is NOT thread safe.
+/// This class is thread safe, each call operates only on its own tx.
 class BCB_API validate_transaction
 {
 public:
     typedef handle0 result_handler;
 
-    validate_transaction(dispatcher& dispatch, const fast_chain& chain,
+    validate_transaction(dispatcher& populate_dispatch,
+        dispatcher& verify_dispatch, const fast_chain& chain,
         const settings& settings);
 
     void start();
@@ -47,6 +48,11 @@ public:
     void accept(transaction_const_ptr tx, result_handler handler) const;
     void connect(transaction_const_ptr tx, result_handler handler) const;
 
+    /// Determine if the validation of tx remains valid against current chain
+    /// state, repopulating and rechecking the tx as necessary. This must be
+    /// called only from within the validation critical section.
+    bool is_current(transaction_const_ptr tx) const;
+
 protected:
     inline bool stopped() const
     {
@@ -64,9 +70,9 @@ private:
     const bool retarget_;
     const bool use_libconsensus_;
     const fast_chain& fast_chain_;
-    dispatcher& dispatch_;
+    dispatcher& verify_dispatch_;
 
-    // Caller must not invoke accept/connect concurrently.
+    // Concurrent populations read the store, which is safe with one writer.
     populate_transaction transaction_populator_;
 };
 
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/error.hpp>
+
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+const chain_error_category& chain_error_category::singleton()
+{
+    static const chain_error_category instance;
+    return instance;
+}
+
+const char* chain_error_category::name() const BC_NOEXCEPT
+{
+    return "blockchain";
+}
+
+std::string chain_error_category::message(int value) const
+{
+    switch (static_cast<chain_error>(value))
+    {
+        case chain_error::pruned:
+            return "block or transaction pruned";
+        default:
+            return "undefined blockchain error";
+    }
+}
+
+code make_error_code(chain_error value)
+{
+    return code(static_cast<int>(value), chain_error_category::singleton());
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -24,12 +24,22 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/database.hpp>
+#include <bitcoin/blockchain/error.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
 
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 namespace libbitcoin {
 namespace blockchain {
 
@@ -40,29 +50,78 @@ using namespace std::placeholders;
 
 #define NAME "block_chain"
 
+typedef store_accounting::call call;
+
 static const auto hour_seconds = 3600u;
 
+// Bodies below the pruned height are distinguished from unknown blocks.
+static const code pruned_block = chain_error::pruned;
+
+// Flush the file's data to the device.
+static bool synchronize(const boost::filesystem::path& file)
+{
+#ifdef _WIN32
+    const auto handle = _wopen(file.wstring().c_str(), _O_RDWR | _O_BINARY);
+
+    if (handle == -1)
+        return false;
+
+    const auto result = _commit(handle) == 0;
+    _close(handle);
+    return result;
+#else
+    const auto handle = ::open(file.string().c_str(), O_RDWR);
+
+    if (handle == -1)
+        return false;
+
+    const auto result = ::fsync(handle) == 0;
+    ::close(handle);
+    return result;
+#endif
+}
+
+// The pruning depth cannot be less than the reorganization limit, as blocks
+// popped in a reorganization are required to restore the pool.
+static size_t prune_depth(const blockchain::settings& settings)
+{
+    return settings.prune_depth == 0 ? 0 :
+        std::max(settings.prune_depth, settings.reorganization_limit);
+}
+
 block_chain::block_chain(threadpool& pool,
     const blockchain::settings& chain_settings,
     const database::settings& database_settings)
   : stopped_(true),
     settings_(chain_settings),
     notify_limit_seconds_(chain_settings.notify_limit_hours * hour_seconds),
+    prune_depth_(prune_depth(chain_settings)),
+    statistics_interval_(chain_settings.statistics_interval_seconds),
     chain_state_populator_(*this, chain_settings),
     database_(database_settings),
+    spends_file_(database_settings.directory / "spend_index"),
+    bootstrap_file_(database_settings.directory / "bootstrap"),
+    bootstrap_height_(0),
+    commitment_file_(database_settings.directory / "utxo_commitment"),
+    commitment_current_(false),
+    commitment_height_(0),
+    commitment_top_(null_hash),
 
     // TODO: tune/configure this.
-    validation_mutex_(database_settings.flush_writes),
-
-    priority_pool_(thread_ceiling(chain_settings.cores),
-        priority(chain_settings.priority)),
-    dispatch_(priority_pool_, NAME "_priority"),
-    header_organizer_(validation_mutex_, dispatch_, pool, *this,
-        chain_settings),
-    block_organizer_(validation_mutex_, dispatch_, pool, *this,
+    validation_mutex_(database_settings.flush_writes,
+        chain_settings.validation_fairness_limit),
+
+    pools_(chain_settings),
+    accounting_(chain_settings.store_accounting),
+    headers_(chain_settings),
+    header_organizer_(validation_mutex_, pools_, pool, *this, headers_,
+        chain_settings, statistics_),
+    block_organizer_(validation_mutex_, pools_, pool, *this, headers_,
+        chain_settings, statistics_, accounting_),
+    insert_organizer_(validation_mutex_, pools_.query(), *this, headers_,
         chain_settings),
-    transaction_organizer_(validation_mutex_, dispatch_, pool, *this,
-        chain_settings)
+    transaction_organizer_(validation_mutex_, pools_, pool, *this,
+        chain_settings, statistics_)
 {
 }
 
@@ -72,6 +131,9 @@ block_chain::block_chain(threadpool& pool,
 
 // Readers.
 // ----------------------------------------------------------------------------
+// Validation reads are accounted by call type. Header, work, position and
+// confirmed reads are issued only under the validation mutex (not by
+// concurrent transaction validation) and so are attributed to the block.
 
 bool block_chain::get_gaps(block_database::heights& out_gaps) const
 {
@@ -86,6 +148,7 @@ bool block_chain::get_block_exists(const hash_digest& block_hash) const
 
 bool block_chain::get_block_hash(hash_digest& out_hash, size_t height) const
 {
+    store_accounting::timer timer(accounting_, call::header, true);
     const auto result = database_.blocks().get(height);
 
     if (!result)
@@ -98,6 +161,7 @@ bool block_chain::get_block_hash(hash_digest& out_hash, size_t height) const
 bool block_chain::get_branch_work(uint256_t& out_work,
     const uint256_t& maximum, size_t from_height) const
 {
+    store_accounting::timer timer(accounting_, call::branch_work, true);
     size_t top;
     if (!database_.blocks().top(top))
         return false;
@@ -118,6 +182,7 @@ bool block_chain::get_branch_work(uint256_t& out_work,
 
 bool block_chain::get_header(chain::header& out_header, size_t height) const
 {
+    store_accounting::timer timer(accounting_, call::header, true);
     auto result = database_.blocks().get(height);
     if (!result)
         return false;
@@ -139,6 +204,7 @@ bool block_chain::get_height(size_t& out_height,
 
 bool block_chain::get_bits(uint32_t& out_bits, const size_t& height) const
 {
+    store_accounting::timer timer(accounting_, call::header, true);
     auto result = database_.blocks().get(height);
     if (!result)
         return false;
@@ -150,6 +216,7 @@ bool block_chain::get_bits(uint32_t& out_bits, const size_t& height) const
 bool block_chain::get_timestamp(uint32_t& out_timestamp,
     const size_t& height) const
 {
+    store_accounting::timer timer(accounting_, call::header, true);
     auto result = database_.blocks().get(height);
     if (!result)
         return false;
@@ -161,6 +228,7 @@ bool block_chain::get_timestamp(uint32_t& out_timestamp,
 bool block_chain::get_version(uint32_t& out_version,
     const size_t& height) const
 {
+    store_accounting::timer timer(accounting_, call::header, true);
     auto result = database_.blocks().get(height);
     if (!result)
         return false;
@@ -179,6 +247,9 @@ bool block_chain::get_output(chain::output& out_output, size_t& out_height,
     const chain::output_point& outpoint, size_t branch_height,
     bool require_confirmed) const
 {
+    store_accounting::timer timer(accounting_, call::output,
+        require_confirmed);
+
     // This includes a cached value for spender height (or not_spent).
     // Get the highest tx with matching hash, at or below the branch height.
     return database_.transactions().get_output(out_output, out_height,
@@ -186,9 +257,42 @@ bool block_chain::get_output(chain::output& out_output, size_t& out_height,
         require_confirmed);
 }
 
+// The transaction is read once for all of the indexes. This bypasses the
+// store's unspent output cache, so is used only for grouped outpoints.
+bool block_chain::get_outputs(chain::output::list& out_outputs,
+    size_t& out_height, uint32_t& out_median_time_past, bool& out_coinbase,
+    const hash_digest& hash, const std::vector<uint32_t>& indexes,
+    size_t branch_height, bool require_confirmed) const
+{
+    store_accounting::timer timer(accounting_, call::output,
+        require_confirmed);
+
+    // Get the highest tx with matching hash, at or below the branch height.
+    const auto result = database_.transactions().get(hash, branch_height,
+        require_confirmed);
+
+    if (!result)
+        return false;
+
+    out_height = result.height();
+    out_median_time_past = result.median_time_past();
+    out_coinbase = (result.position() == 0);
+    out_outputs.clear();
+    out_outputs.reserve(indexes.size());
+
+    // This includes a cached value for spender height (or not_spent).
+    for (const auto index: indexes)
+        out_outputs.push_back(result.output(index));
+
+    return true;
+}
+
 bool block_chain::get_is_unspent_transaction(const hash_digest& hash,
     size_t branch_height, bool require_confirmed) const
 {
+    store_accounting::timer timer(accounting_, call::unspent_transaction,
+        require_confirmed);
+
     const auto result = database_.transactions().get(hash, branch_height,
         require_confirmed);
 
@@ -199,6 +303,10 @@ bool block_chain::get_transaction_position(size_t& out_height,
     size_t& out_position, const hash_digest& hash,
     bool require_confirmed) const
 {
+    // Only block population reads the position (pool discovery).
+    store_accounting::timer timer(accounting_, call::transaction_position,
+        true);
+
     const auto result = database_.transactions().get(hash, max_size_t,
         require_confirmed);
 
@@ -210,6 +318,31 @@ bool block_chain::get_transaction_position(size_t& out_height,
     return true;
 }
 
+// The metrics cache is not a store reader, so this is thread safe.
+transaction_metrics::const_ptr block_chain::get_transaction_metrics(
+    const hash_digest& hash) const
+{
+    return transaction_organizer_.metrics(hash);
+}
+
+bool block_chain::get_pooled_forks(uint32_t& out_forks,
+    const hash_digest& hash) const
+{
+    return transaction_organizer_.pooled_forks(out_forks, hash);
+}
+
+// The store does not expose record addresses, so pages are faulted in by an
+// unaccounted read of the output, the result of which is discarded.
+void block_chain::prefetch_output(const chain::output_point& outpoint) const
+{
+    const auto result = database_.transactions().get(outpoint.hash(),
+        max_size_t, false);
+
+    // The output may lie on a later page than the transaction metadata.
+    if (result)
+        result.output(outpoint.index());
+}
+
 ////transaction_ptr block_chain::get_transaction(size_t& out_block_height,
 ////    const hash_digest& hash, bool require_confirmed) const
 ////{
@@ -233,7 +366,12 @@ bool block_chain::begin_insert() const
 
 bool block_chain::end_insert() const
 {
-    return database_.end_insert();
+    if (!database_.end_insert())
+        return false;
+
+    // Bulk insert changes the top, so chain state is reset from the store.
+    pool_state_.store(chain_state_populator_.populate());
+    return pool_state_.load() != nullptr;
 }
 
 bool block_chain::insert(block_const_ptr block, size_t height)
@@ -269,17 +407,17 @@ void block_chain::reorganize(const checkpoint& fork_point,
         return;
     }
 
-    // The top (back) block is used to update the chain state.
     const auto complete =
         std::bind(&block_chain::handle_reorganize,
-            this, _1, incoming_blocks->back(), handler);
+            this, _1, incoming_blocks, outgoing_blocks, handler);
 
     database_.reorganize(fork_point, incoming_blocks, outgoing_blocks,
         dispatch, complete);
 }
 
-void block_chain::handle_reorganize(const code& ec, block_const_ptr top,
-    result_handler handler)
+void block_chain::handle_reorganize(const code& ec,
+    block_const_ptr_list_const_ptr incoming_blocks,
+    block_const_ptr_list_const_ptr outgoing_blocks, result_handler handler)
 {
     if (ec)
     {
@@ -287,6 +425,9 @@ void block_chain::handle_reorganize(const code& ec, block_const_ptr top,
         return;
     }
 
+    // The top (back) block is used to update the chain state.
+    const auto top = incoming_blocks->back();
+
     if (!top->validation.state)
     {
         handler(error::operation_failed);
@@ -296,9 +437,540 @@ void block_chain::handle_reorganize(const code& ec, block_const_ptr top,
     set_pool_state(*top->validation.state);
     last_block_.store(top);
 
+    // Blocks organized without prior header announcement are indexed here.
+    index_headers(incoming_blocks, outgoing_blocks);
+
+    // Roll the unspent output set commitment forward to the new top.
+    update_commitment(incoming_blocks, outgoing_blocks);
+
+    // Update the pool spend index to reflect the new chain.
+    transaction_organizer_.reorganize(incoming_blocks, outgoing_blocks);
+
+    log_statistics();
     handler(error::success);
 }
 
+// private
+// This is called from handle_reorganize, within the critical section.
+void block_chain::log_statistics()
+{
+    if (statistics_interval_ == asio::seconds::zero())
+        return;
+
+    const auto now = asio::steady_clock::now();
+
+    if (now - statistics_logged_ < statistics_interval_)
+        return;
+
+    statistics_logged_ = now;
+    LOG_INFO(LOG_BLOCKCHAIN) << chain_statistics::to_string(statistics());
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Validation lock: "
+        << validation_mutex::to_string(lock_statistics());
+
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Validation pools: "
+        << validation_pools::to_string(pool_utilization());
+
+    if (accounting_.enabled())
+        LOG_INFO(LOG_BLOCKCHAIN)
+            << "Store reads: " << store_accounting::to_string(store_reads());
+}
+
+// Pruning.
+// ----------------------------------------------------------------------------
+// Pruning is serving-only. The store does not support deletion, so pruned
+// bodies remain on disk and no space is reclaimed. Block bodies and fully
+// spent transactions below the pruned height are neither read nor served,
+// which bounds the working set (page cache) to the unpruned chain.
+// A store bootstrapped from a utxo snapshot (see initchain) has transactions
+// without inputs to the snapshot height, so none of them are served.
+
+size_t block_chain::pruned_height() const
+{
+    const auto state = pool_state_.load();
+    const auto bootstrapped = bootstrap_height_ == 0 ? 0 :
+        ceiling_add(bootstrap_height_, 1);
+
+    // The pool state height is the height of the next block.
+    if (prune_depth_ == 0 || !state)
+        return bootstrapped;
+
+    return std::max(bootstrapped,
+        floor_subtract(state->height(), ceiling_add(prune_depth_, 1)));
+}
+
+// private
+bool block_chain::is_pruned(size_t height) const
+{
+    return height < pruned_height();
+}
+
+// private
+bool block_chain::is_bootstrapped(size_t height) const
+{
+    return bootstrap_height_ != 0 && height <= bootstrap_height_;
+}
+
+// private
+// The snapshot height is recorded by initchain when it creates the store.
+void block_chain::load_bootstrap()
+{
+    bc::ifstream file(bootstrap_file_.string(), std::ios::binary);
+    istream_reader source(file);
+    const size_t height = source.read_4_bytes_little_endian();
+    bootstrap_height_ = source ? height : 0;
+}
+
+// UTXO commitment.
+// ----------------------------------------------------------------------------
+// The commitment is persisted with the hash and height of the top block to
+// which it corresponds. It is current only while that top matches the store.
+// Bulk insert does not update the commitment, so it is then not current
+// until rebuilt by a scan of the store (on demand or at start if configured).
+
+// private
+bool block_chain::get_top(hash_digest& out_hash, size_t& out_height) const
+{
+    return get_last_height(out_height) &&
+        get_block_hash(out_hash, out_height);
+}
+
+// private
+// Outputs remain in the store once spent, so any prevout can be obtained.
+bool block_chain::get_prevout(chain::output& out_output,
+    const chain::output_point& outpoint) const
+{
+    const auto& prevout = outpoint.validation;
+
+    if (prevout.cache.is_valid())
+    {
+        out_output = prevout.cache;
+        return true;
+    }
+
+    size_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+    return get_output(out_output, height, median_time_past, coinbase,
+        outpoint, max_size_t, true);
+}
+
+// private
+// The header index is seeded from the stored chain up to the first gap, so
+// that headers announced above the stored top connect to it.
+bool block_chain::index_headers()
+{
+    static const size_t batch = 2000;
+
+    size_t top;
+    chain::header header;
+
+    if (!get_last_height(top) || !get_header(header, 0))
+        return false;
+
+    headers_.start(header);
+    chain::header::list headers;
+    headers.reserve(batch);
+
+    for (size_t height = 1; height <= top && !stopped_; ++height)
+    {
+        if (!get_header(header, height))
+            break;
+
+        headers.push_back(header);
+
+        if (headers.size() == batch || height == top)
+        {
+            const auto ec = headers_.add(headers);
+            headers.clear();
+
+            if (ec)
+            {
+                LOG_ERROR(LOG_BLOCKCHAIN)
+                    << "Stored header [" << height << "] not indexed: "
+                    << ec.message();
+                return false;
+            }
+        }
+    }
+
+    // Headers read before a gap are indexed.
+    const auto ec = headers_.add(headers);
+
+    if (ec)
+        return false;
+
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Indexed stored headers to [" << headers_.top_height() << "].";
+    return true;
+}
+
+// private
+// This is called from handle_reorganize, within the critical section.
+void block_chain::index_headers(block_const_ptr_list_const_ptr incoming_blocks,
+    block_const_ptr_list_const_ptr outgoing_blocks)
+{
+    chain::header::list incoming;
+    chain::header::list outgoing;
+    incoming.reserve(incoming_blocks->size());
+    outgoing.reserve(outgoing_blocks->size());
+
+    for (const auto block: *incoming_blocks)
+        incoming.push_back(block->header());
+
+    for (const auto block: *outgoing_blocks)
+        outgoing.push_back(block->header());
+
+    // Headers are linked in order, and the store may pop the top first.
+    if (outgoing.size() > 1u &&
+        outgoing.front().previous_block_hash() == outgoing[1].hash())
+        std::reverse(outgoing.begin(), outgoing.end());
+
+    const auto ec = headers_.reorganize(incoming, outgoing);
+
+    if (ec)
+        LOG_WARNING(LOG_BLOCKCHAIN)
+            << "Header index not synchronized with the store: "
+            << ec.message();
+}
+
+void block_chain::load_commitment()
+{
+    size_t top_height;
+    hash_digest top_hash;
+
+    if (!get_top(top_hash, top_height))
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(commitment_mutex_);
+
+    // The genesis coinbase is not spendable, so a new store has no outputs.
+    if (top_height == 0)
+    {
+        commitment_ = {};
+        commitment_top_ = top_hash;
+        commitment_height_ = 0;
+        commitment_current_ = true;
+        return;
+    }
+
+    bc::ifstream file(commitment_file_.string(), std::ios::binary);
+    istream_reader source(file);
+    const auto hash = source.read_hash();
+    const size_t height = source.read_4_bytes_little_endian();
+    const auto value = source.read_hash();
+
+    commitment_ = utxo_commitment(value);
+    commitment_top_ = hash;
+    commitment_height_ = height;
+    commitment_current_ = source && hash == top_hash && height == top_height;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// The scan requires that the chain is not reorganized, and reads every output
+// of the confirmed chain. The genesis coinbase is not spendable, so is omitted.
+bool block_chain::scan_commitment(utxo_commitment& out_commitment,
+    size_t top_height) const
+{
+    chain::output output;
+    size_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+
+    for (size_t block = 1; block <= top_height; ++block)
+    {
+        chain::transaction::list txs;
+        const auto result = database_.blocks().get(block);
+
+        if (stopped() || !result ||
+            !get_transactions(txs, result.transaction_offsets(), false))
+            return false;
+
+        for (const auto& tx: txs)
+        {
+            const auto hash = tx.hash();
+            const auto count = static_cast<uint32_t>(tx.outputs().size());
+
+            for (uint32_t index = 0; index < count; ++index)
+            {
+                const chain::output_point point{ hash, index };
+
+                // The store output carries its spender height (or not spent).
+                if (!get_output(output, height, median_time_past, coinbase,
+                    point, max_size_t, true))
+                    return false;
+
+                if (output.validation.spender_height ==
+                    chain::output::validation::not_spent)
+                    out_commitment.add(point, output);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool block_chain::rebuild_utxo_commitment()
+{
+    if (stopped())
+        return false;
+
+    // Bootstrapped transactions hold placeholders for spent outputs.
+    if (bootstrap_height_ != 0)
+    {
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "The utxo commitment of a bootstrapped store cannot be rebuilt.";
+        return false;
+    }
+
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Rebuilding utxo commitment, this may take some time...";
+
+    size_t top_height;
+    hash_digest top_hash;
+    utxo_commitment scanned;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    validation_mutex_.lock_high_priority(validation_mutex::caller::chain);
+
+    const auto result = get_top(top_hash, top_height) &&
+        scan_commitment(scanned, top_height);
+
+    if (result)
+    {
+        unique_lock lock(commitment_mutex_);
+        commitment_ = scanned;
+        commitment_top_ = top_hash;
+        commitment_height_ = top_height;
+        commitment_current_ = true;
+    }
+
+    validation_mutex_.unlock_high_priority();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!result)
+    {
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "Failure rebuilding utxo commitment.";
+        return false;
+    }
+
+    persist_commitment();
+
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Rebuilt utxo commitment to block [" << top_height << "].";
+    return true;
+}
+
+// private
+// This is called from handle_reorganize, within the validation critical
+// section, which serializes updates. Prevouts are read from the store into a
+// delta before the commitment is locked, and the file is written on the
+// query pool, so neither delays readers of the commitment.
+void block_chain::update_commitment(
+    block_const_ptr_list_const_ptr incoming_blocks,
+    block_const_ptr_list_const_ptr outgoing_blocks)
+{
+    hash_digest unused;
+    size_t height;
+
+    if (!get_utxo_commitment(unused, height))
+        return;
+
+    utxo_commitment delta;
+    chain::output prevout;
+    auto current = true;
+
+    // Outgoing blocks have been popped from the store, so prevouts created
+    // within them are no longer confirmed and are resolved from the blocks.
+    std::unordered_map<chain::point, chain::output> created;
+
+    for (const auto block: *outgoing_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            const auto hash = tx.hash();
+            const auto& outputs = tx.outputs();
+
+            for (uint32_t index = 0; index < outputs.size(); ++index)
+                created.emplace(chain::point{ hash, index }, outputs[index]);
+        }
+    }
+
+    // Outgoing outputs are removed and their spent prevouts are restored.
+    for (const auto block: *outgoing_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            const auto hash = tx.hash();
+            const auto& outputs = tx.outputs();
+
+            for (uint32_t index = 0; index < outputs.size(); ++index)
+                delta.remove({ hash, index }, outputs[index]);
+
+            if (tx.is_coinbase())
+                continue;
+
+            for (const auto& input: tx.inputs())
+            {
+                const auto& outpoint = input.previous_output();
+                const auto it = created.find(outpoint);
+
+                if (it != created.end())
+                {
+                    delta.add(outpoint, it->second);
+                    continue;
+                }
+
+                current &= get_prevout(prevout, outpoint);
+                delta.add(outpoint, prevout);
+            }
+        }
+    }
+
+    // Incoming outputs are added and their spent prevouts are removed.
+    for (const auto block: *incoming_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            const auto hash = tx.hash();
+            const auto& outputs = tx.outputs();
+
+            for (uint32_t index = 0; index < outputs.size(); ++index)
+                delta.add({ hash, index }, outputs[index]);
+
+            if (tx.is_coinbase())
+                continue;
+
+            for (const auto& input: tx.inputs())
+            {
+                const auto& outpoint = input.previous_output();
+                current &= get_prevout(prevout, outpoint);
+                delta.remove(outpoint, prevout);
+            }
+        }
+    }
+
+    const auto top = incoming_blocks->back();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    commitment_mutex_.lock();
+
+    const auto was_top = [this](block_const_ptr block)
+    {
+        return block->hash() == commitment_top_;
+    };
+
+    // The commitment must correspond to the top prior to reorganization,
+    // which is either the last outgoing block or the fork point.
+    const auto& first = incoming_blocks->front()->header();
+    const auto linked = outgoing_blocks->empty() ?
+        commitment_top_ == first.previous_block_hash() :
+        was_top(outgoing_blocks->front()) || was_top(outgoing_blocks->back());
+
+    commitment_current_ = commitment_current_ && linked && current;
+
+    if (commitment_current_)
+    {
+        commitment_.merge(delta);
+        commitment_top_ = top->hash();
+        commitment_height_ = top->header().validation.height;
+    }
+
+    const auto updated = commitment_current_;
+
+    commitment_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!updated)
+    {
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "Failure updating utxo commitment at block ["
+            << top->header().validation.height << "].";
+        return;
+    }
+
+    pools_.query().concurrent(&block_chain::persist_commitment, this);
+}
+
+// private
+// Writes are serialized and each writes the latest value, so the file is
+// never rolled back by a delayed write. A failed write leaves the prior file,
+// which is then not current at the next start (see rebuild).
+void block_chain::persist_commitment() const
+{
+    hash_digest top;
+    size_t height;
+    hash_digest value;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> persist(persist_mutex_);
+
+    commitment_mutex_.lock_shared();
+    const auto current = commitment_current_;
+    top = commitment_top_;
+    height = commitment_height_;
+    value = commitment_.value();
+    commitment_mutex_.unlock_shared();
+
+    if (current && !store_commitment(top, height, value))
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "Failure writing utxo commitment at block [" << height << "].";
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// The temporary file is synchronized to the device before it replaces the
+// prior file, so that a crash leaves either the prior or the new value.
+bool block_chain::store_commitment(const hash_digest& top, size_t height,
+    const hash_digest& value) const
+{
+    auto temporary = commitment_file_;
+    temporary += ".tmp";
+
+    {
+        bc::ofstream file(temporary.string(), std::ios::binary);
+        ostream_writer sink(file);
+        sink.write_hash(top);
+        sink.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+        sink.write_hash(value);
+        file.flush();
+
+        if (!sink || file.bad())
+            return false;
+    }
+
+    if (!synchronize(temporary))
+        return false;
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temporary, commitment_file_, ec);
+    return !ec;
+}
+
+bool block_chain::get_utxo_commitment(hash_digest& out_commitment,
+    size_t& out_height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(commitment_mutex_);
+
+    if (!commitment_current_)
+        return false;
+
+    out_commitment = commitment_.value();
+    out_height = commitment_height_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 // Properties.
 // ----------------------------------------------------------------------------
 // TODO: move pool_state_ into the new transaction_pool.
@@ -353,18 +1025,40 @@ void block_chain::set_pool_state(const chain::chain_state& top)
 
 bool block_chain::start()
 {
-    stopped_ = false;
-
     if (!database_.open())
         return false;
 
+    load_bootstrap();
+    stopped_ = false;
+
     // Initialize chain state after database start and before organizers.
     pool_state_.store(chain_state_populator_.populate());
+    load_commitment();
+
+    hash_digest commitment;
+    size_t commitment_height;
+
+    // A commitment that does not match the store is rebuilt if configured.
+    if (settings_.utxo_commitment_rebuild &&
+        !get_utxo_commitment(commitment, commitment_height))
+        rebuild_utxo_commitment();
+
+    if (!index_headers())
+        return false;
+
+    // The store cannot enumerate its pool, so pool spends are persisted.
+    transaction_organizer_.load_spends(spends_file_);
+
+    // Pinning is advisory, validation proceeds on unpinned threads.
+    if (!pools_.start())
+        LOG_WARNING(LOG_BLOCKCHAIN)
+            << "Failed to pin validation threads to configured processors.";
 
     return pool_state_.load() &&
         transaction_organizer_.start() &&
         header_organizer_.start() &&
-        block_organizer_.start();
+        block_organizer_.start() &&
+        insert_organizer_.start();
 }
 
 bool block_chain::stop()
@@ -373,16 +1067,18 @@ bool block_chain::stop()
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    validation_mutex_.lock_high_priority();
+    validation_mutex_.lock_high_priority(
+        validation_mutex::caller::chain);
 
     // This cannot call organize or stop (lock safe).
     auto result = 
         transaction_organizer_.stop() &&
         header_organizer_.stop() &&
-        block_organizer_.stop();
+        block_organizer_.stop() &&
+        insert_organizer_.stop();
 
-    // The priority pool must not be stopped while organizing.
-    priority_pool_.shutdown();
+    // The validation pools must not be stopped while organizing.
+    pools_.shutdown();
 
     validation_mutex_.unlock_high_priority();
     ///////////////////////////////////////////////////////////////////////////
@@ -393,8 +1089,18 @@ bool block_chain::stop()
 // Optional as the blockchain will close on destruct.
 bool block_chain::close()
 {
+    const auto started = !stopped_;
     const auto result = stop();
-    priority_pool_.join();
+    pools_.join();
+
+    // Saved once, and only if loaded, so that a failed start cannot clear it.
+    if (started && !transaction_organizer_.save_spends(spends_file_))
+        LOG_ERROR(LOG_BLOCKCHAIN)
+            << "Failed to save the pool spend index.";
+
+    // A commitment write queued to the stopped query pool may not have run.
+    persist_commitment();
+
     return result && database_.close();
 }
 
@@ -475,6 +1181,12 @@ void block_chain::fetch_block(size_t height, bool witness,
         return;
     }
 
+    if (is_pruned(height))
+    {
+        handler(pruned_block, nullptr, 0);
+        return;
+    }
+
     transaction::list txs;
     BITCOIN_ASSERT(block_result.height() == height);
 
@@ -516,6 +1228,12 @@ void block_chain::fetch_block(const hash_digest& hash, bool witness,
         return;
     }
 
+    if (is_pruned(block_result.height()))
+    {
+        handler(pruned_block, nullptr, 0);
+        return;
+    }
+
     transaction::list txs;
 
     if (!get_transactions(txs, block_result.transaction_offsets(), witness))
@@ -724,6 +1442,16 @@ void block_chain::fetch_transaction(const hash_digest& hash,
         return;
     }
 
+    // Only unspent outputs are retained below the pruned height, and a
+    // bootstrapped transaction has no inputs.
+    if (result.position() != transaction_database::unconfirmed &&
+        (is_bootstrapped(result.height()) ||
+        (is_pruned(result.height()) && result.is_spent(max_size_t))))
+    {
+        handler(pruned_block, nullptr, 0, 0);
+        return;
+    }
+
     const auto tx = std::make_shared<const transaction>(
         result.transaction(witness));
     handler(error::success, tx, result.position(), result.height());
@@ -1122,6 +1850,13 @@ void block_chain::organize(block_const_ptr block, result_handler handler)
     block_organizer_.organize(block, handler);
 }
 
+void block_chain::organize(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    // This cannot call organize and must progress (lock safe).
+    insert_organizer_.organize(block, height, handler);
+}
+
 void block_chain::organize(header_const_ptr header, result_handler handler)
 {
     // This cannot call organize oand must progress (lock safe).
@@ -1155,6 +1890,52 @@ const settings& block_chain::chain_settings() const
     return settings_;
 }
 
+size_t block_chain::notification_depth() const
+{
+    return block_organizer_.notifications().depth() +
+        transaction_organizer_.notifications().depth();
+}
+
+size_t block_chain::notification_dropped() const
+{
+    return transaction_organizer_.notifications().dropped();
+}
+
+asio::duration block_chain::notification_lag() const
+{
+    return std::max(block_organizer_.notifications().lag(),
+        transaction_organizer_.notifications().lag());
+}
+
+chain_statistics::report block_chain::statistics() const
+{
+    auto report = statistics_.snapshot();
+    report.notification_depth = notification_depth();
+    report.notification_dropped = notification_dropped();
+    report.notification_lag = notification_lag();
+    return report;
+}
+
+store_accounting::counters block_chain::store_reads() const
+{
+    return accounting_.totals();
+}
+
+validation_mutex::report block_chain::lock_statistics() const
+{
+    return validation_mutex_.statistics();
+}
+
+validation_pools::utilizations block_chain::pool_utilization() const
+{
+    return pools_.utilization();
+}
+
+bool block_chain::dump_trace(const boost::filesystem::path& file) const
+{
+    return tracer::dump(file);
+}
+
 // protected
 bool block_chain::stopped() const
 {
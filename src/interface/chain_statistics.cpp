@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+chain_statistics::chain_statistics()
+{
+}
+
+void chain_statistics::record(subject kind, stage step,
+    const asio::duration& latency)
+{
+    histograms_[static_cast<size_t>(kind)][static_cast<size_t>(step)]
+        .record(latency);
+}
+
+asio::time_point chain_statistics::record(subject kind, stage step,
+    const asio::time_point& start)
+{
+    const auto now = asio::steady_clock::now();
+    record(kind, step, now - start);
+    return now;
+}
+
+void chain_statistics::confirmed(const block_const_ptr_list& blocks)
+{
+    for (const auto block: blocks)
+    {
+        blocks_.add(1);
+        transactions_.add(block->transactions().size());
+        inputs_.add(block->total_inputs(false));
+        bytes_.add(block->serialized_size(message::version::level::canonical));
+    }
+}
+
+chain_statistics::report chain_statistics::snapshot() const
+{
+    report result{};
+
+    for (size_t kind = 0; kind < subjects; ++kind)
+        for (size_t step = 0; step < stages; ++step)
+            result.latencies[kind][step] = histograms_[kind][step].snapshot();
+
+    result.blocks = blocks_.total();
+    result.transactions = transactions_.total();
+    result.inputs = inputs_.total();
+    result.bytes = bytes_.total();
+    result.blocks_per_second = blocks_.rate();
+    result.transactions_per_second = transactions_.rate();
+    result.inputs_per_second = inputs_.rate();
+    result.bytes_per_second = bytes_.rate();
+    return result;
+}
+
+std::string chain_statistics::to_string(subject kind)
+{
+    switch (kind)
+    {
+        case subject::block:
+            return "block";
+        case subject::header:
+            return "header";
+        case subject::transaction:
+            return "transaction";
+        default:
+            return "";
+    }
+}
+
+std::string chain_statistics::to_string(stage step)
+{
+    switch (step)
+    {
+        case stage::wait:
+            return "wait";
+        case stage::check:
+            return "check";
+        case stage::populate:
+            return "populate";
+        case stage::accept:
+            return "accept";
+        case stage::connect:
+            return "connect";
+        case stage::store:
+            return "store";
+        case stage::notify:
+            return "notify";
+        default:
+            return "";
+    }
+}
+
+// Block rates followed by the p50/p99 (microseconds) of each block stage.
+std::string chain_statistics::to_string(const report& values)
+{
+    std::ostringstream line;
+    line.precision(1);
+    line << std::fixed
+        << "blocks/s " << values.blocks_per_second
+        << ", txs/s " << values.transactions_per_second
+        << ", inputs/s " << values.inputs_per_second
+        << ", bytes/s " << values.bytes_per_second;
+
+    const auto& block = values.latencies[static_cast<size_t>(subject::block)];
+
+    for (size_t step = 0; step < stages; ++step)
+        line << ", " << to_string(static_cast<stage>(step)) << " "
+            << block[step].p50 << "/" << block[step].p99;
+
+    line << ", notify depth " << values.notification_depth
+        << ", notify dropped " << values.notification_dropped;
+    return line.str();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/latency_histogram.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Values below sixteen are recorded exactly. Above that each power of two
+// range [2^e, 2^(e+1)) maps to sixteen buckets of width 2^(e-4). Values are
+// capped at 2^36 microseconds (about 19 hours), the top of the last range.
+
+static const size_t sub_bucket_bits = 4;
+static const size_t maximum_exponent = 35;
+static const uint64_t maximum_value = (uint64_t(1) << (maximum_exponent + 1)) - 1;
+
+latency_histogram::latency_histogram()
+  : count_(0), total_(0), maximum_(0)
+{
+    for (auto& count: counts_)
+        count = 0;
+}
+
+void latency_histogram::record(const asio::duration& latency)
+{
+    const auto span = std::chrono::duration_cast<std::chrono::microseconds>(
+        latency);
+    record(span.count() < 0 ? 0 : static_cast<uint64_t>(span.count()));
+}
+
+void latency_histogram::record(uint64_t microseconds)
+{
+    counts_[bucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(microseconds, std::memory_order_relaxed);
+
+    auto maximum = maximum_.load(std::memory_order_relaxed);
+    while (microseconds > maximum &&
+        !maximum_.compare_exchange_weak(maximum, microseconds,
+            std::memory_order_relaxed));
+}
+
+latency_histogram::summary latency_histogram::snapshot() const
+{
+    std::array<uint64_t, buckets> counts;
+    uint64_t count = 0;
+
+    // The count is taken from the buckets so that percentiles are coherent.
+    for (size_t index = 0; index < buckets; ++index)
+    {
+        counts[index] = counts_[index].load(std::memory_order_relaxed);
+        count += counts[index];
+    }
+
+    summary result{};
+    result.count = count;
+    result.total = total_.load(std::memory_order_relaxed);
+    result.maximum = maximum_.load(std::memory_order_relaxed);
+    result.mean = count == 0 ? 0 : result.total / count;
+
+    if (count == 0)
+        return result;
+
+    // Nearest rank (ceiling) thresholds for each percentile.
+    const auto p50 = (count * 50 + 99) / 100;
+    const auto p90 = (count * 90 + 99) / 100;
+    const auto p99 = (count * 99 + 99) / 100;
+    uint64_t cumulative = 0;
+
+    for (size_t index = 0; index < buckets; ++index)
+    {
+        if (counts[index] == 0)
+            continue;
+
+        const auto previous = cumulative;
+        cumulative += counts[index];
+        const auto bucket_value = std::min(value(index), result.maximum);
+
+        if (previous < p50 && cumulative >= p50)
+            result.p50 = bucket_value;
+
+        if (previous < p90 && cumulative >= p90)
+            result.p90 = bucket_value;
+
+        if (previous < p99 && cumulative >= p99)
+            result.p99 = bucket_value;
+    }
+
+    return result;
+}
+
+// protected
+size_t latency_histogram::bucket(uint64_t microseconds)
+{
+    const auto value = std::min(microseconds, maximum_value);
+
+    if (value < sub_buckets)
+        return static_cast<size_t>(value);
+
+    size_t exponent = sub_bucket_bits;
+    while ((value >> (exponent + 1)) != 0)
+        ++exponent;
+
+    const auto shift = exponent - sub_bucket_bits;
+    const auto sub_bucket = static_cast<size_t>(value >> shift) - sub_buckets;
+    return sub_buckets * (shift + 1) + sub_bucket;
+}
+
+// protected
+// The midpoint of the bucket range.
+uint64_t latency_histogram::value(size_t bucket)
+{
+    if (bucket < sub_buckets)
+        return bucket;
+
+    const auto shift = bucket / sub_buckets - 1;
+    const auto sub_bucket = bucket % sub_buckets;
+    const auto lower = uint64_t(sub_buckets + sub_bucket) << shift;
+    return lower + ((uint64_t(1) << shift) >> 1);
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/rate_counter.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Slots are indexed by second modulo the slot count and tagged with their
+// second, so stale slots are ignored by rate and reset by the next add.
+
+rate_counter::rate_counter(size_t window_seconds)
+  : window_(std::max(std::min(window_seconds, slots - 1), size_t(1))),
+    total_(0)
+{
+    for (auto& slot: slots_)
+    {
+        slot.second = 0;
+        slot.value = 0;
+    }
+}
+
+void rate_counter::add(uint64_t value)
+{
+    add(value, now());
+}
+
+uint64_t rate_counter::total() const
+{
+    return total_.load(std::memory_order_relaxed);
+}
+
+double rate_counter::rate() const
+{
+    return rate(now());
+}
+
+// protected
+void rate_counter::add(uint64_t value, uint64_t second)
+{
+    auto& slot = slots_[second % slots];
+    auto tag = slot.second.load();
+
+    // The first add in a second claims and clears the slot.
+    if (tag != second && slot.second.compare_exchange_strong(tag, second))
+        slot.value.store(0);
+
+    slot.value.fetch_add(value, std::memory_order_relaxed);
+    total_.fetch_add(value, std::memory_order_relaxed);
+}
+
+// protected
+double rate_counter::rate(uint64_t second) const
+{
+    uint64_t sum = 0;
+
+    for (size_t offset = 1; offset <= window_ && offset <= second; ++offset)
+    {
+        const auto& slot = slots_[(second - offset) % slots];
+
+        if (slot.second.load() == second - offset)
+            sum += slot.value.load(std::memory_order_relaxed);
+    }
+
+    return static_cast<double>(sum) / window_;
+}
+
+// protected
+uint64_t rate_counter::now()
+{
+    const auto since = asio::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::seconds>(since).count();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/store_accounting.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Timer.
+//-----------------------------------------------------------------------------
+
+// A disabled timer does not read the clock or the thread's fault count.
+store_accounting::timer::timer(store_accounting& accounting, call type,
+    bool block)
+  : accounting_(accounting),
+    type_(type),
+    block_(block),
+    start_(accounting.enabled() ? asio::steady_clock::now() :
+        asio::time_point{}),
+    faults_(accounting.enabled() ? store_accounting::faults() : 0)
+{
+}
+
+store_accounting::timer::~timer()
+{
+    if (!accounting_.enabled())
+        return;
+
+    const auto faults = store_accounting::faults();
+    accounting_.record(type_, block_, asio::steady_clock::now() - start_,
+        faults - faults_);
+}
+
+// Accounting.
+//-----------------------------------------------------------------------------
+
+store_accounting::store_accounting(bool enabled)
+  : enabled_(enabled)
+{
+    for (const auto accumulator: { &totals_, &block_ })
+    {
+        for (auto& value: *accumulator)
+        {
+            value.count = 0;
+            value.microseconds = 0;
+            value.faults = 0;
+        }
+    }
+}
+
+bool store_accounting::enabled() const
+{
+    return enabled_;
+}
+
+void store_accounting::record(call type, bool block,
+    const asio::duration& elapsed, uint64_t faults)
+{
+    const auto span = std::chrono::duration_cast<std::chrono::microseconds>(
+        elapsed).count();
+    const auto microseconds = span < 0 ? 0 : static_cast<uint64_t>(span);
+    const auto index = static_cast<size_t>(type);
+
+    auto& total = totals_[index];
+    total.count.fetch_add(1, std::memory_order_relaxed);
+    total.microseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    total.faults.fetch_add(faults, std::memory_order_relaxed);
+
+    if (!block)
+        return;
+
+    auto& current = block_[index];
+    current.count.fetch_add(1, std::memory_order_relaxed);
+    current.microseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    current.faults.fetch_add(faults, std::memory_order_relaxed);
+}
+
+store_accounting::counters store_accounting::totals() const
+{
+    counters result;
+
+    for (size_t type = 0; type < calls; ++type)
+    {
+        const auto& total = totals_[type];
+        result[type].count = total.count.load(std::memory_order_relaxed);
+        result[type].microseconds = total.microseconds.load(
+            std::memory_order_relaxed);
+        result[type].faults = total.faults.load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+store_accounting::counters store_accounting::take_block()
+{
+    counters result;
+
+    for (size_t type = 0; type < calls; ++type)
+    {
+        auto& current = block_[type];
+        result[type].count = current.count.exchange(0);
+        result[type].microseconds = current.microseconds.exchange(0);
+        result[type].faults = current.faults.exchange(0);
+    }
+
+    return result;
+}
+
+std::string store_accounting::to_string(call type)
+{
+    switch (type)
+    {
+        case call::transaction_position:
+            return "position";
+        case call::unspent_transaction:
+            return "unspent";
+        case call::output:
+            return "output";
+        case call::header:
+            return "header";
+        case call::branch_work:
+            return "work";
+        default:
+            return "";
+    }
+}
+
+// The count, microseconds and major faults of each call type.
+std::string store_accounting::to_string(const counters& values)
+{
+    std::ostringstream line;
+
+    for (size_t type = 0; type < calls; ++type)
+    {
+        const auto& value = values[type];
+        line << (type == 0 ? "" : ", ")
+            << to_string(static_cast<call>(type)) << " " << value.count
+            << " (" << value.microseconds << "us, " << value.faults << "f)";
+    }
+
+    return line.str();
+}
+
+// protected
+// Major faults of the calling thread, so concurrent reads are not conflated.
+uint64_t store_accounting::faults()
+{
+#ifdef RUSAGE_THREAD
+    rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) == 0)
+        return static_cast<uint64_t>(usage.ru_majflt);
+#endif
+    return 0;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/tracer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// The ring of a thread is written only by its thread. The mutex is contended
+// only by export, so recording is a clock read and an uncontended lock.
+struct tracer::thread_spans
+{
+    std::mutex mutex;
+    std::vector<span> spans;
+    size_t next;
+    uint32_t thread;
+};
+
+// Buffers outlive their threads so that spans of exited threads are exported.
+static std::mutex registry_mutex;
+
+bool tracer::enabled()
+{
+#ifdef WITH_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void tracer::record(const char* name, const chain::block& block,
+    const asio::time_point& start)
+{
+    const auto state = block.validation.state;
+    record(
+    {
+        name,
+        block.hash(),
+        state ? state->height() : 0,
+        start,
+        asio::steady_clock::now()
+    });
+}
+
+void tracer::record(const span& value)
+{
+    auto& buffer = local();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+
+    if (buffer.spans.size() < capacity)
+        buffer.spans.push_back(value);
+    else
+        buffer.spans[buffer.next] = value;
+
+    buffer.next = (buffer.next + 1) % capacity;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Events are complete ("X") events in microseconds of the steady clock.
+bool tracer::dump(const boost::filesystem::path& file)
+{
+    if (!enabled())
+        return false;
+
+    struct event
+    {
+        span value;
+        uint32_t thread;
+    };
+
+    std::vector<event> events;
+
+    for (const auto& buffer: buffers())
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+
+        for (const auto& value: buffer->spans)
+            events.push_back({ value, buffer->thread });
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    std::sort(events.begin(), events.end(),
+        [](const event& left, const event& right)
+        {
+            return left.value.start < right.value.start;
+        });
+
+    bc::ofstream stream(file.string());
+
+    if (!stream.good())
+        return false;
+
+    const auto microseconds = [](const asio::duration& value)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            value).count();
+    };
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (size_t index = 0; index < events.size(); ++index)
+    {
+        const auto& value = events[index].value;
+        stream << (index == 0 ? "\n" : ",\n")
+            << "{\"name\":\"" << value.name << "\",\"ph\":\"X\",\"pid\":1"
+            << ",\"tid\":" << events[index].thread
+            << ",\"ts\":" << microseconds(value.start.time_since_epoch())
+            << ",\"dur\":" << microseconds(value.end - value.start)
+            << ",\"args\":{\"height\":" << value.height
+            << ",\"hash\":\"" << encode_hash(value.hash) << "\"}}";
+    }
+
+    stream << "\n]}\n";
+    stream.flush();
+    return stream.good();
+}
+
+void tracer::clear()
+{
+    for (const auto& buffer: buffers())
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->spans.clear();
+        buffer->next = 0;
+        ///////////////////////////////////////////////////////////////////////
+    }
+}
+
+// protected
+// The buffer of the calling thread, registered upon its first span.
+tracer::thread_spans& tracer::local()
+{
+    static thread_local thread_spans_ptr buffer;
+
+    if (buffer)
+        return *buffer;
+
+    buffer = std::make_shared<thread_spans>();
+    buffer->next = 0;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffer->thread = static_cast<uint32_t>(registry().size());
+    registry().push_back(buffer);
+    ///////////////////////////////////////////////////////////////////////////
+
+    return *buffer;
+}
+
+// protected
+// A copy of the registry, so that buffers are not locked while registering.
+std::vector<tracer::thread_spans_ptr> tracer::buffers()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const auto copy = registry();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return copy;
+}
+
+// protected
+// This is protected by the registry mutex.
+std::vector<tracer::thread_spans_ptr>& tracer::registry()
+{
+    static std::vector<thread_spans_ptr> instance;
+    return instance;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/utxo_commitment.hpp>
+
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+// The sum is of 256 bit unsigned integers, which wrap modulo 2^256. This is
+// sufficient for comparing replicas and trusted snapshots, it is not a
+// commitment that is safe against adversarially chosen sets (use MuHash).
+
+utxo_commitment::utxo_commitment()
+  : sum_(0)
+{
+}
+
+utxo_commitment::utxo_commitment(const hash_digest& value)
+  : sum_(to_uint256(value))
+{
+}
+
+void utxo_commitment::add(const output_point& point, const output& output)
+{
+    sum_ += element(point, output);
+}
+
+void utxo_commitment::remove(const output_point& point, const output& output)
+{
+    sum_ -= element(point, output);
+}
+
+void utxo_commitment::merge(const utxo_commitment& delta)
+{
+    sum_ += delta.sum_;
+}
+
+hash_digest utxo_commitment::value() const
+{
+    return from_uint256(sum_);
+}
+
+bool utxo_commitment::operator==(const utxo_commitment& other) const
+{
+    return sum_ == other.sum_;
+}
+
+bool utxo_commitment::operator!=(const utxo_commitment& other) const
+{
+    return !(*this == other);
+}
+
+// protected
+uint256_t utxo_commitment::element(const output_point& point,
+    const output& output)
+{
+    return to_uint256(sha256_hash(build_chunk(
+    {
+        point.to_data(),
+        output.to_data()
+    })));
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
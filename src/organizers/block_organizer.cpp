@@ -24,7 +24,11 @@
 #include <memory>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/store_accounting.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
+#include <bitcoin/blockchain/pools/block_orphan_pool.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/settings.hpp>
@@ -39,21 +43,41 @@ using namespace std::placeholders;
 
 #define NAME "block_organizer"
 
+typedef chain_statistics::stage stage;
+typedef validation_mutex::caller caller;
+static const auto subject = chain_statistics::subject::block;
+
 // Database access is limited to: push, pop, last-height, branch-work,
 // validator->populator:
 // spend: { spender }
 // block: { bits, version, timestamp }
 // transaction: { exists, height, output }
 
-block_organizer::block_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-    threadpool& thread_pool, fast_chain& chain, const settings& settings)
+block_organizer::block_organizer(validation_mutex& mutex,
+    validation_pools& pools, threadpool& thread_pool, fast_chain& chain,
+    const header_index& headers, const settings& settings,
+    chain_statistics& statistics, store_accounting& accounting)
   : fast_chain_(chain),
     mutex_(mutex),
     stopped_(true),
-    dispatch_(dispatch),
-    block_pool_(settings.reorganization_limit),
-    validator_(dispatch, chain, settings),
-    subscriber_(std::make_shared<reorganize_subscriber>(thread_pool, NAME))
+    query_dispatch_(pools.query()),
+    statistics_(statistics),
+    accounting_(accounting),
+    slow_block_(tracer::enabled() ?
+        asio::milliseconds(settings.trace_slow_block_milliseconds) :
+        asio::duration::zero()),
+    trace_directory_(settings.trace_directory),
+    orphan_work_floor_(settings.retarget && !settings.easy_blocks),
+    block_pool_(settings.reorganization_limit,
+        settings.block_pool_bytes_limit, settings.block_pool_file),
+    orphan_pool_(settings.orphan_block_limit,
+        settings.orphan_block_bytes_limit),
+    prefetcher_(pools.query(), chain, settings),
+    validator_(pools.populate(), pools.verify(), chain, headers, settings),
+    subscriber_(std::make_shared<reorganize_subscriber>(thread_pool, NAME)),
+    // Reorganizations are not dropped, as subscribers cannot recover them.
+    notifications_(std::make_shared<notification_queue>(thread_pool, 0,
+        asio::duration::zero()))
 {
 }
 
@@ -72,6 +96,8 @@ bool block_organizer::start()
 {
     stopped_ = false;
     subscriber_->start();
+    notifications_->start();
+    prefetcher_.start();
     validator_.start();
     return true;
 }
@@ -79,6 +105,8 @@ bool block_organizer::start()
 bool block_organizer::stop()
 {
     validator_.stop();
+    prefetcher_.stop();
+    notifications_->stop();
     subscriber_->stop();
     subscriber_->invoke(error::service_stopped, 0, {}, {});
     stopped_ = true;
@@ -91,9 +119,29 @@ bool block_organizer::stop()
 // This is called from block_chain::organize.
 void block_organizer::organize(block_const_ptr block, result_handler handler)
 {
+    const auto ec = organize_block(block, true);
+
+    // Invoke caller handler outside of critical section.
+    handler(ec);
+
+    // A pooled or chained block may be the parent of buffered orphans.
+    if (!block->validation.simulate &&
+        (!ec || ec == error::insufficient_work))
+        organize_orphans(block);
+}
+
+// private
+code block_organizer::organize_block(block_const_ptr block, bool check)
+{
+    const auto start = asio::steady_clock::now();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_high_priority();
+    mutex_.lock_high_priority(caller::block);
+
+    // The check stage is not timed for buffered orphans (not rechecked).
+    const auto locked = statistics_.record(subject, stage::wait, start);
+    stage_start_ = check ? locked : asio::time_point{};
 
     // Reset the reusable promise.
     resume_ = std::promise<code>();
@@ -107,18 +155,252 @@ void block_organizer::organize(block_const_ptr block, result_handler handler)
             this, _1, block, complete);
 
     // Checks that are independent of chain state.
-    validator_.check(block, check_handler);
+    // Buffered orphans were checked before buffering and are not rechecked.
+    if (check)
+        validator_.check(block, check_handler);
+    else
+        check_handler(error::success);
 
     // Wait on completion signal.
     // This is necessary in order to continue on a non-priority thread.
     // If we do not wait on the original thread there may be none left.
-    auto ec = resume_.get_future().get();
+    const auto ec = resume_.get_future().get();
 
     mutex_.unlock_high_priority();
     ///////////////////////////////////////////////////////////////////////////
 
-    // Invoke caller handler outside of critical section.
-    handler(ec);
+    BCB_TRACE_END(start, "organize", *block);
+    dump_trace(block, start);
+    return ec;
+}
+
+// private
+// Descendants are organized breadth first, each extended into the longest run
+// of buffered descendants. Siblings are queued behind their parent's run.
+void block_organizer::organize_orphans(block_const_ptr parent)
+{
+    auto orphans = orphan_pool_.remove(parent->hash());
+
+    for (size_t index = 0; index < orphans.size() && !stopped(); ++index)
+    {
+        block_const_ptr_list run{ orphans[index] };
+
+        for (auto children = orphan_pool_.remove(run.back()->hash());
+            !children.empty();
+            children = orphan_pool_.remove(run.back()->hash()))
+        {
+            run.push_back(children.front());
+            orphans.insert(orphans.end(), children.begin() + 1,
+                children.end());
+        }
+
+        if (run.size() > 1u)
+        {
+            // Failures are logged by block, only a stop ends the sequence.
+            if (organize_blocks(run) == error::service_stopped)
+                break;
+
+            continue;
+        }
+
+        const auto ec = organize_block(run.front(), false);
+
+        if (ec && ec != error::insufficient_work)
+        {
+            LOG_DEBUG(LOG_BLOCKCHAIN)
+                << "Orphan block [" << encode_hash(run.front()->hash())
+                << "] not organized: " << ec.message();
+        }
+    }
+}
+
+// private
+// Each block of the connected run is populated and accepted in order, in the
+// context of its predecessors. The connect phase (script validation) is then
+// run for all blocks at once, and the blocks are committed in order. Blocks
+// following one that fails are not committed. Returns the first failure.
+code block_organizer::organize_blocks(const block_const_ptr_list& blocks)
+{
+    BITCOIN_ASSERT(!blocks.empty());
+    branch::const_ptr_list branches;
+    const auto start = asio::steady_clock::now();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_high_priority(caller::block);
+    statistics_.record(subject, stage::wait, start);
+
+    // The path through the block forest to the first block of the run.
+    const auto base = block_pool_.get_path(blocks.front());
+    code ec(error::success);
+
+    if (!base)
+        ec = error::operation_failed;
+    else if (base->empty())
+        ec = error::duplicate_block;
+    else if (!set_branch_height(base))
+        ec = error::orphan_block;
+
+    // Read ahead the prevouts of the run, overlapping prior blocks' accept.
+    for (size_t index = 0; !ec && index < blocks.size(); ++index)
+        prefetcher_.prefetch(blocks[index], base->top_height() + index);
+
+    // Discard reads since the last block (e.g. header chain state).
+    accounting_.take_block();
+
+    for (size_t index = 0; !ec && index < blocks.size(); ++index)
+    {
+        const auto block = blocks[index];
+
+        if (fast_chain_.get_block_exists(block->hash()))
+        {
+            ec = error::duplicate_block;
+            break;
+        }
+
+        const auto path = std::make_shared<branch>(base->height());
+
+        for (auto successor = index; successor > 0u; --successor)
+            path->push_front(blocks[successor]);
+
+        const auto& prefix = *base->blocks();
+        for (auto it = prefix.rbegin(); it != prefix.rend(); ++it)
+            path->push_front(*it);
+
+        if ((ec = accept(path)))
+            break;
+
+        // Population ends where the (timed) contextual block checks begin.
+        const auto& times = block->validation;
+        statistics_.record(subject, stage::populate,
+            times.start_accept - times.start_populate);
+        statistics_.record(subject, stage::accept, times.start_accept);
+
+        if (accounting_.enabled())
+            LOG_DEBUG(LOG_BLOCKCHAIN)
+                << "Block [" << path->top_height() << "] store reads for "
+                << block->total_non_coinbase_inputs() << " inputs: "
+                << store_accounting::to_string(accounting_.take_block());
+
+        // Successors are populated in the context of this block.
+        auto& header = block->header().validation;
+        header.height = path->top_height();
+        header.median_time_past = block->validation.state->median_time_past();
+        branches.push_back(path);
+    }
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_BLOCKCHAIN)
+            << "Orphan block [" << encode_hash(blocks[branches.size()]->hash())
+            << "] not organized: " << ec.message();
+    }
+
+    const auto failure = ec;
+    resume_ = std::promise<code>();
+
+    // Checks that include script validation, for all accepted blocks at once.
+    validator_.connect(branches,
+        std::bind(&block_organizer::signal_completion,
+            this, _1));
+
+    ec = resume_.get_future().get();
+
+    if (ec)
+    {
+        LOG_DEBUG(LOG_BLOCKCHAIN)
+            << "Orphan run of [" << branches.size()
+            << "] blocks not connected: " << ec.message();
+        branches.clear();
+    }
+
+    // Connection is timed here, so it is not timed again by commit.
+    for (const auto& path: branches)
+    {
+        auto& times = path->top()->validation;
+        statistics_.record(subject, stage::connect, times.start_connect);
+        times.start_connect = asio::time_point{};
+    }
+
+    auto result = failure ? failure : ec;
+    block_const_ptr_list committed;
+
+    for (const auto& path: branches)
+    {
+        const auto block = path->top();
+
+        if (stopped())
+        {
+            result = error::service_stopped;
+            break;
+        }
+
+        ec = block->validation.error;
+
+        // Predecessors are now pooled or chained, so the path is retraced.
+        if (!ec)
+            ec = commit(block);
+
+        committed.push_back(block);
+
+        if (ec && ec != error::insufficient_work)
+        {
+            LOG_DEBUG(LOG_BLOCKCHAIN)
+                << "Orphan block [" << encode_hash(block->hash())
+                << "] not organized: " << ec.message();
+
+            if (!result)
+                result = ec;
+
+            break;
+        }
+    }
+
+    mutex_.unlock_high_priority();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto& block: committed)
+    {
+        BCB_TRACE_END(start, "organize", *block);
+        dump_trace(block, start);
+    }
+
+    return result;
+}
+
+// private
+code block_organizer::accept(branch::const_ptr branch)
+{
+    resume_ = std::promise<code>();
+
+    // Checks that are dependent on chain state and prevouts.
+    validator_.accept(branch,
+        std::bind(&block_organizer::signal_completion,
+            this, _1));
+
+    return resume_.get_future().get();
+}
+
+// private
+code block_organizer::commit(block_const_ptr block)
+{
+    const auto branch = block_pool_.get_path(block);
+
+    if (!branch)
+        return error::operation_failed;
+
+    if (branch->empty() || !set_branch_height(branch))
+        return error::orphan_block;
+
+    resume_ = std::promise<code>();
+
+    const result_handler complete =
+        std::bind(&block_organizer::signal_completion,
+            this, _1);
+
+    // The block is validated, so this proceeds to pool or reorganization.
+    handle_connect(error::success, branch, complete);
+    return resume_.get_future().get();
 }
 
 // private
@@ -148,10 +430,20 @@ void block_organizer::handle_check(const code& ec, block_const_ptr block,
         return;
     }
 
+    if (stage_start_ != asio::time_point{})
+        statistics_.record(subject, stage::check, stage_start_);
+
     // Verify the last branch block (all others are verified).
     // Get the path through the block forest to the new block.
     const auto branch = block_pool_.get_path(block);
 
+    // A spilled ancestor could not be read back from the scratch file.
+    if (!branch)
+    {
+        handler(error::operation_failed);
+        return;
+    }
+
     //*************************************************************************
     // CONSENSUS: This is the same check performed by satoshi, yet it will
     // produce a chain split in the case of a hash collision. This is because
@@ -164,16 +456,26 @@ void block_organizer::handle_check(const code& ec, block_const_ptr block,
         return;
     }
 
+    // Buffer the checked block until arrival of its parent.
     if (!set_branch_height(branch))
     {
+        if (!block->validation.simulate && is_orphan_work(block))
+            orphan_pool_.add(block);
+
         handler(error::orphan_block);
         return;
     }
 
+    // Read ahead the prevouts, overlapping chain state population.
+    prefetcher_.prefetch(block, branch->top_height());
+
     const auto accept_handler =
         std::bind(&block_organizer::handle_accept,
             this, _1, branch, handler);
 
+    // Discard reads since the last block (e.g. header chain state).
+    accounting_.take_block();
+
     // Checks that are dependent on chain state and prevouts.
     validator_.accept(branch, accept_handler);
 }
@@ -194,6 +496,12 @@ void block_organizer::handle_accept(const code& ec, branch::ptr branch,
         return;
     }
 
+    // Population ends where the (timed) contextual block checks begin.
+    const auto& times = branch->top()->validation;
+    statistics_.record(subject, stage::populate,
+        times.start_accept - times.start_populate);
+    statistics_.record(subject, stage::accept, times.start_accept);
+
     const auto connect_handler =
         std::bind(&block_organizer::handle_connect,
             this, _1, branch, handler);
@@ -221,6 +529,12 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch,
     auto& top_block = branch->top()->validation;
     top_block.error = error::success;
 
+    // A batched block is connected, timed and accounted by organize_blocks.
+    const auto batched = top_block.start_connect == asio::time_point{};
+
+    if (!batched)
+        statistics_.record(subject, stage::connect, top_block.start_connect);
+
     auto& top_header = branch->top()->header().validation;
     top_header.median_time_past = top_block.state->median_time_past();
     top_header.height = branch->top_height();
@@ -237,6 +551,12 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch,
         return;
     }
 
+    if (accounting_.enabled() && !batched)
+        LOG_DEBUG(LOG_BLOCKCHAIN)
+            << "Block [" << branch->top_height() << "] store reads for "
+            << branch->top()->total_non_coinbase_inputs() << " inputs: "
+            << store_accounting::to_string(accounting_.take_block());
+
     // TODO: consider relay of pooled blocks by modifying subscriber semantics.
     if (work <= threshold)
     {
@@ -261,11 +581,13 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch,
         std::bind(&block_organizer::handle_reorganized,
             this, _1, branch, out_blocks, handler);
 
+    stage_start_ = asio::steady_clock::now();
+
     // Replace! Switch!
     //#########################################################################
     // Incoming blocks must have median_time_past set.
     fast_chain_.reorganize(branch->fork_point(), branch->blocks(), out_blocks,
-        dispatch_, reorganized_handler);
+        query_dispatch_, reorganized_handler);
     //#########################################################################
 }
 
@@ -284,6 +606,10 @@ void block_organizer::handle_reorganized(const code& ec,
         return;
     }
 
+    statistics_.record(subject, stage::store, stage_start_);
+    BCB_TRACE_END(stage_start_, "reorganize", *branch->top());
+    statistics_.confirmed(*branch->blocks());
+
     block_pool_.remove(branch->blocks());
     block_pool_.prune(branch->top_height());
     block_pool_.add(outgoing);
@@ -297,13 +623,28 @@ void block_organizer::handle_reorganized(const code& ec,
 // Subscription.
 //-----------------------------------------------------------------------------
 
+const notification_queue& block_organizer::notifications() const
+{
+    return *notifications_;
+}
+
 // private
 void block_organizer::notify(size_t branch_height,
     block_const_ptr_list_const_ptr branch,
     block_const_ptr_list_const_ptr original)
 {
-    // This invokes handlers within the criticial section (deadlock risk).
-    subscriber_->invoke(error::success, branch_height, branch, original);
+    const auto subscriber = subscriber_;
+    const auto enqueued = asio::steady_clock::now();
+    auto& statistics = statistics_;
+
+    // Handlers are invoked on the threadpool, outside of the critical section.
+    notifications_->enqueue([=, &statistics]()
+    {
+        BCB_TRACE_BEGIN(trace_start);
+        subscriber->invoke(error::success, branch_height, branch, original);
+        BCB_TRACE_END(trace_start, "notify", *branch->back());
+        statistics.record(subject, stage::notify, enqueued);
+    }, false);
 }
 
 void block_organizer::subscribe(reorganize_handler&& handler)
@@ -323,6 +664,7 @@ void block_organizer::unsubscribe()
 void block_organizer::filter(get_data_ptr message) const
 {
     block_pool_.filter(message);
+    orphan_pool_.filter(message);
 }
 
 // Utility.
@@ -341,5 +683,49 @@ bool block_organizer::set_branch_height(branch::ptr branch)
     return true;
 }
 
+// Orphans are unconnected, so only their claimed work can be checked here.
+// Work cannot fall by more than the retargeting factor in one adjustment, so
+// an orphan near the top (at or above the last checkpoint once synchronized)
+// cannot claim less work than this floor.
+bool block_organizer::is_orphan_work(block_const_ptr block) const
+{
+    size_t top;
+    uint32_t bits;
+
+    if (!orphan_work_floor_)
+        return true;
+
+    if (!fast_chain_.get_last_height(top) || !fast_chain_.get_bits(bits, top))
+        return false;
+
+    const auto floor = chain::block::proof(bits) / retargeting_factor;
+    return chain::block::proof(block->header().bits()) >= floor;
+}
+
+// The retained spans are exported when a block exceeds the slow threshold.
+void block_organizer::dump_trace(block_const_ptr block,
+    const asio::time_point& start) const
+{
+    if (slow_block_ == asio::duration::zero() ||
+        asio::steady_clock::now() - start < slow_block_)
+        return;
+
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(trace_directory_, ec);
+    const auto hash = encode_hash(block->hash());
+    const auto file = trace_directory_ / ("block-" + hash + ".json");
+
+    if (!tracer::dump(file))
+    {
+        LOG_WARNING(LOG_BLOCKCHAIN)
+            << "Failed to write trace of slow block [" << hash << "] to "
+            << file.string();
+        return;
+    }
+
+    LOG_INFO(LOG_BLOCKCHAIN)
+        << "Trace of slow block [" << hash << "] written to " << file.string();
+}
+
 } // namespace blockchain
 } // namespace libbitcoin
@@ -24,6 +24,7 @@
 #include <memory>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/header_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
@@ -39,14 +40,22 @@ using namespace std::placeholders;
 
 #define NAME "header_organizer"
 
+typedef chain_statistics::stage stage;
+typedef validation_mutex::caller caller;
+static const auto subject = chain_statistics::subject::header;
+
 // Database access is limited to:
 // block: { bits, version, timestamp }
 
-header_organizer::header_organizer(prioritized_mutex& mutex, dispatcher& dispatch,
-    threadpool&, fast_chain& chain, const settings& settings)
+header_organizer::header_organizer(validation_mutex& mutex,
+    validation_pools& pools, threadpool&, fast_chain& chain,
+    header_index& headers, const settings& settings,
+    chain_statistics& statistics)
   : mutex_(mutex),
     stopped_(true),
-    validator_(dispatch, chain, settings)
+    statistics_(statistics),
+    headers_(headers),
+    validator_(pools.populate(), chain, settings)
 {
 }
 
@@ -82,9 +91,12 @@ bool header_organizer::stop()
 void header_organizer::organize(header_const_ptr header,
     result_handler handler)
 {
+    const auto start = asio::steady_clock::now();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_high_priority();
+    mutex_.lock_high_priority(caller::header);
+    stage_start_ = statistics_.record(subject, stage::wait, start);
 
     // Reset the reusable promise.
     resume_ = std::promise<code>();
@@ -139,36 +151,14 @@ void header_organizer::handle_check(const code& ec, header_const_ptr header,
         return;
     }
 
-    const auto accept_handler =
-        std::bind(&header_organizer::handle_accept,
-            this, _1, header, handler);
-
-    // Checks that are dependent on chain state.
-    validator_.accept(header, accept_handler);
-}
-
-// private
-void header_organizer::handle_accept(const code& ec, header_const_ptr header,
-    result_handler handler)
-{
-    if (stopped())
-    {
-        handler(error::service_stopped);
-        return;
-    }
-
-    if (ec)
-    {
-        handler(ec);
-        return;
-    }
+    stage_start_ = statistics_.record(subject, stage::check, stage_start_);
 
-    //=========================================================================
-    //=========================================================================
-    // TODO: add header to the store (unconfirmed, empty).
-    //=========================================================================
-    //=========================================================================
-    handler(error::success);
+    // The index links, retargets and checkpoints the header (chain state is
+    // populated from the index, as the header may be above the store top).
+    // A header of a competing branch is retained until it has more work.
+    const auto result = headers_.add({ *header });
+    statistics_.record(subject, stage::accept, stage_start_);
+    handler(result);
 }
 
 // Queries.
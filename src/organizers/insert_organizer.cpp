@@ -0,0 +1,360 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/organizers/insert_organizer.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database.hpp>
+#include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+#include <bitcoin/blockchain/pools/header_index.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::config;
+using namespace bc::database;
+
+#define NAME "insert_organizer"
+
+typedef validation_mutex::caller caller;
+
+// Blocks under the top checkpoint are stored without chain state validation.
+// Each block must be in the header index at its height, which verifies the
+// linkage, proof of work, retargeting and checkpoints of its header chain.
+// Each is also linked to its stored or reserved neighbors at reservation, so
+// once the gaps are closed the checkpointed chain is contiguous. Reservation
+// is serialized, context free checks and store inserts are concurrent.
+
+static size_t top_height(const checkpoint::list& checkpoints)
+{
+    return checkpoints.empty() ? 0 :
+        checkpoint::sort(checkpoints).back().height();
+}
+
+insert_organizer::insert_organizer(validation_mutex& mutex,
+    dispatcher& dispatch, fast_chain& chain, const header_index& headers,
+    const settings& settings)
+  : fast_chain_(chain),
+    validation_mutex_(mutex),
+    stopped_(true),
+    active_(false),
+    remaining_(0),
+    dispatch_(dispatch),
+    headers_(headers),
+    top_checkpoint_height_(top_height(settings.checkpoints)),
+    initialized_(false)
+{
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+bool insert_organizer::stopped() const
+{
+    return stopped_;
+}
+
+bool insert_organizer::active() const
+{
+    return active_;
+}
+
+size_t insert_organizer::remaining() const
+{
+    return remaining_;
+}
+
+// Start/stop sequences.
+//-----------------------------------------------------------------------------
+
+bool insert_organizer::start()
+{
+    stopped_ = false;
+    return true;
+}
+
+// The caller holds the validation mutex, which guards the chain state reset.
+bool insert_organizer::stop()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    stopped_ = true;
+
+    // Store inserts in progress complete before the bulk insert is closed.
+    released_.wait(lock, [this]()
+    {
+        return reserved_.empty();
+    });
+
+    // Clear the flush lock of an incomplete bulk insert.
+    if (active_)
+    {
+        active_ = false;
+        return fast_chain_.end_insert();
+    }
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Insert sequence.
+//-----------------------------------------------------------------------------
+
+void insert_organizer::organize(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    if (stopped())
+    {
+        handler(error::service_stopped);
+        return;
+    }
+
+    // The genesis block is stored at initialization.
+    if (height == 0 || height > top_checkpoint_height_)
+    {
+        handler(error::operation_failed);
+        return;
+    }
+
+    // Checks and inserts run concurrently on the priority pool.
+    dispatch_.concurrent(&insert_organizer::insert,
+        this, block, height, handler);
+}
+
+// private
+void insert_organizer::insert(block_const_ptr block, size_t height,
+    result_handler handler)
+{
+    if (stopped())
+    {
+        handler(error::service_stopped);
+        return;
+    }
+
+    // Checks that are independent of chain state.
+    auto ec = block->check();
+
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
+
+    // The header chain is linked, retargeted and checkpointed by the index.
+    if (!headers_.is_indexed(block->hash(), height))
+    {
+        handler(error::orphan_block);
+        return;
+    }
+
+    if ((ec = reserve(block, height)))
+    {
+        handler(ec);
+        return;
+    }
+
+    //#########################################################################
+    const auto inserted = fast_chain_.insert(block, height);
+    //#########################################################################
+
+    release(height);
+
+    if (!inserted)
+    {
+        LOG_FATAL(LOG_BLOCKCHAIN)
+            << "Failure inserting block [" << height << "] to store.";
+        abort();
+        handler(error::operation_failed);
+        return;
+    }
+
+    // The last gap closes the bulk insert and hands off to the organizer.
+    if (--remaining_ == 0)
+        close();
+
+    handler(error::success);
+}
+
+// private
+code insert_organizer::reserve(block_const_ptr block, size_t height)
+{
+    hash_digest hash;
+    hash_digest parent;
+    const auto& header = block->header();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (stopped())
+        return error::service_stopped;
+
+    if (!initialize())
+        return error::operation_failed;
+
+    if (!active_)
+        return error::duplicate_block;
+
+    if (get_hash(hash, height))
+        return error::duplicate_block;
+
+    // The block must link to its stored or reserved predecessor.
+    if (get_hash(hash, height - 1u) && hash != header.previous_block_hash())
+        return error::checkpoints_failed;
+
+    // The block must link to its stored or reserved successor.
+    if (get_parent(parent, height + 1u) && parent != block->hash())
+        return error::checkpoints_failed;
+
+    reserved_.emplace(height,
+        reservation{ block->hash(), header.previous_block_hash() });
+
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// The block is stored, so its links are now obtained from the store.
+void insert_organizer::release(size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    reserved_.erase(height);
+    released_.notify_all();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Ending the bulk insert resets chain state, which requires the validation
+// mutex. This is not called while holding a reservation, so that stop (which
+// holds the validation mutex) cannot deadlock on it.
+void insert_organizer::close()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    validation_mutex_.lock_high_priority(caller::chain);
+    mutex_.lock();
+
+    const auto active = active_.exchange(false);
+    const auto ended = !active || fast_chain_.end_insert();
+
+    mutex_.unlock();
+    validation_mutex_.unlock_high_priority();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!ended)
+        LOG_FATAL(LOG_BLOCKCHAIN)
+            << "Failure closing bulk insert to store.";
+    else if (active && !stopped())
+        LOG_INFO(LOG_BLOCKCHAIN)
+            << "Closed gaps to checkpoint [" << top_checkpoint_height_ << "].";
+}
+
+// private
+// The failed height remains a gap that cannot be reliably refilled, so rather
+// than wait on a count that may never reach zero the bulk insert is closed
+// (clearing the flush lock) and further inserts are refused.
+void insert_organizer::abort()
+{
+    stopped_ = true;
+    close();
+}
+
+// Utility.
+//-----------------------------------------------------------------------------
+
+// private
+// The bulk insert is opened upon the first insert, so that it is not opened
+// for nodes that sync only through the block organizer.
+bool insert_organizer::initialize()
+{
+    if (initialized_)
+        return true;
+
+    size_t top;
+    block_database::heights gaps;
+
+    if (!fast_chain_.get_last_height(top) || !fast_chain_.get_gaps(gaps))
+        return false;
+
+    const auto under = [this](size_t height)
+    {
+        return height <= top_checkpoint_height_;
+    };
+
+    size_t remaining = std::count_if(gaps.begin(), gaps.end(), under);
+
+    if (top < top_checkpoint_height_)
+        remaining += top_checkpoint_height_ - top;
+
+    initialized_ = true;
+    remaining_ = remaining;
+
+    if (remaining == 0)
+        return true;
+
+    if (!fast_chain_.begin_insert())
+        return false;
+
+    active_ = true;
+    return true;
+}
+
+// private
+bool insert_organizer::get_hash(hash_digest& out_hash, size_t height) const
+{
+    const auto it = reserved_.find(height);
+
+    if (it == reserved_.end())
+        return fast_chain_.get_block_hash(out_hash, height);
+
+    out_hash = it->second.hash;
+    return true;
+}
+
+// private
+bool insert_organizer::get_parent(hash_digest& out_parent,
+    size_t height) const
+{
+    const auto it = reserved_.find(height);
+
+    if (it != reserved_.end())
+    {
+        out_parent = it->second.parent;
+        return true;
+    }
+
+    chain::header header;
+
+    if (!fast_chain_.get_header(header, height))
+        return false;
+
+    out_parent = header.previous_block_hash();
+    return true;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/organizers/notification_queue.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace std::placeholders;
+
+notification_queue::notification_queue(threadpool& pool, size_t capacity,
+    const asio::duration& batch_interval)
+  : pool_(pool),
+    capacity_(capacity == 0 ? max_size_t : capacity),
+    batch_interval_(batch_interval),
+    depth_(0),
+    dropped_(0),
+    lag_(0),
+    stopped_(true),
+    draining_(false),
+    timer_pending_(false)
+{
+}
+
+// Start/stop sequences.
+//-----------------------------------------------------------------------------
+
+void notification_queue::start()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Undelivered notifications are discarded.
+void notification_queue::stop()
+{
+    deadline::ptr timer;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    stopped_ = true;
+    depth_ -= queue_.size();
+    queue_.clear();
+    timer.swap(timer_);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (timer)
+        timer->stop();
+}
+
+// Queue.
+//-----------------------------------------------------------------------------
+
+bool notification_queue::enqueue(notifier&& notification, bool batch)
+{
+    auto post = false;
+    auto wait = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (stopped_)
+        return false;
+
+    // The caller holds the validation lock, so it must not wait on delivery.
+    if (queue_.size() >= capacity_)
+    {
+        ++dropped_;
+        return false;
+    }
+
+    queue_.push_back({ std::move(notification), asio::steady_clock::now() });
+    ++depth_;
+
+    // An active drain picks up the notification without scheduling.
+    if (draining_ || timer_pending_)
+        return true;
+
+    if (batch && batch_interval_ > asio::duration::zero())
+    {
+        wait = true;
+        timer_pending_ = true;
+        timer_ = std::make_shared<deadline>(pool_, batch_interval_);
+    }
+    else
+    {
+        post = true;
+        draining_ = true;
+    }
+
+    const auto timer = timer_;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (wait)
+        timer->start(
+            std::bind(&notification_queue::handle_timer,
+                shared_from_this(), _1));
+
+    if (post)
+        pool_.service().post(
+            std::bind(&notification_queue::drain,
+                shared_from_this()));
+
+    return true;
+}
+
+void notification_queue::handle_timer(const code&)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    timer_pending_ = false;
+
+    if (stopped_ || draining_ || queue_.empty())
+        return;
+
+    draining_ = true;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // This is a threadpool thread, so the drain may execute here.
+    drain();
+}
+
+// Delivery is serial, preserving enqueue order across batches.
+void notification_queue::drain()
+{
+    items batch;
+
+    while (true)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (stopped_ || queue_.empty())
+        {
+            draining_ = false;
+            return;
+        }
+
+        batch.clear();
+        batch.swap(queue_);
+        lock.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        // Depth includes the undelivered remainder of the batch.
+        for (const auto& item: batch)
+        {
+            const auto lag = asio::steady_clock::now() - item.enqueued;
+            lag_ = lag.count();
+            --depth_;
+            item.notification();
+        }
+    }
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+size_t notification_queue::depth() const
+{
+    return depth_;
+}
+
+size_t notification_queue::dropped() const
+{
+    return dropped_;
+}
+
+asio::duration notification_queue::lag() const
+{
+    return asio::duration(lag_.load());
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -26,6 +26,7 @@
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/chain_statistics.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/validate/validate_transaction.hpp>
@@ -37,18 +38,30 @@ using namespace std::placeholders;
 
 #define NAME "transaction_organizer"
 
-// TODO: create priority pool at blockchain level and use in both organizers. 
-transaction_organizer::transaction_organizer(prioritized_mutex& mutex,
-    dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain,
-    const settings& settings)
+typedef chain_statistics::stage stage;
+typedef validation_mutex::caller caller;
+static const auto subject = chain_statistics::subject::transaction;
+
+transaction_organizer::transaction_organizer(validation_mutex& mutex,
+    validation_pools& pools, threadpool& thread_pool, fast_chain& chain,
+    const settings& settings, chain_statistics& statistics)
   : fast_chain_(chain),
     mutex_(mutex),
     stopped_(true),
     settings_(settings),
-    dispatch_(dispatch),
+    query_dispatch_(pools.query()),
+    orphan_dispatch_(thread_pool, NAME "_orphan"),
+    statistics_(statistics),
     transaction_pool_(settings),
-    validator_(dispatch, fast_chain_, settings),
-    subscriber_(std::make_shared<transaction_subscriber>(thread_pool, NAME))
+    orphan_pool_(settings.orphan_transaction_limit,
+        settings.orphan_transaction_bytes_limit),
+    metrics_(settings.transaction_metrics_limit),
+    pooled_index_(settings.pooled_transaction_limit),
+    validator_(pools.populate(), pools.verify(), fast_chain_, settings),
+    subscriber_(std::make_shared<transaction_subscriber>(thread_pool, NAME)),
+    // Announcements are not dropped, as peers would otherwise never see them.
+    notifications_(std::make_shared<notification_queue>(thread_pool, 0,
+        asio::milliseconds(settings.notification_batch_milliseconds)))
 {
 }
 
@@ -67,16 +80,22 @@ bool transaction_organizer::start()
 {
     stopped_ = false;
     subscriber_->start();
+    notifications_->start();
     validator_.start();
     return true;
 }
 
 bool transaction_organizer::stop()
 {
+    stopped_ = true;
     validator_.stop();
+
+    // Wait on open validations, which are not guarded by the caller's lock.
+    unique_lock lock(validation_mutex_);
+
+    notifications_->stop();
     subscriber_->stop();
     subscriber_->invoke(error::service_stopped, {});
-    stopped_ = true;
     return true;
 }
 
@@ -87,42 +106,173 @@ bool transaction_organizer::stop()
 void transaction_organizer::organize(transaction_const_ptr tx,
     result_handler handler)
 {
+    const auto ec = organize_transaction(tx, true);
+
+    // Invoke caller handler outside of critical section.
+    handler(ec);
+
+    // Children of the accepted tx are organized on the calling thread.
+    if (!ec && !tx->validation.simulate)
+        organize_orphans(tx);
+}
+
+// private
+// Validation is optimistic, running outside of the critical section against
+// the pool state snapshot obtained at population. This allows independent
+// transactions to validate concurrently with each other and with blocks.
+// Only the commit step is serialized, where the snapshot is confirmed.
+code transaction_organizer::organize_transaction(transaction_const_ptr tx,
+    bool check)
+{
+    transaction_metrics::const_ptr metrics;
+    auto ec = validate(tx, check, metrics);
+
+    // TODO: create a simulated validation path that does not block others.
+    if (tx->validation.simulate)
+        return ec;
+
+    // Buffer the tx until arrival of its missing parent(s).
+    if (ec == error::missing_previous_output)
+    {
+        orphan_pool_.add(tx);
+        return ec;
+    }
+
+    if (ec)
+        return ec;
+
+    const auto start = asio::steady_clock::now();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_low_priority();
+    mutex_.lock_low_priority(caller::transaction);
+    statistics_.record(subject, stage::wait, start);
+
+    // If the pool state has since changed in a way that affects the tx then
+    // validation is repeated within the critical section (rare).
+    if (!validator_.is_current(tx))
+        ec = validate(tx, false, metrics);
+
+    // Concurrent validation allows a conflict to arise since handle_accept.
+    if (!ec && !spend_index_.add(*tx))
+        ec = error::double_spend;
+
+    if (!ec)
+    {
+        const auto pushing = asio::steady_clock::now();
+        ec = push(tx);
+        statistics_.record(subject, stage::store, pushing);
+
+        if (ec)
+        {
+            spend_index_.remove(tx->hash());
+        }
+        else
+        {
+            // Cached for reuse in block validation only once pooled.
+            pooled_index_.add(*tx, tx->validation.state->enabled_forks());
+            metrics_.add(metrics);
+        }
+    }
+
+    mutex_.unlock_low_priority();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return ec;
+}
+
+// private
+// Orphans released by an accepted parent are organized breadth first. These
+// have already passed context free checks, so only accept/connect are rerun.
+void transaction_organizer::organize_orphans(transaction_const_ptr parent)
+{
+    organize_released(orphan_pool_.remove(parent->hash()));
+}
+
+// private
+void transaction_organizer::organize_released(
+    transaction_const_ptr_list orphans)
+{
+    for (size_t index = 0; index < orphans.size() && !stopped(); ++index)
+    {
+        const auto tx = orphans[index];
+        const auto ec = organize_transaction(tx, false);
+
+        if (ec)
+        {
+            LOG_DEBUG(LOG_BLOCKCHAIN)
+                << "Orphan transaction [" << encode_hash(tx->hash())
+                << "] not accepted: " << ec.message();
+            continue;
+        }
+
+        const auto children = orphan_pool_.remove(tx->hash());
+        orphans.insert(orphans.end(), children.begin(), children.end());
+    }
+}
+
+// private
+code transaction_organizer::validate(transaction_const_ptr tx, bool check,
+    transaction_metrics::const_ptr& out_metrics)
+{
+    // Stop must not shut down the priority pool while validations are open.
+    shared_lock lock(validation_mutex_);
+
+    if (stopped())
+        return error::service_stopped;
 
-    // Reset the reusable promise.
-    resume_ = std::promise<code>();
+    const auto resume = std::make_shared<std::promise<code>>();
 
     const result_handler complete =
         std::bind(&transaction_organizer::signal_completion,
-            this, _1);
+            this, _1, resume);
+
+    // The check stage is not timed for released orphans (not rechecked).
+    const auto start = check ? asio::steady_clock::now() : asio::time_point{};
 
     const auto check_handler =
         std::bind(&transaction_organizer::handle_check,
-            this, _1, tx, complete);
+            this, _1, tx, start, std::ref(out_metrics), complete);
 
     // Checks that are independent of chain state.
-    validator_.check(tx, check_handler);
+    if (check)
+        validator_.check(tx, check_handler);
+    else
+        check_handler(error::success);
 
     // Wait on completion signal.
     // This is necessary in order to continue on a non-priority thread.
     // If we do not wait on the original thread there may be none left.
-    auto ec = resume_.get_future().get();
+    return resume->get_future().get();
+}
 
-    mutex_.unlock_low_priority();
-    ///////////////////////////////////////////////////////////////////////////
+// private
+code transaction_organizer::push(transaction_const_ptr tx)
+{
+    const auto resume = std::make_shared<std::promise<code>>();
 
-    // Invoke caller handler outside of critical section.
-    handler(ec);
+    const result_handler complete =
+        std::bind(&transaction_organizer::signal_completion,
+            this, _1, resume);
+
+    const auto pushed_handler =
+        std::bind(&transaction_organizer::handle_pushed,
+            this, _1, tx, complete);
+
+    //#########################################################################
+    fast_chain_.push(tx, query_dispatch_, pushed_handler);
+    //#########################################################################
+
+    return resume->get_future().get();
 }
 
 // private
-void transaction_organizer::signal_completion(const code& ec)
+void transaction_organizer::signal_completion(const code& ec,
+    promise_ptr resume)
 {
-    // This must be protected so that it is properly cleared.
+    // Each sequence has its own promise, as sequences may run concurrently.
     // Signal completion, which results in original handler invoke with code.
-    resume_.set_value(ec);
+    resume->set_value(ec);
 }
 
 // Verify sub-sequence.
@@ -130,7 +280,8 @@ void transaction_organizer::signal_completion(const code& ec)
 
 // private
 void transaction_organizer::handle_check(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+    transaction_const_ptr tx, asio::time_point start,
+    transaction_metrics::const_ptr& out_metrics, result_handler handler)
 {
     if (stopped())
     {
@@ -144,9 +295,13 @@ void transaction_organizer::handle_check(const code& ec,
         return;
     }
 
+    const auto checked = start == asio::time_point{} ?
+        asio::steady_clock::now() :
+        statistics_.record(subject, stage::check, start);
+
     const auto accept_handler =
         std::bind(&transaction_organizer::handle_accept,
-            this, _1, tx, handler);
+            this, _1, tx, checked, std::ref(out_metrics), handler);
 
     // Checks that are dependent on chain state and prevouts.
     validator_.accept(tx, accept_handler);
@@ -154,7 +309,8 @@ void transaction_organizer::handle_check(const code& ec,
 
 // private
 void transaction_organizer::handle_accept(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+    transaction_const_ptr tx, asio::time_point start,
+    transaction_metrics::const_ptr& out_metrics, result_handler handler)
 {
     if (stopped())
     {
@@ -168,7 +324,14 @@ void transaction_organizer::handle_accept(const code& ec,
         return;
     }
 
-    if (tx->fees() < price(tx))
+    // Population and contextual checks are timed together for transactions.
+    statistics_.record(subject, stage::accept, start);
+
+    // Size, sigops and fees are computed here once, with prevouts populated.
+    const auto metrics = std::make_shared<const transaction_metrics>(*tx,
+        tx->validation.state->enabled_forks());
+
+    if (metrics->fees() < price(*metrics))
     {
         handler(error::insufficient_fee);
         return;
@@ -180,9 +343,19 @@ void transaction_organizer::handle_accept(const code& ec,
         return;
     }
 
+    // Reject before script validation if any input is spent by a pool tx.
+    if (spend_index_.conflicts(*tx))
+    {
+        handler(error::double_spend);
+        return;
+    }
+
+    // Returned to the commit step, which caches them once the tx is pooled.
+    out_metrics = metrics;
+
     const auto connect_handler =
         std::bind(&transaction_organizer::handle_connect,
-            this, _1, tx, handler);
+            this, _1, tx, asio::steady_clock::now(), handler);
 
     // Checks that include script validation.
     validator_.connect(tx, connect_handler);
@@ -190,7 +363,7 @@ void transaction_organizer::handle_accept(const code& ec,
 
 // private
 void transaction_organizer::handle_connect(const code& ec,
-    transaction_const_ptr tx, result_handler handler)
+    transaction_const_ptr tx, asio::time_point start, result_handler handler)
 {
     if (stopped())
     {
@@ -204,20 +377,10 @@ void transaction_organizer::handle_connect(const code& ec,
         return;
     }
 
-    // TODO: create a simulated validation path that does not block others.
-    if (tx->validation.simulate)
-    {
-        handler(error::success);
-        return;
-    }
+    statistics_.record(subject, stage::connect, start);
 
-    const auto pushed_handler =
-        std::bind(&transaction_organizer::handle_pushed,
-            this, _1, tx, handler);
-
-    //#########################################################################
-    fast_chain_.push(tx, dispatch_, pushed_handler);
-    //#########################################################################
+    // The push is deferred to the commit step of the organize sequence.
+    handler(ec);
 }
 
 // private
@@ -239,14 +402,81 @@ void transaction_organizer::handle_pushed(const code& ec,
     handler(error::success);
 }
 
+// Chain update.
+//-----------------------------------------------------------------------------
+
+// This is called from block_chain::reorganize, within the critical section.
+void transaction_organizer::reorganize(
+    block_const_ptr_list_const_ptr incoming_blocks,
+    block_const_ptr_list_const_ptr outgoing_blocks)
+{
+    // Spends of popped blocks are restored first, so that incoming conflicts
+    // with popped transactions are also evicted. Popped transactions are
+    // pooled by the store, unless confirmed again by an incoming block.
+    spend_index_.add(*outgoing_blocks);
+    pooled_index_.add(*outgoing_blocks);
+
+    const auto evicted = spend_index_.remove(*incoming_blocks);
+    pooled_index_.remove(*incoming_blocks);
+    metrics_.remove(*incoming_blocks);
+
+    // Evicted txs remain in the store, which cannot remove pool txs, but
+    // are dropped from the pool indexes so they are no longer relied upon.
+    for (const auto& hash: evicted)
+    {
+        metrics_.remove(hash);
+        pooled_index_.remove(hash);
+        LOG_DEBUG(LOG_BLOCKCHAIN)
+            << "Pool transaction [" << encode_hash(hash)
+            << "] evicted by confirmed double spend (or its ancestor).";
+    }
+
+    if (orphan_pool_.size() == 0)
+        return;
+
+    // Orphans of parents confirmed directly by a block are also released.
+    transaction_const_ptr_list released;
+    for (const auto& block: *incoming_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            const auto children = orphan_pool_.remove(tx.hash());
+            released.insert(released.end(), children.begin(), children.end());
+        }
+    }
+
+    // These are organized after the caller releases the critical section.
+    if (!released.empty())
+        orphan_dispatch_.concurrent(&transaction_organizer::organize_released,
+            this, std::move(released));
+}
+
 // Subscription.
 //-----------------------------------------------------------------------------
 
 // private
 void transaction_organizer::notify(transaction_const_ptr tx)
 {
-    // This invokes handlers within the criticial section (deadlock risk).
-    subscriber_->invoke(error::success, tx);
+    const auto subscriber = subscriber_;
+    const auto enqueued = asio::steady_clock::now();
+    auto& statistics = statistics_;
+
+    // Handlers are invoked on the threadpool, in batches across txs.
+    const auto queued = notifications_->enqueue([=, &statistics]()
+    {
+        subscriber->invoke(error::success, tx);
+        statistics.record(subject, stage::notify, enqueued);
+    }, true);
+
+    if (!queued && !stopped())
+        LOG_WARNING(LOG_BLOCKCHAIN)
+            << "Notification of transaction [" << encode_hash(tx->hash())
+            << "] dropped.";
+}
+
+const notification_queue& transaction_organizer::notifications() const
+{
+    return *notifications_;
 }
 
 void transaction_organizer::subscribe(transaction_handler&& handler)
@@ -277,7 +507,31 @@ void transaction_organizer::fetch_mempool(size_t maximum,
 // Utility.
 //-----------------------------------------------------------------------------
 
-uint64_t transaction_organizer::price(transaction_const_ptr tx) const
+transaction_metrics::const_ptr transaction_organizer::metrics(
+    const hash_digest& hash) const
+{
+    return metrics_.get(hash);
+}
+
+bool transaction_organizer::load_spends(const boost::filesystem::path& file)
+{
+    return spend_index_.load(file);
+}
+
+bool transaction_organizer::save_spends(
+    const boost::filesystem::path& file) const
+{
+    return spend_index_.save(file);
+}
+
+bool transaction_organizer::pooled_forks(uint32_t& out_forks,
+    const hash_digest& hash) const
+{
+    return pooled_index_.find(out_forks, hash);
+}
+
+uint64_t transaction_organizer::price(
+    const transaction_metrics& metrics) const
 {
     const auto byte_fee = settings_.byte_fee_satoshis;
     const auto sigop_fee = settings_.sigop_fee_satoshis;
@@ -286,10 +540,8 @@ uint64_t transaction_organizer::price(transaction_const_ptr tx) const
     if (byte_fee == 0.0f && sigop_fee == 0.0f)
         return 0;
 
-    // TODO: this is a second pass on size and sigops, implement cache.
-    // This at least prevents uncached calls when zero fee is configured.
-    auto byte = byte_fee > 0 ? byte_fee * tx->serialized_size(true) : 0;
-    auto sigop = sigop_fee > 0 ? sigop_fee * tx->signature_operations() : 0;
+    auto byte = byte_fee > 0 ? byte_fee * metrics.size() : 0;
+    auto sigop = sigop_fee > 0 ? sigop_fee * metrics.sigops() : 0;
 
     // Require at least one satoshi per tx if there are any fees configured.
     return std::max(uint64_t(1), static_cast<uint64_t>(byte + sigop));
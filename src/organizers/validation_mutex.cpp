@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/organizers/validation_mutex.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/interface/latency_histogram.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+validation_mutex::validation_mutex(bool prioritize, size_t fairness_limit)
+  : prioritize_(prioritize),
+    fairness_limit_(fairness_limit),
+    locked_(false),
+    high_waiting_(0),
+    low_waiting_(0),
+    high_streak_(0),
+    fair_grants_(0),
+    holder_(caller::chain),
+    level_(priority::high)
+{
+}
+
+void validation_mutex::lock_high_priority(caller who)
+{
+    lock(priority::high, who);
+}
+
+void validation_mutex::unlock_high_priority()
+{
+    unlock();
+}
+
+void validation_mutex::lock_low_priority(caller who)
+{
+    lock(priority::low, who);
+}
+
+void validation_mutex::unlock_low_priority()
+{
+    unlock();
+}
+
+// private
+// This is protected by mutex.
+bool validation_mutex::is_admissible(priority level) const
+{
+    if (locked_)
+        return false;
+
+    if (!prioritize_)
+        return true;
+
+    const auto fair = fairness_limit_ != 0 && high_streak_ >= fairness_limit_;
+
+    // High is admitted unless a low waiter is owed the lock.
+    if (level == priority::high)
+        return low_waiting_ == 0 || !fair;
+
+    // Low is admitted if no high is waiting or it is owed the lock.
+    return high_waiting_ == 0 || fair;
+}
+
+// private
+void validation_mutex::lock(priority level, caller who)
+{
+    const auto start = asio::steady_clock::now();
+    const auto high = level == priority::high;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++(high ? high_waiting_ : low_waiting_);
+
+    admitted_.wait(lock, [this, level]()
+    {
+        return is_admissible(level);
+    });
+
+    --(high ? high_waiting_ : low_waiting_);
+
+    if (high)
+    {
+        // The streak counts only grants made over a waiting low caller.
+        if (low_waiting_ != 0)
+            ++high_streak_;
+    }
+    else
+    {
+        if (high_waiting_ != 0)
+            ++fair_grants_;
+
+        high_streak_ = 0;
+    }
+
+    locked_ = true;
+    holder_ = who;
+    level_ = level;
+    acquired_ = asio::steady_clock::now();
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto wait = acquired_ - start;
+    caller_waits_[static_cast<size_t>(who)].record(wait);
+    priority_waits_[static_cast<size_t>(level)].record(wait);
+}
+
+// private
+void validation_mutex::unlock()
+{
+    // The holder is exclusive, so its acquisition is read without the lock.
+    const auto hold = asio::steady_clock::now() - acquired_;
+    caller_holds_[static_cast<size_t>(holder_)].record(hold);
+    priority_holds_[static_cast<size_t>(level_)].record(hold);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    locked_ = false;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Waiters of both classes are woken as admission depends on the mix.
+    admitted_.notify_all();
+}
+
+validation_mutex::report validation_mutex::statistics() const
+{
+    report result;
+
+    for (size_t who = 0; who < callers; ++who)
+    {
+        result.caller_waits[who] = caller_waits_[who].snapshot();
+        result.caller_holds[who] = caller_holds_[who].snapshot();
+    }
+
+    for (size_t level = 0; level < priorities; ++level)
+    {
+        result.priority_waits[level] = priority_waits_[level].snapshot();
+        result.priority_holds[level] = priority_holds_[level].snapshot();
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(mutex_);
+    result.fair_grants = fair_grants_;
+    ///////////////////////////////////////////////////////////////////////////
+
+    return result;
+}
+
+std::string validation_mutex::to_string(caller who)
+{
+    switch (who)
+    {
+        case caller::block:
+            return "block";
+        case caller::header:
+            return "header";
+        case caller::transaction:
+            return "transaction";
+        case caller::chain:
+            return "chain";
+        default:
+            return "";
+    }
+}
+
+std::string validation_mutex::to_string(priority level)
+{
+    switch (level)
+    {
+        case priority::high:
+            return "high";
+        case priority::low:
+            return "low";
+        default:
+            return "";
+    }
+}
+
+// The p50/p99/max wait and p50/p99 hold (microseconds) of each class.
+std::string validation_mutex::to_string(const report& values)
+{
+    std::ostringstream line;
+
+    for (size_t level = 0; level < priorities; ++level)
+    {
+        const auto& wait = values.priority_waits[level];
+        const auto& hold = values.priority_holds[level];
+        line << (level == 0 ? "" : ", ")
+            << to_string(static_cast<priority>(level))
+            << " wait " << wait.p50 << "/" << wait.p99 << "/" << wait.maximum
+            << " hold " << hold.p50 << "/" << hold.p99;
+    }
+
+    line << ", fair grants " << values.fair_grants;
+    return line.str();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,290 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/organizers/validation_pools.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+    #include <time.h>
+#endif
+
+namespace libbitcoin {
+namespace blockchain {
+
+#define NAME "validation_pools"
+
+// A zero thread count implies the configured cores (see thread_ceiling).
+static size_t pool_threads(uint32_t configured, uint32_t cores)
+{
+    return thread_ceiling(configured == 0 ? cores : configured);
+}
+
+validation_pools::validation_pools(const settings& settings)
+  : populate_(NAME "_populate",
+        pool_threads(settings.populate_threads, settings.cores),
+        settings.priority, settings.populate_processors),
+    verify_(NAME "_verify",
+        pool_threads(settings.verify_threads, settings.cores),
+        settings.priority, settings.verify_processors),
+    query_(NAME "_query",
+        pool_threads(settings.query_threads, settings.cores),
+        settings.priority, settings.query_processors)
+{
+}
+
+dispatcher& validation_pools::populate()
+{
+    return populate_.dispatch;
+}
+
+dispatcher& validation_pools::verify()
+{
+    return verify_.dispatch;
+}
+
+dispatcher& validation_pools::query()
+{
+    return query_.dispatch;
+}
+
+bool validation_pools::start()
+{
+    // All pools are started, even if pinning fails for one.
+    const auto populate = populate_.start();
+    const auto verify = verify_.start();
+    const auto query = query_.start();
+    return populate && verify && query;
+}
+
+void validation_pools::shutdown()
+{
+    populate_.threads.shutdown();
+    verify_.threads.shutdown();
+    query_.threads.shutdown();
+}
+
+void validation_pools::join()
+{
+    populate_.threads.join();
+    verify_.threads.join();
+    query_.threads.join();
+}
+
+validation_pools::utilizations validation_pools::utilization()
+{
+    utilizations result;
+
+    for (size_t which = 0; which < pools; ++which)
+        result[which] = get(static_cast<pool>(which)).utilization();
+
+    return result;
+}
+
+std::string validation_pools::to_string(pool which)
+{
+    switch (which)
+    {
+        case pool::populate:
+            return "populate";
+        case pool::verify:
+            return "verify";
+        case pool::query:
+            return "query";
+        default:
+            return "";
+    }
+}
+
+// The utilization of each pool as a percentage.
+std::string validation_pools::to_string(const utilizations& values)
+{
+    std::ostringstream line;
+    line.precision(1);
+    line << std::fixed;
+
+    for (size_t which = 0; which < pools; ++which)
+        line << (which == 0 ? "" : ", ")
+            << to_string(static_cast<pool>(which)) << " "
+            << values[which] * 100.0 << "%";
+
+    return line.str();
+}
+
+// private
+validation_pools::member& validation_pools::get(pool which)
+{
+    switch (which)
+    {
+        case pool::populate:
+            return populate_;
+        case pool::verify:
+            return verify_;
+        default:
+            return query_;
+    }
+}
+
+// Member.
+//-----------------------------------------------------------------------------
+
+validation_pools::member::member(const std::string& name, size_t count,
+    bool prioritize, const processors& pinned)
+  : threads(count, priority(prioritize)),
+    dispatch(threads, name),
+    pinned_(pinned),
+    processor_time_(0)
+{
+}
+
+// Each thread is enrolled by one job, as each job holds its thread until all
+// have arrived. Otherwise a thread could take two jobs and another none.
+bool validation_pools::member::start()
+{
+    struct barrier
+    {
+        std::mutex mutex;
+        std::condition_variable arrived;
+        size_t count;
+        bool success;
+    };
+
+    const auto count = dispatch.size();
+    const auto state = std::make_shared<barrier>();
+    state->count = 0;
+    state->success = true;
+
+    for (size_t index = 0; index < count; ++index)
+    {
+        dispatch.concurrent([this, state, index, count]()
+        {
+            const auto enrolled = enroll(index);
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->success &= enrolled;
+
+            if (++state->count == count)
+                state->arrived.notify_all();
+            else
+                state->arrived.wait(lock, [state, count]()
+                {
+                    return state->count == count;
+                });
+            ///////////////////////////////////////////////////////////////////
+        });
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->arrived.wait(lock, [state, count]()
+    {
+        return state->count == count;
+    });
+
+    const auto success = state->success;
+    lock.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> guard(mutex_);
+    processor_time_ = processor_time();
+    sampled_ = asio::steady_clock::now();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return success;
+}
+
+double validation_pools::member::utilization()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto now = asio::steady_clock::now();
+    const auto time = processor_time();
+    const auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now - sampled_).count();
+    const auto capacity = static_cast<double>(wall) * clocks_.size();
+    const auto used = static_cast<double>(time - processor_time_);
+
+    processor_time_ = time;
+    sampled_ = now;
+    return capacity <= 0.0 ? 0.0 : used / capacity;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Called on a pool thread, registers its clock and pins it if configured.
+bool validation_pools::member::enroll(size_t index)
+{
+#ifdef __linux__
+    clockid_t clock;
+    if (pthread_getcpuclockid(pthread_self(), &clock) == 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clocks_.push_back(static_cast<int>(clock));
+    }
+
+    if (pinned_.empty())
+        return true;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(pinned_[index % pinned_.size()], &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return pinned_.empty();
+#endif
+}
+
+// private
+// This is protected by mutex.
+uint64_t validation_pools::member::processor_time() const
+{
+    uint64_t total = 0;
+
+#ifdef __linux__
+    for (const auto clock: clocks_)
+    {
+        timespec time;
+        if (clock_gettime(static_cast<clockid_t>(clock), &time) == 0)
+            total += static_cast<uint64_t>(time.tv_sec) * 1000000000u +
+                static_cast<uint64_t>(time.tv_nsec);
+    }
+#endif
+
+    return total;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
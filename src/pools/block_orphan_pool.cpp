@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/block_orphan_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+block_orphan_pool::block_orphan_pool(size_t maximum_count,
+    size_t maximum_bytes)
+  : orphans_(maximum_count, maximum_bytes)
+{
+}
+
+size_t block_orphan_pool::size() const
+{
+    return orphans_.size();
+}
+
+size_t block_orphan_pool::bytes() const
+{
+    return orphans_.bytes();
+}
+
+bool block_orphan_pool::add(block_const_ptr block)
+{
+    const auto size = block->chain::block::serialized_size(true);
+    const auto& parent = block->header().previous_block_hash();
+    return orphans_.add(block, block->hash(), { parent }, size);
+}
+
+block_const_ptr_list block_orphan_pool::remove(const hash_digest& parent)
+{
+    return orphans_.remove(parent);
+}
+
+void block_orphan_pool::filter(get_data_ptr message) const
+{
+    auto& inventories = message->inventories();
+
+    const auto matched = [this](const message::inventory_vector& inventory)
+    {
+        return inventory.is_block_type() && orphans_.exists(inventory.hash());
+    };
+
+    // Compact the vector in one pass (no repeated vector moves).
+    inventories.erase(std::remove_if(inventories.begin(), inventories.end(),
+        matched), inventories.end());
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
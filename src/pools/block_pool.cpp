@@ -20,21 +20,56 @@
 
 #include <algorithm>
 #include <cstddef>
-#include <utility>
+#include <ios>
+#include <iterator>
+#include <memory>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/database.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 
-// Atomicity is not required for these operations as each validation call is
-// sequenced. Locking is performed only to guard concurrent filtering.
+// Each write is atomic within the forest, under a single exclusive lock.
+// Filtering reads a membership snapshot and so is never blocked by writes.
+
+// A spilled block is replaced in the forest by a stub carrying only its
+// header (and header validation state). Stubs are distinguishable because
+// every valid block contains at least a coinbase transaction. Released scratch
+// extents are coalesced and reused, so the file is bounded by the peak spill.
+// Spilled blocks are read back under a shared lock and restored to the forest
+// under a brief exclusive lock, so get_path never writes the scratch file.
 
 namespace libbitcoin {
 namespace blockchain {
 
-using namespace boost;
+using namespace bc::chain;
+using namespace bc::database;
 
 block_pool::block_pool(size_t maximum_depth)
-  : maximum_depth_(maximum_depth == 0 ? max_size_t : maximum_depth)
+  : block_pool(maximum_depth, 0, {})
+{
+}
+
+block_pool::block_pool(size_t maximum_depth, size_t maximum_bytes,
+    const boost::filesystem::path& scratch_file)
+  : maximum_depth_(maximum_depth == 0 ? max_size_t : maximum_depth),
+    maximum_bytes_(scratch_file.empty() ? 0 : maximum_bytes),
+    scratch_file_(scratch_file),
+    bytes_(0),
+    scratch_end_(0)
+{
+}
+
+block_pool::~block_pool()
 {
+    if (!scratch_)
+        return;
+
+    scratch_->close();
+
+    // The scratch file is not persistent across sessions.
+    boost::system::error_code ec;
+    boost::filesystem::remove(scratch_file_, ec);
 }
 
 size_t block_pool::size() const
@@ -42,35 +77,44 @@ size_t block_pool::size() const
     return blocks_.size();
 }
 
+size_t block_pool::bytes() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return bytes_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t block_pool::spilled() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return extents_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 void block_pool::add(block_const_ptr valid_block)
 {
     // The block must be successfully validated.
     ////BITCOIN_ASSERT(!block->validation.error);
-    block_entry entry{ valid_block };
+    const auto& header = valid_block->header();
 
-    // Not all blocks will have validation state.
-    ////BITCOIN_ASSERT(block->validation.state);
-    auto height = valid_block->header().validation.height;
-    const auto& left = blocks_.left;
-
-    // Caller ensure the entry does not exist by using get_path, but
-    // insert rejects the block if there is an entry of the same hash.
-    ////BITCOIN_ASSERT(left.find(entry) == left.end());
-
-    // Add a back pointer from the parent for clearing the path later.
-    const block_entry parent{ valid_block->header().previous_block_hash() };
-    const auto it = left.find(parent);
-
-    if (it != left.end())
-    {
-        height = 0;
-        it->first.add_child(valid_block);
-    }
+    const auto hash = valid_block->hash();
 
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     unique_lock lock(mutex_);
-    blocks_.insert({ std::move(entry), height });
+
+    // Caller ensure the entry does not exist by using get_path, but
+    // add rejects the block if there is an entry of the same hash.
+    if (!blocks_.add(valid_block, hash, header.previous_block_hash(),
+        header.validation.height))
+        return;
+
+    admit(hash, valid_block->chain::block::serialized_size(true));
+    spill_excess();
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -85,198 +129,344 @@ void block_pool::add(block_const_ptr_list_const_ptr valid_blocks)
 // or acceptance. So there is never internal removal of a node.
 void block_pool::remove(block_const_ptr_list_const_ptr accepted_blocks)
 {
-    hash_list child_hashes;
-    auto saver = [&](const hash_digest& hash){ child_hashes.push_back(hash); };
-    auto& left = blocks_.left;
+    hash_list hashes;
+    hashes.reserve(accepted_blocks->size());
 
-    for (auto block: *accepted_blocks)
-    {
-        auto it = left.find(block_entry{ block->hash() });
+    for (const auto block: *accepted_blocks)
+        hashes.push_back(block->hash());
 
-        if (it == left.end())
-            continue;
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    blocks_.remove(hashes);
 
-        // Copy hashes of all children of nodes we delete.
-        const auto& children = it->first.children();
-        std::for_each(children.begin(), children.end(), saver);
+    for (const auto& hash: hashes)
+        forget(hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
 
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        unique_lock lock(mutex_);
-        left.erase(it);
-        ///////////////////////////////////////////////////////////////////////
-    }
+void block_pool::prune(size_t top_height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    const auto pruned = blocks_.prune(floor_subtract(top_height,
+        maximum_depth_));
 
-    // Move all children that we have orphaned to the root (give them height).
-    for (auto child: child_hashes)
-    {
-        auto it = left.find(block_entry{ child });
+    for (const auto& hash: pruned)
+        forget(hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
 
-        // Except for sub-branches all children should have been deleted above.
-        if (it == left.end())
-            continue;
+void block_pool::filter(get_data_ptr message) const
+{
+    auto& inventories = message->inventories();
 
-        // Copy the entry so that it can be deleted and replanted with height.
-        const auto copy = it->first;
-        const auto height = copy.block()->header().validation.height;
-        BITCOIN_ASSERT(it->second == 0);
+    const auto matched = [this](const message::inventory_vector& inventory)
+    {
+        return inventory.is_block_type() && blocks_.contains(inventory.hash());
+    };
 
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(mutex_);
-        left.erase(it);
-        blocks_.insert({ copy, height });
-        ///////////////////////////////////////////////////////////////////////
-    }
+    // Compact the vector in one pass (no repeated vector moves).
+    inventories.erase(std::remove_if(inventories.begin(), inventories.end(),
+        matched), inventories.end());
 }
 
 // protected
-void block_pool::prune(const hash_list& hashes, size_t minimum_height)
+bool block_pool::exists(block_const_ptr candidate_block) const
 {
-    hash_list child_hashes;
-    auto saver = [&](const hash_digest& hash){ child_hashes.push_back(hash); };
-    auto& left = blocks_.left;
+    // The block must not yet be successfully validated.
+    ////BITCOIN_ASSERT(candidate_block->validation.error);
+    return blocks_.find(candidate_block->hash()) != nullptr;
+}
 
-    for (auto& hash: hashes)
-    {
-        const auto it = left.find(block_entry{ hash });
-        BITCOIN_ASSERT(it != left.end());
+// protected
+block_const_ptr block_pool::parent(block_const_ptr block) const
+{
+    // The block may be validated (pool) or not (new).
+    return blocks_.find(block->header().previous_block_hash());
+}
 
-        const auto height = it->first.block()->header().validation.height;
+branch::ptr block_pool::get_path(block_const_ptr block) const
+{
+    const auto trace = std::make_shared<branch>();
+    block_forest::elements ancestors;
 
-        // Delete all roots and expired non-roots and recurse their children.
-        if (it->second != 0 || height < minimum_height)
-        {
-            // delete
-            const auto& children = it->first.children();
-            std::for_each(children.begin(), children.end(), saver);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
 
-            ///////////////////////////////////////////////////////////////////
-            // Critical Section
-            unique_lock lock(mutex_);
-            left.erase(it);
-            ///////////////////////////////////////////////////////////////////
+    // The path is traced under a single read of the forest.
+    if (!blocks_.ancestors(ancestors, block->hash(),
+        block->header().previous_block_hash()))
+    {
+        mutex_.unlock_shared();
+        return trace;
+    }
 
-            continue;
+    // Spilled ancestors are read back under the shared lock.
+    auto spilled = false;
+
+    for (auto& ancestor: ancestors)
+    {
+        if (is_spilled(ancestor))
+        {
+            // A stub has no transactions and so cannot be validated.
+            if (!read(ancestor, ancestor))
+            {
+                mutex_.unlock_shared();
+                return{};
+            }
+
+            spilled = true;
         }
+    }
 
-        // Copy the entry so that it can be deleted and replanted with height.
-        const auto copy = it->first;
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
 
+    if (spilled)
+    {
         // Critical Section
         ///////////////////////////////////////////////////////////////////////
         unique_lock lock(mutex_);
-        left.erase(it);
-        blocks_.insert({ copy, height });
+
+        // Excess is spilled on the next add, so there is no write here.
+        for (auto& ancestor: ancestors)
+            ancestor = restore(ancestor);
         ///////////////////////////////////////////////////////////////////////
     }
 
-    // Recurse the children to span the tree.
-    if (!child_hashes.empty())
-        prune(child_hashes, minimum_height);
+    trace->push_front(block);
+
+    for (const auto& ancestor: ancestors)
+        trace->push_front(ancestor);
+
+    return trace;
 }
 
-void block_pool::prune(size_t top_height)
+// private
+//-----------------------------------------------------------------------------
+
+bool block_pool::is_spilled(block_const_ptr block)
 {
-    hash_list hashes;
-    const auto minimum_height = floor_subtract(top_height, maximum_depth_);
+    return block->transactions().empty();
+}
 
-    // TODO: not using table sort here, should stop iterating once above min.
-    // Iterate over all root nodes with insufficient height.
-    for (auto it: blocks_.right)
-        if (it.first != 0 && it.first < minimum_height)
-            hashes.push_back(it.second.hash());
+void block_pool::admit(const hash_digest& hash, size_t size) const
+{
+    if (maximum_bytes_ == 0)
+        return;
 
-    // Get outside of the hash table iterator before deleting.
-    if (!hashes.empty())
-        prune(hashes, minimum_height);
+    const auto position = queue_.insert(queue_.end(), hash);
+    residents_.emplace(hash, resident{ position, size });
+    bytes_ = ceiling_add(bytes_, size);
 }
 
-void block_pool::filter(get_data_ptr message) const
+void block_pool::forget(const hash_digest& hash) const
 {
-    auto& inventories = message->inventories();
-    const auto& left = blocks_.left;
+    const auto it = residents_.find(hash);
+
+    if (it != residents_.end())
+    {
+        bytes_ = floor_subtract(bytes_, it->second.size);
+        queue_.erase(it->second.position);
+        residents_.erase(it);
+        return;
+    }
+
+    const auto spilled = extents_.find(hash);
+
+    if (spilled != extents_.end())
+    {
+        release(spilled->second);
+        extents_.erase(spilled);
+    }
+}
+
+void block_pool::spill_excess() const
+{
+    // Spill the oldest resident blocks until within budget.
+    while (bytes_ > maximum_bytes_ && !queue_.empty())
+        if (!spill(queue_.front()))
+            forget(queue_.front());
+}
+
+bool block_pool::spill(const hash_digest& hash) const
+{
+    const auto block = blocks_.find(hash);
+
+    if (!block || is_spilled(block) || !open_scratch())
+        return false;
 
-    for (auto it = inventories.begin(); it != inventories.end();)
+    const auto data = block->chain::block::to_data(true);
+    const auto offset = allocate(data.size());
+
+    // The memory pointer holds the map lock and must not outlive this scope.
     {
-        if (!it->is_block_type())
+        const auto memory = scratch_->reserve(offset + data.size());
+
+        if (!memory)
         {
-            ++it;
-            continue;
+            release({ offset, data.size() });
+            return false;
         }
 
-        const block_entry entry{ it->hash() };
+        std::copy(data.begin(), data.end(), memory->buffer() + offset);
+    }
 
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        mutex_.lock_shared();
-        const auto found = (left.find(entry) != left.end());
-        mutex_.unlock_shared();
-        ///////////////////////////////////////////////////////////////////////
+    // The stub retains the header validation state (height, mtp).
+    const auto stub = std::make_shared<const message::block>(block->header(),
+        transaction::list{});
 
-        // TODO: optimize (prevent repeating vector moves).
-        it = found ? inventories.erase(it) : it + 1;
+    if (!blocks_.replace(hash, stub))
+    {
+        release({ offset, data.size() });
+        return false;
     }
+
+    forget(hash);
+    extents_.emplace(hash, extent{ offset, data.size() });
+    return true;
 }
 
-// protected
-bool block_pool::exists(block_const_ptr candidate_block) const
+// The full block is returned in out_block, false if it cannot be read.
+bool block_pool::read(block_const_ptr& out_block, block_const_ptr stub) const
 {
-    // The block must not yet be successfully validated.
-    ////BITCOIN_ASSERT(candidate_block->validation.error);
-    const auto& left = blocks_.left;
+    const auto hash = stub->hash();
+    const auto it = extents_.find(hash);
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
-    return left.find(block_entry{ candidate_block }) != left.end();
-    ///////////////////////////////////////////////////////////////////////////
+    if (it == extents_.end())
+    {
+        LOG_FATAL(LOG_BLOCKCHAIN)
+            << "Missing spilled block [" << encode_hash(hash) << "]";
+        return false;
+    }
+
+    data_chunk data;
+    const auto offset = it->second.offset;
+    const auto size = it->second.size;
+
+    // The memory pointer holds the map lock and must not outlive this scope.
+    {
+        const auto memory = scratch_->access();
+        const auto start = memory->buffer() + offset;
+        data.assign(start, start + size);
+    }
+
+    chain::block full;
+
+    if (!full.from_data(data, true))
+    {
+        LOG_FATAL(LOG_BLOCKCHAIN)
+            << "Failure loading spilled block [" << encode_hash(hash) << "]";
+        return false;
+    }
+
+    // Restore the header validation state retained by the stub.
+    full.header().validation = stub->header().validation;
+    out_block = std::make_shared<const message::block>(std::move(full));
+    return true;
 }
 
-// protected
-block_const_ptr block_pool::parent(block_const_ptr block) const
+// Replace the stub of a read block, unless it was restored concurrently.
+block_const_ptr block_pool::restore(block_const_ptr block) const
 {
-    // The block may be validated (pool) or not (new).
-    const block_entry parent_entry{ block->header().previous_block_hash() };
-    const auto& left = blocks_.left;
+    const auto hash = block->hash();
+    const auto it = extents_.find(hash);
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
-    const auto parent = left.find(parent_entry);
-    return parent == left.end() ? nullptr : parent->first.block();
-    ///////////////////////////////////////////////////////////////////////////
+    if (it == extents_.end())
+    {
+        const auto current = blocks_.find(hash);
+        return current ? current : block;
+    }
+
+    if (is_spilled(block) || !blocks_.replace(hash, block))
+        return block;
+
+    const auto size = it->second.size;
+    forget(hash);
+    admit(hash, size);
+    return block;
 }
 
-branch::ptr block_pool::get_path(block_const_ptr block) const
+// First fit from released extents, otherwise appended to the file.
+size_t block_pool::allocate(size_t size) const
 {
-    ////log_content();
-    const auto trace = std::make_shared<branch>();
+    for (auto it = free_.begin(); it != free_.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
 
-    if (exists(block))
-        return trace;
+        const auto offset = it->first;
+        const auto remainder = it->second - size;
+        free_.erase(it);
+
+        if (remainder != 0)
+            free_.emplace(offset + size, remainder);
 
-    while (block)
+        return offset;
+    }
+
+    const auto offset = scratch_end_;
+    scratch_end_ += size;
+    return offset;
+}
+
+// Coalesce with adjacent released extents and trim the end of the file.
+void block_pool::release(const extent& extent) const
+{
+    auto offset = extent.offset;
+    auto size = extent.size;
+    auto next = free_.lower_bound(offset);
+
+    if (next != free_.end() && offset + size == next->first)
     {
-        trace->push_front(block);
-        block = parent(block);
+        size += next->second;
+        next = free_.erase(next);
     }
 
-    return trace;
+    if (next != free_.begin())
+    {
+        const auto prior = std::prev(next);
+
+        if (prior->first + prior->second == offset)
+        {
+            offset = prior->first;
+            size += prior->second;
+            free_.erase(prior);
+        }
+    }
+
+    if (offset + size == scratch_end_)
+        scratch_end_ = offset;
+    else
+        free_.emplace(offset, size);
 }
 
-////// private
-////void block_pool::log_content() const
-////{
-////    LOG_INFO(LOG_BLOCKCHAIN) << "pool: ";
-////
-////    // Dump in hash order with height suffix (roots have height).
-////    for (const auto& entry: blocks_.left)
-////    {
-////        LOG_INFO(LOG_BLOCKCHAIN)
-////            << entry.first << " " << entry.second;
-////    }
-////}
+bool block_pool::open_scratch() const
+{
+    if (scratch_)
+        return true;
+
+    // The map requires a nonzero file size, so start with a single byte.
+    {
+        bc::ofstream file(scratch_file_.string(), std::ios::binary);
+
+        if (file.bad())
+            return false;
+
+        file.put(0x00);
+    }
+
+    const auto scratch = std::make_shared<memory_map>(scratch_file_);
+
+    if (!scratch->open())
+        return false;
+
+    scratch_ = scratch;
+    return true;
+}
 
 } // namespace blockchain
 } // namespace libbitcoin
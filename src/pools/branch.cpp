@@ -175,43 +175,24 @@ uint256_t branch::work() const
 ////}
 
 // TODO: convert to a direct block pool query when the branch goes away.
-void branch::populate_spent(const output_point& outpoint) const
+// Assuming (1) block.check() validates against internal double spends and
+// (2) the outpoint is of the top block, there is no need to consider the top
+// block here. Under these assumptions spends in the top block could only be
+// double spent by a spend in a preceding block.
+outpoint_table branch::spends() const
 {
-    auto& prevout = outpoint.validation;
-
-    // Assuming (1) block.check() validates against internal double spends
-    // and (2) the outpoint is of the top block, there is no need to consider
-    // the top block here. Under these assumptions spends in the top block
-    // could only be double spent by a spend in a preceding block. Excluding
-    // the top block requires that we consider 1 collision spent (vs. > 1).
     if (size() < 2u)
-    {
-        prevout.spent = false;
-        prevout.confirmed = false;
-        return;
-    }
-
-    // TODO: use hash table storage of block's inputs for block pool entries.
-    const auto blocks = [&outpoint](block_const_ptr block)
-    {
-        const auto transactions = [&outpoint](const transaction& tx)
-        {
-            const auto prevout_match = [&outpoint](const input& input)
-            {
-                return input.previous_output() == outpoint;
-            };
+        return{};
 
-            const auto& ins = tx.inputs();
-            return std::any_of(ins.begin(), ins.end(), prevout_match);
-        };
-
-        const auto& txs = block->transactions();
-        BITCOIN_ASSERT_MSG(!txs.empty(), "empty block in branch");
-        return std::any_of(txs.begin() + 1, txs.end(), transactions);
-    };
+    return{ block_const_ptr_list(blocks_->begin(), blocks_->end() - 1) };
+}
 
-    auto spent = std::any_of(blocks_->begin(), blocks_->end() - 1, blocks);
-    prevout.spent = spent;
+// This is a binary search of the sorted spends, built once per population.
+void branch::populate_spent(const outpoint_table& spends,
+    const output_point& outpoint) const
+{
+    auto& prevout = outpoint.validation;
+    prevout.spent = spends.contains(outpoint);
     prevout.confirmed = prevout.spent;
 }
 
@@ -0,0 +1,393 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/header_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/settings.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+using namespace bc::config;
+
+static constexpr uint32_t unspecified = max_uint32;
+
+// The index holds 44 bytes per header, about 44MB for a million headers.
+// Difficulty and median time past are computed by chain state, populated
+// from the index. Other contextual header rules (e.g. version) are applied
+// when the block is organized, as they do not affect the cost of producing
+// a competing header chain.
+
+header_index::header_index(const settings& settings)
+  : forks_(settings.enabled_forks()),
+    checkpoints_(checkpoint::sort(settings.checkpoints)),
+    work_(0)
+{
+}
+
+void header_index::start(const header& genesis)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    side_.clear();
+    entries_.clear();
+    entries_.push_back({ genesis.hash(), genesis.bits(), genesis.version(),
+        genesis.timestamp() });
+    work_ = block::proof(genesis.bits());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t header_index::top_height() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return entries_.empty() ? 0 : entries_.size() - 1u;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+uint256_t header_index::work() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return work_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_index::get_hash(hash_digest& out_hash, size_t height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (height >= entries_.size())
+        return false;
+
+    out_hash = entries_[height].hash;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_index::is_indexed(const hash_digest& hash, size_t height) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return height < entries_.size() && entries_[height].hash == hash;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Headers are added one at a time, so a competing branch is retained from
+// its first header, before it has accumulated enough work to be indexed.
+code header_index::add(const header::list& headers)
+{
+    size_t fork;
+    entries branch;
+    uint256_t work;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto& header: headers)
+    {
+        const auto hash = header.hash();
+
+        if (side_.find(hash) != side_.end())
+            continue;
+
+        if (!trace(fork, branch, work, header.previous_block_hash()))
+            return error::orphan_block;
+
+        // Skip the header if it is already indexed.
+        if (branch.empty() && fork + 1u < entries_.size() &&
+            entries_[fork + 1u].hash == hash)
+            continue;
+
+        const auto height = fork + branch.size() + 1u;
+        const auto ec = validate(header, height, fork, branch);
+
+        if (ec)
+            return ec;
+
+        work += block::proof(header.bits());
+        link({ hash, header.bits(), header.version(), header.timestamp() },
+            header.previous_block_hash(), fork, branch, work);
+    }
+
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The store accepts blocks that may not have been announced by header, so
+// its branches are added here. The outgoing headers are added first so that
+// the incoming branch is compared against them by cumulative work.
+code header_index::reorganize(const header::list& incoming,
+    const header::list& outgoing)
+{
+    // Outgoing headers may have already been pruned from the index.
+    add(outgoing);
+    return add(incoming);
+}
+
+// protected
+// Forks are limited to one retargeting interval below the top, which bounds
+// both the search and the work of comparing branches.
+bool header_index::find_indexed(size_t& out_height,
+    const hash_digest& hash) const
+{
+    if (entries_.empty())
+        return false;
+
+    const auto top = entries_.size() - 1u;
+    const auto floor = floor_subtract(top, size_t(retargeting_interval));
+
+    for (auto height = top + 1u; height > floor; --height)
+    {
+        if (entries_[height - 1u].hash == hash)
+        {
+            out_height = height - 1u;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// protected
+// The branch is the side branch (if any) from above the fork to the parent.
+bool header_index::trace(size_t& out_fork, entries& out_branch,
+    uint256_t& out_work, const hash_digest& parent) const
+{
+    out_branch.clear();
+    auto hash = parent;
+    const side_entry* tip = nullptr;
+
+    for (auto it = side_.find(hash); it != side_.end(); it = side_.find(hash))
+    {
+        if (tip == nullptr)
+            tip = &it->second;
+
+        out_branch.push_back(it->second.header);
+        hash = it->second.parent;
+    }
+
+    if (!find_indexed(out_fork, hash))
+        return false;
+
+    std::reverse(out_branch.begin(), out_branch.end());
+    out_work = tip == nullptr ? work_at(out_fork) : tip->work;
+    return true;
+}
+
+// protected
+// The cumulative work of the indexed headers to and including the height.
+uint256_t header_index::work_at(size_t height) const
+{
+    auto work = work_;
+
+    for (auto index = height + 1u; index < entries_.size(); ++index)
+        work -= block::proof(entries_[index].bits);
+
+    return work;
+}
+
+// protected
+// Heights at or below the fork are indexed, heights above are in the branch.
+const header_index::entry& header_index::at(size_t height, size_t fork,
+    const entries& branch) const
+{
+    return height <= fork ? entries_[height] : branch[height - fork - 1u];
+}
+
+// protected
+// The path includes the header, so the chain state is that of the header.
+bool header_index::populate(chain_state::data& data, size_t height,
+    size_t fork, const entries& path) const
+{
+    const auto map = chain_state::get_map(height, checkpoints_, forks_);
+    const auto unrequested = chain_state::map::unrequested;
+    const auto top = fork + path.size();
+
+    if ((map.bits.count != 0 && map.bits.high > top) ||
+        (map.version.count != 0 && map.version.high > top) ||
+        (map.timestamp.count != 0 && map.timestamp.high > top) ||
+        map.bits_self > top || map.version_self > top ||
+        map.timestamp_self > top ||
+        (map.timestamp_retarget != unrequested &&
+            map.timestamp_retarget > top) ||
+        (map.allow_collisions_height != unrequested &&
+            map.allow_collisions_height > top) ||
+        (map.bip9_bit0_height != unrequested && map.bip9_bit0_height > top) ||
+        (map.bip9_bit1_height != unrequested && map.bip9_bit1_height > top))
+        return false;
+
+    data.height = height;
+    data.hash = at(height, fork, path).hash;
+
+    auto& bits = data.bits.ordered;
+    bits.resize(map.bits.count);
+    auto index = map.bits.high - map.bits.count;
+
+    for (auto& bit: bits)
+        bit = at(++index, fork, path).bits;
+
+    auto& versions = data.version.ordered;
+    versions.resize(map.version.count);
+    index = map.version.high - map.version.count;
+
+    for (auto& version: versions)
+        version = at(++index, fork, path).version;
+
+    auto& timestamps = data.timestamp.ordered;
+    timestamps.resize(map.timestamp.count);
+    index = map.timestamp.high - map.timestamp.count;
+
+    for (auto& timestamp: timestamps)
+        timestamp = at(++index, fork, path).timestamp;
+
+    data.bits.self = at(map.bits_self, fork, path).bits;
+    data.version.self = at(map.version_self, fork, path).version;
+    data.timestamp.self = at(map.timestamp_self, fork, path).timestamp;
+
+    data.timestamp.retarget = map.timestamp_retarget == unrequested ?
+        unspecified : at(map.timestamp_retarget, fork, path).timestamp;
+
+    data.allow_collisions_hash = map.allow_collisions_height == unrequested ?
+        null_hash : at(map.allow_collisions_height, fork, path).hash;
+
+    data.bip9_bit0_hash = map.bip9_bit0_height == unrequested ? null_hash :
+        at(map.bip9_bit0_height, fork, path).hash;
+
+    data.bip9_bit1_hash = map.bip9_bit1_height == unrequested ? null_hash :
+        at(map.bip9_bit1_height, fork, path).hash;
+
+    return true;
+}
+
+// protected
+code header_index::validate(const header& header, size_t height,
+    size_t fork, const entries& branch) const
+{
+    // Proof of work against the header's own bits, and timestamp limit.
+    const auto ec = header.check();
+
+    if (ec)
+        return ec;
+
+    const auto hash = header.hash();
+
+    if (!checkpoint::validate(hash, height, checkpoints_))
+        return error::checkpoints_failed;
+
+    auto path = branch;
+    path.push_back({ hash, header.bits(), header.version(),
+        header.timestamp() });
+
+    chain_state::data data;
+
+    if (!populate(data, height, fork, path))
+        return error::operation_failed;
+
+    // Retargeting (including minimum difficulty blocks) is per chain state.
+    const chain_state state(std::move(data), checkpoints_, forks_);
+
+    if (header.timestamp() <= state.median_time_past())
+        return error::timestamp_too_early;
+
+    if (header.bits() != state.work_required())
+        return error::incorrect_proof_of_work;
+
+    return error::success;
+}
+
+// protected
+// The work is the cumulative work of the chain to and including the header.
+void header_index::link(const entry& header, const hash_digest& parent,
+    size_t fork, const entries& branch, const uint256_t& work)
+{
+    const auto top = entries_.size() - 1u;
+
+    // The header extends the indexed branch.
+    if (branch.empty() && fork == top)
+    {
+        entries_.push_back(header);
+        work_ = work;
+        prune();
+        return;
+    }
+
+    // A side branch replaces the indexed branch only with more work.
+    if (work <= work_)
+    {
+        const auto height = fork + branch.size() + 1u;
+        side_.emplace(header.hash, side_entry{ header, parent, height, work });
+        return;
+    }
+
+    // The replaced headers are retained as a side branch.
+    auto replaced = work_at(fork);
+
+    for (auto height = fork + 1u; height <= top; ++height)
+    {
+        const auto& displaced = entries_[height];
+        replaced += block::proof(displaced.bits);
+        side_.emplace(displaced.hash, side_entry{ displaced,
+            entries_[height - 1u].hash, height, replaced });
+    }
+
+    entries_.resize(fork + 1u);
+
+    for (const auto& ancestor: branch)
+    {
+        side_.erase(ancestor.hash);
+        entries_.push_back(ancestor);
+    }
+
+    entries_.push_back(header);
+    work_ = work;
+    prune();
+}
+
+// protected
+// Side headers at or below the fork floor can no longer be indexed.
+void header_index::prune()
+{
+    const auto top = entries_.size() - 1u;
+    const auto floor = floor_subtract(top, size_t(retargeting_interval));
+
+    for (auto it = side_.begin(); it != side_.end();)
+    {
+        if (it->second.height <= floor)
+            it = side_.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+outpoint_table::outpoint_table()
+  : groups_{ 0 }
+{
+}
+
+outpoint_table::outpoint_table(const block& block)
+{
+    outpoints_.reserve(block.total_non_coinbase_inputs());
+    add(block);
+    sort();
+}
+
+outpoint_table::outpoint_table(const block_const_ptr_list& blocks)
+{
+    size_t inputs = 0;
+    for (const auto& block: blocks)
+        inputs += block->total_non_coinbase_inputs();
+
+    outpoints_.reserve(inputs);
+
+    for (const auto& block: blocks)
+        add(*block);
+
+    sort();
+}
+
+size_t outpoint_table::size() const
+{
+    return outpoints_.size();
+}
+
+size_t outpoint_table::groups() const
+{
+    return groups_.size() - 1u;
+}
+
+outpoint_table::range outpoint_table::group(size_t position) const
+{
+    BITCOIN_ASSERT(position < groups());
+    const auto begin = outpoints_.begin();
+    return
+    {
+        begin + groups_[position],
+        begin + groups_[position + 1u]
+    };
+}
+
+bool outpoint_table::contains(const output_point& outpoint) const
+{
+    const auto compare = [](const output_point* left,
+        const output_point& right)
+    {
+        return less(*left, right);
+    };
+
+    const auto it = std::lower_bound(outpoints_.begin(), outpoints_.end(),
+        outpoint, compare);
+
+    return it != outpoints_.end() && **it == outpoint;
+}
+
+bool outpoint_table::is_double_spend() const
+{
+    const auto equal = [](const output_point* left, const output_point* right)
+    {
+        return *left == *right;
+    };
+
+    return std::adjacent_find(outpoints_.begin(), outpoints_.end(), equal) !=
+        outpoints_.end();
+}
+
+// protected
+bool outpoint_table::less(const output_point& left, const output_point& right)
+{
+    const auto& left_hash = left.hash();
+    const auto& right_hash = right.hash();
+    return left_hash < right_hash ||
+        (left_hash == right_hash && left.index() < right.index());
+}
+
+// protected
+// Must skip coinbase here as it has no prevout.
+void outpoint_table::add(const block& block)
+{
+    const auto& txs = block.transactions();
+
+    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx)
+        for (const auto& input: tx->inputs())
+            outpoints_.push_back(&input.previous_output());
+}
+
+// protected
+// A comparison sort, as a partial radix order leaves runs that share leading
+// hash bytes (which a block may be crafted to contain) to a quadratic pass.
+void outpoint_table::sort()
+{
+    const auto compare = [](const output_point* left,
+        const output_point* right)
+    {
+        return less(*left, *right);
+    };
+
+    std::sort(outpoints_.begin(), outpoints_.end(), compare);
+
+    groups_.clear();
+
+    for (size_t position = 0; position < outpoints_.size(); ++position)
+        if (position == 0 || outpoints_[position]->hash() !=
+            outpoints_[position - 1u]->hash())
+            groups_.push_back(position);
+
+    groups_.push_back(outpoints_.size());
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
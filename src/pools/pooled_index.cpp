@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/pooled_index.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+// No set of enabled forks has all bits set, so this is never current.
+const uint32_t pooled_index::unverified = max_uint32;
+
+pooled_index::pooled_index(size_t capacity)
+  : sequence_(0), order_(capacity)
+{
+}
+
+size_t pooled_index::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return pooled_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool pooled_index::find(uint32_t& out_forks, const hash_digest& hash) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto it = pooled_.find(hash);
+
+    if (it == pooled_.end())
+        return false;
+
+    out_forks = it->second.first;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_index::add(const transaction& tx, uint32_t forks)
+{
+    const auto hash = tx.hash();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    insert(hash, forks);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Coinbase transactions cannot be pooled, so are not indexed (store read).
+void pooled_index::add(const block_const_ptr_list& outgoing_blocks)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto& block: outgoing_blocks)
+    {
+        const auto& txs = block->transactions();
+
+        for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx)
+            insert(tx->hash(), unverified);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_index::remove(const hash_digest& hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    pooled_.erase(hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void pooled_index::remove(const block_const_ptr_list& incoming_blocks)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto& block: incoming_blocks)
+        for (const auto& tx: block->transactions())
+            pooled_.erase(tx.hash());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+void pooled_index::insert(const hash_digest& hash, uint32_t forks)
+{
+    if (order_.capacity() == 0)
+        return;
+
+    const auto it = pooled_.find(hash);
+
+    if (it != pooled_.end())
+    {
+        it->second.first = forks;
+        return;
+    }
+
+    // Removed entries leave stale slots, which must not erase a newer entry.
+    if (order_.full())
+    {
+        const auto& oldest = order_.front();
+        const auto old = pooled_.find(oldest.first);
+
+        if (old != pooled_.end() && old->second.second == oldest.second)
+            pooled_.erase(old);
+    }
+
+    const auto sequence = sequence_++;
+    order_.push_back({ hash, sequence });
+    pooled_.emplace(hash, entry{ forks, sequence });
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
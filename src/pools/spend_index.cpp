@@ -0,0 +1,312 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/spend_index.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+size_t spend_index::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return spends_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_digest spend_index::spender(const output_point& outpoint) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto it = spends_.find(outpoint);
+    return it == spends_.end() ? null_hash : it->second;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool spend_index::conflicts(const transaction& tx) const
+{
+    const auto hash = tx.hash();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    for (const auto& input: tx.inputs())
+    {
+        const auto it = spends_.find(input.previous_output());
+
+        if (it != spends_.end() && it->second != hash)
+            return true;
+    }
+
+    return false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool spend_index::add(const transaction& tx)
+{
+    const auto hash = tx.hash();
+    const auto outputs = static_cast<uint32_t>(tx.outputs().size());
+    point::list points;
+    points.reserve(tx.inputs().size());
+
+    for (const auto& input: tx.inputs())
+        points.push_back(input.previous_output());
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (spenders_.find(hash) != spenders_.end())
+        return true;
+
+    for (const auto& point: points)
+        if (spends_.find(point) != spends_.end())
+            return false;
+
+    for (const auto& point: points)
+        spends_.emplace(point, hash);
+
+    spenders_.emplace(hash, spender{ std::move(points), outputs });
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void spend_index::add(const block_const_ptr_list& outgoing_blocks)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto block: outgoing_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            if (tx.is_coinbase())
+                continue;
+
+            const auto hash = tx.hash();
+            point::list points;
+
+            // Confirmed spends cannot conflict with pool spends.
+            for (const auto& input: tx.inputs())
+            {
+                const auto& prevout = input.previous_output();
+
+                if (spends_.emplace(prevout, hash).second)
+                    points.push_back(prevout);
+            }
+
+            if (points.empty())
+                continue;
+
+            const auto outputs = static_cast<uint32_t>(tx.outputs().size());
+            spenders_.emplace(hash, spender{ std::move(points), outputs });
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void spend_index::remove(const hash_digest& tx_hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    erase(tx_hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_list spend_index::remove(const block_const_ptr_list& incoming_blocks)
+{
+    hash_list evicted;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto block: incoming_blocks)
+    {
+        for (const auto& tx: block->transactions())
+        {
+            if (tx.is_coinbase())
+                continue;
+
+            const auto hash = tx.hash();
+
+            for (const auto& input: tx.inputs())
+            {
+                const auto it = spends_.find(input.previous_output());
+
+                if (it == spends_.end())
+                    continue;
+
+                // Copy the spender as erasure invalidates the iterator.
+                const auto spender = it->second;
+
+                // A confirmed pool tx leaves its descendants valid.
+                if (spender == hash)
+                    erase(spender);
+                else
+                    evict(spender, evicted);
+            }
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    return evicted;
+}
+
+// The file is written to a temporary and renamed, so it is never partial.
+bool spend_index::save(const boost::filesystem::path& file) const
+{
+    auto temporary = file;
+    temporary += ".tmp";
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    {
+        bc::ofstream stream(temporary.string(), std::ios::binary);
+        ostream_writer sink(stream);
+        sink.write_8_bytes_little_endian(spenders_.size());
+
+        for (const auto& entry: spenders_)
+        {
+            sink.write_hash(entry.first);
+            sink.write_4_bytes_little_endian(entry.second.outputs);
+            sink.write_variable_little_endian(entry.second.points.size());
+
+            for (const auto& point: entry.second.points)
+                point.to_data(sink);
+        }
+
+        stream.flush();
+
+        if (!sink || stream.bad())
+            return false;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temporary, file, ec);
+    return !ec;
+}
+
+bool spend_index::load(const boost::filesystem::path& file)
+{
+    spend_map spends;
+    spender_map spenders;
+
+    {
+        bc::ifstream stream(file.string(), std::ios::binary);
+
+        if (!stream.good())
+            return false;
+
+        istream_reader source(stream);
+        const auto count = source.read_8_bytes_little_endian();
+
+        for (uint64_t entry = 0; entry < count && source; ++entry)
+        {
+            const auto hash = source.read_hash();
+            const auto outputs = source.read_4_bytes_little_endian();
+            const auto size = source.read_size_little_endian();
+            point::list points;
+
+            for (size_t index = 0; index < size && source; ++index)
+            {
+                point outpoint;
+                outpoint.from_data(source);
+                spends.emplace(outpoint, hash);
+                points.push_back(outpoint);
+            }
+
+            spenders.emplace(hash, spender{ std::move(points), outputs });
+        }
+
+        if (!source)
+            return false;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(file, ec);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    spends_.swap(spends);
+    spenders_.swap(spenders);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// protected
+void spend_index::erase(const hash_digest& tx_hash)
+{
+    const auto it = spenders_.find(tx_hash);
+
+    if (it == spenders_.end())
+        return;
+
+    for (const auto& point: it->second.points)
+        spends_.erase(point);
+
+    spenders_.erase(it);
+}
+
+// protected
+// Descendants spend the outputs of an evicted tx, so are evicted in turn.
+void spend_index::evict(const hash_digest& tx_hash, hash_list& evicted)
+{
+    hash_list queue{ tx_hash };
+
+    for (size_t position = 0; position < queue.size(); ++position)
+    {
+        const auto hash = queue[position];
+        const auto it = spenders_.find(hash);
+
+        if (it == spenders_.end())
+            continue;
+
+        const auto outputs = it->second.outputs;
+        erase(hash);
+        evicted.push_back(hash);
+
+        for (uint32_t index = 0; index < outputs; ++index)
+        {
+            const auto child = spends_.find({ hash, index });
+
+            if (child != spends_.end())
+                queue.push_back(child->second);
+        }
+    }
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/transaction_metrics.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+using namespace bc::machine;
+
+static const size_t base_size_factor = 3;
+
+transaction_metrics::transaction_metrics(const transaction& tx,
+    uint32_t forks)
+  : hash_(tx.hash()),
+    witness_hash_(tx.hash(true)),
+    forks_(forks),
+    sigops_(tx.signature_operations(
+        script::is_enabled(forks, rule_fork::bip16_rule),
+        script::is_enabled(forks, rule_fork::bip141_rule))),
+    size_(tx.serialized_size(true, false)),
+    witness_size_(tx.serialized_size(true, true)),
+    fees_(tx.fees()),
+    inputs_(tx.inputs().size()),
+    outputs_(tx.outputs().size())
+{
+}
+
+const hash_digest& transaction_metrics::hash() const
+{
+    return hash_;
+}
+
+const hash_digest& transaction_metrics::witness_hash() const
+{
+    return witness_hash_;
+}
+
+uint32_t transaction_metrics::forks() const
+{
+    return forks_;
+}
+
+bool transaction_metrics::is_sigops(bool bip16, bool bip141) const
+{
+    return script::is_enabled(forks_, rule_fork::bip16_rule) == bip16 &&
+        script::is_enabled(forks_, rule_fork::bip141_rule) == bip141;
+}
+
+size_t transaction_metrics::sigops() const
+{
+    return sigops_;
+}
+
+size_t transaction_metrics::size() const
+{
+    return size_;
+}
+
+size_t transaction_metrics::witness_size() const
+{
+    return witness_size_;
+}
+
+size_t transaction_metrics::weight() const
+{
+    return ceiling_add(base_size_factor * size_, witness_size_);
+}
+
+uint64_t transaction_metrics::fees() const
+{
+    return fees_;
+}
+
+size_t transaction_metrics::inputs() const
+{
+    return inputs_;
+}
+
+size_t transaction_metrics::outputs() const
+{
+    return outputs_;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/transaction_metrics_cache.hpp>
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/pools/transaction_metrics.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+transaction_metrics_cache::transaction_metrics_cache(size_t capacity)
+  : sequence_(0), order_(capacity)
+{
+}
+
+size_t transaction_metrics_cache::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    return metrics_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void transaction_metrics_cache::add(transaction_metrics::const_ptr metrics)
+{
+    if (order_.capacity() == 0)
+        return;
+
+    const auto& hash = metrics->hash();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    const auto it = metrics_.find(hash);
+
+    if (it != metrics_.end())
+    {
+        it->second.first = metrics;
+        return;
+    }
+
+    // Removed entries leave stale slots, which must not erase a newer entry.
+    if (order_.full())
+    {
+        const auto& oldest = order_.front();
+        const auto old = metrics_.find(oldest.first);
+
+        if (old != metrics_.end() && old->second.second == oldest.second)
+            metrics_.erase(old);
+    }
+
+    const auto sequence = sequence_++;
+    order_.push_back({ hash, sequence });
+    metrics_.emplace(hash, entry{ metrics, sequence });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+transaction_metrics::const_ptr transaction_metrics_cache::get(
+    const hash_digest& hash) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+    const auto it = metrics_.find(hash);
+    return it == metrics_.end() ? nullptr : it->second.first;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void transaction_metrics_cache::remove(const hash_digest& hash)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    metrics_.erase(hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void transaction_metrics_cache::remove(const block_const_ptr_list& blocks)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto block: blocks)
+        for (const auto& tx: block->transactions())
+            metrics_.erase(tx.hash());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
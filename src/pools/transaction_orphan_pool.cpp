@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/transaction_orphan_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+transaction_orphan_pool::transaction_orphan_pool(size_t maximum_count,
+    size_t maximum_bytes)
+  : orphans_(maximum_count, maximum_bytes)
+{
+}
+
+size_t transaction_orphan_pool::size() const
+{
+    return orphans_.size();
+}
+
+size_t transaction_orphan_pool::bytes() const
+{
+    return orphans_.bytes();
+}
+
+bool transaction_orphan_pool::add(transaction_const_ptr tx)
+{
+    hash_list parents;
+
+    for (const auto& input: tx->inputs())
+    {
+        const auto& prevout = input.previous_output();
+
+        if (prevout.is_null() || prevout.validation.cache.is_valid())
+            continue;
+
+        // A spent prevout is not missing, the tx is a double spend.
+        if (prevout.validation.spent)
+            return false;
+
+        parents.push_back(prevout.hash());
+    }
+
+    std::sort(parents.begin(), parents.end());
+    parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+    const auto size = tx->serialized_size(true, true);
+    return orphans_.add(tx, tx->hash(), std::move(parents), size);
+}
+
+transaction_const_ptr_list transaction_orphan_pool::remove(
+    const hash_digest& parent)
+{
+    return orphans_.remove(parent);
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
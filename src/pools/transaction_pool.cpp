@@ -78,8 +78,9 @@ transaction_entry::list transaction_pool::get_template() const
 void transaction_pool::add_unconfirmed_transactions(
     const transaction_const_ptr_list& unconfirmed_txs)
 {
-//    tranasaction_entry::ptr max_introduced(null_hash);
-    auto max_introduced = state_.pool.left.end();
+    // The entry is retained as pool iterators are invalidated by rehashing.
+    transaction_entry::ptr max_introduced;
+    priority max_priority = 0.0;
 
     // order the transactions to be added preferring parents before children
 
@@ -117,15 +118,19 @@ void transaction_pool::add_unconfirmed_transactions(
         state_.pool.insert({ unconfirmed_entry, unconfirmed_priority });
 
         // track encountered maximum priority
-        if (unconfirmed_priority > max_introduced->second)
-            max_introduced = state_.pool.left.find(unconfirmed_entry);
+        if (!max_introduced || unconfirmed_priority > max_priority)
+        {
+            max_introduced = unconfirmed_entry;
+            max_priority = unconfirmed_priority;
+        }
     }
 
     // Using remembered highest priority inserted new transaction,
     // invalidate cached solution below priority and recompute.
-    if (unconfirmed_txs.size() > 0)
+    if (max_introduced)
     {
-        auto projected = state_.pool.project_right(max_introduced);
+        auto projected = state_.pool.project_right(
+            state_.pool.left.find(max_introduced));
         update_template(projected);
     }
 }
@@ -400,11 +405,14 @@ struct plus_size
 
 void transaction_pool::update_template(priority_iterator max_pool_change)
 {
+    // The change point is the end of an empty pool.
+    const auto change = max_pool_change == state_.pool.right.end() ? 0.0 :
+        max_pool_change->first;
+
     // as max_changepoint may not be a value within the template,
     // walk the template entries until changepoint or a value less than it is
     // discovered
-    auto template_point = find_inflection(state_.block_template,
-        max_pool_change->first);
+    auto template_point = find_inflection(state_.block_template, change);
 
     // for each element in the template below this point, purge if
     // not depended upon by an entry of higher priority
@@ -422,7 +430,7 @@ void transaction_pool::update_template(priority_iterator max_pool_change)
             {
                 auto child_in_template = state_.block_template.left.find(child);
                 if ((child_in_template != state_.block_template.left.end()) &&
-                    (child_in_template->second > max_pool_change->first))
+                    (child_in_template->second > change))
                 {
                     purge = false;
                     break;
@@ -431,7 +439,7 @@ void transaction_pool::update_template(priority_iterator max_pool_change)
         }
 
         if (purge)
-            to_remove.push_back(closure_element->first);
+            to_remove.push_back(entry->second);
     }
 
     auto pool_point = max_pool_change;
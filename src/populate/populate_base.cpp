@@ -20,8 +20,12 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -59,6 +63,15 @@ void populate_base::populate_pooled(const chain::transaction& tx,
 {
     size_t height;
     size_t position;
+    uint32_t pooled_forks;
+
+    // Transactions pooled since startup are indexed, avoiding a store read.
+    if (fast_chain_.get_pooled_forks(pooled_forks, tx.hash()))
+    {
+        tx.validation.pooled = true;
+        tx.validation.current = (pooled_forks == forks);
+        return;
+    }
 
     if (fast_chain_.get_transaction_position(height, position, tx.hash(),
         false) && (position == transaction_database::unconfirmed))
@@ -96,6 +109,57 @@ void populate_base::populate_prevout(size_t branch_height,
         require_confirmed))
         return;
 
+    populate_spender(branch_height, outpoint);
+}
+
+// The previous transaction is read once for all outpoints of the group.
+void populate_base::populate_prevouts(size_t branch_height,
+    const outpoint_table::range& outpoints, bool require_confirmed) const
+{
+    BITCOIN_ASSERT(outpoints.first != outpoints.second);
+    std::vector<uint32_t> indexes;
+    indexes.reserve(std::distance(outpoints.first, outpoints.second));
+
+    for (auto outpoint = outpoints.first; outpoint != outpoints.second;
+        ++outpoint)
+        indexes.push_back((*outpoint)->index());
+
+    size_t height;
+    uint32_t median_time_past;
+    bool coinbase;
+    output::list outputs;
+
+    const auto found = fast_chain_.get_outputs(outputs, height,
+        median_time_past, coinbase, (*outpoints.first)->hash(), indexes,
+        branch_height, require_confirmed);
+
+    size_t position = 0;
+    for (auto outpoint = outpoints.first; outpoint != outpoints.second;
+        ++outpoint, ++position)
+    {
+        auto& prevout = (*outpoint)->validation;
+        prevout.spent = false;
+        prevout.confirmed = false;
+        prevout.cache = chain::output{};
+
+        // The output (prevout.cache) is populated only if it exists.
+        if (!found || !outputs[position].is_valid())
+            continue;
+
+        prevout.cache = outputs[position];
+        prevout.height = height;
+        prevout.median_time_past = median_time_past;
+        prevout.coinbase = coinbase;
+        populate_spender(branch_height, **outpoint);
+    }
+}
+
+// The output is populated, set its spent state in the context of the branch.
+void populate_base::populate_spender(size_t branch_height,
+    const output_point& outpoint) const
+{
+    auto& prevout = outpoint.validation;
+
     //*************************************************************************
     // CONSENSUS: The genesis block coinbase may not be spent. This is the
     // consequence of satoshi not including it in the utxo set for block
@@ -104,8 +168,8 @@ void populate_base::populate_prevout(size_t branch_height,
     if (prevout.height == 0)
         return;
 
-    // BUGBUG: Spends are not marked as spent by unconfirmed transactions.
-    // So tx pool transactions currently have no double spend limitation.
+    // Spends are not marked as spent by unconfirmed transactions. Pool double
+    // spends are instead limited by the transaction organizer spend index.
     // The output is spent only if by a spend at or below the branch height.
     const auto spend_height = prevout.cache.validation.spender_height;
 
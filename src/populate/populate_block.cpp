@@ -21,9 +21,13 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/outpoint_table.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -78,13 +82,20 @@ void populate_block::populate(branch::const_ptr branch,
         return;
     }
 
-    const auto buckets = std::min(dispatch_.size(), non_coinbase_inputs);
+    // Outpoints are grouped by previous transaction, so each is read once.
+    // The branch spends are searched by each input of the block.
+    const auto outpoints = std::make_shared<const outpoint_table>(*block);
+    const auto spends = std::make_shared<const outpoint_table>(
+        branch->spends());
+    BITCOIN_ASSERT_MSG(!outpoints->is_double_spend(), "unchecked block");
+
+    const auto buckets = std::min(dispatch_.size(), outpoints->groups());
     const auto join_handler = synchronize(std::move(handler), buckets, NAME);
     BITCOIN_ASSERT(buckets != 0);
 
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         dispatch_.concurrent(&populate_block::populate_transactions,
-            this, branch, bucket, buckets, join_handler);
+            this, branch, outpoints, spends, bucket, buckets, join_handler);
 }
 
 // Initialize the coinbase input for subsequent validation.
@@ -134,13 +145,14 @@ void populate_block::populate_coinbase(branch::const_ptr branch,
 ////}
 
 void populate_block::populate_transactions(branch::const_ptr branch,
-    size_t bucket, size_t buckets, result_handler handler) const
+    table_ptr outpoints, table_ptr spends, size_t bucket, size_t buckets,
+    result_handler handler) const
 {
     BITCOIN_ASSERT(bucket < buckets);
+    BCB_TRACE_BEGIN(trace_start);
     const auto block = branch->top();
     const auto branch_height = branch->height();
     const auto& txs = block->transactions();
-    size_t input_position = 0;
 
     const auto state = block->validation.state;
     const auto forks = state->enabled_forks();
@@ -157,11 +169,11 @@ void populate_block::populate_transactions(branch::const_ptr branch,
 
         //---------------------------------------------------------------------
         // Pool discovery prevents output validation and full tx deposit.
-        // The tradeoff is a read per tx that may not be cached. This is
-        // bypassed by checkpoints. This will be optimized using the tx pool.
-        // Until that time this is a material population performance hit.
-        // However the hit is necessary in preventing store tx duplication
-        // unless stale, as tx relay is disabled and duplication unlikely.
+        // Transactions pooled since startup are found in the pooled index,
+        // so the store is read only for others (not pooled or pooled before
+        // startup). This is bypassed by checkpoints. The read is necessary
+        // in preventing store tx duplication unless stale, as tx relay is
+        // disabled and duplication unlikely.
         //---------------------------------------------------------------------
         if (!stale)
         {
@@ -179,32 +191,34 @@ void populate_block::populate_transactions(branch::const_ptr branch,
         }
     }
 
-    // Must skip coinbase here as it is already accounted for.
-    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx)
+    // The outpoint table excludes the coinbase (already accounted for).
+    // Groups are bucketed, so each previous transaction is read only once.
+    for (auto group = bucket; group < outpoints->groups();
+        group = ceiling_add(group, buckets))
     {
-        const auto& inputs = tx->inputs();
-
-        for (size_t input_index = 0; input_index < inputs.size();
-            ++input_index, ++input_position)
-        {
-            if (input_position % buckets != bucket)
-                continue;
-
-            const auto& input = inputs[input_index];
-            const auto& prevout = input.previous_output();
-            populate_base::populate_prevout(branch_height, prevout, true);
-            populate_prevout(branch, prevout);
-        }
+        const auto range = outpoints->group(group);
+
+        // A lone outpoint is read through the store's unspent output cache.
+        if (std::next(range.first) == range.second)
+            populate_base::populate_prevout(branch_height, **range.first,
+                true);
+        else
+            populate_base::populate_prevouts(branch_height, range, true);
+
+        for (auto outpoint = range.first; outpoint != range.second;
+            ++outpoint)
+            populate_prevout(branch, *spends, **outpoint);
     }
 
+    BCB_TRACE_END(trace_start, "populate", *block);
     handler(error::success);
 }
 
 void populate_block::populate_prevout(branch::const_ptr branch,
-    const output_point& outpoint) const
+    const outpoint_table& spends, const output_point& outpoint) const
 {
     if (!outpoint.validation.spent)
-        branch->populate_spent(outpoint);
+        branch->populate_spent(spends, outpoint);
 
     // Populate the previous output even if it is spent.
     if (!outpoint.validation.cache.is_valid())
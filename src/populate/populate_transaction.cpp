@@ -96,6 +96,45 @@ void populate_transaction::populate(transaction_const_ptr tx,
             this, tx, chain_height, bucket, buckets, join_handler);
 }
 
+bool populate_transaction::repopulate(transaction_const_ptr tx) const
+{
+    const auto prior = tx->validation.state;
+    const auto state = fast_chain_.chain_state();
+
+    if (!prior || !state)
+        return false;
+
+    // Script validation depends on forks, so a fork change is disqualifying.
+    if (state->enabled_forks() != prior->enabled_forks())
+        return false;
+
+    tx->validation.state = state;
+    const auto chain_height = state->height() - 1u;
+
+    populate_base::populate_duplicate(chain_height, *tx, false);
+
+    if (tx->validation.duplicate)
+        return false;
+
+    // This is serial as it is expected to execute rarely and within the
+    // critical section, where the dispatcher may not be available to us.
+    for (const auto& input: tx->inputs())
+    {
+        const auto& outpoint = input.previous_output();
+        const auto prior_prevout = outpoint.validation;
+        populate_prevout(chain_height, outpoint, false);
+        const auto& prevout = outpoint.validation;
+
+        // Verified scripts (and fee) are a function of the previous output.
+        if (prevout.spent != prior_prevout.spent ||
+            prevout.coinbase != prior_prevout.coinbase ||
+            !(prevout.cache == prior_prevout.cache))
+            return false;
+    }
+
+    return true;
+}
+
 void populate_transaction::populate_inputs(transaction_const_ptr tx,
     size_t chain_height, size_t bucket, size_t buckets,
     result_handler handler) const
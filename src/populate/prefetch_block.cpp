@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/populate/prefetch_block.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+#define NAME "prefetch_block"
+
+// Database access is limited to:
+// transaction: { output } (advisory, unconfirmed)
+
+prefetch_block::prefetch_block(dispatcher& dispatch, const fast_chain& chain,
+    const settings& settings)
+  : enabled_(settings.prefetch_prevouts),
+    checkpoint_height_(checkpoint_height(settings)),
+    stopped_(true),
+    dispatch_(dispatch),
+    fast_chain_(chain)
+{
+}
+
+// Start/stop sequences.
+//-----------------------------------------------------------------------------
+
+void prefetch_block::start()
+{
+    stopped_ = false;
+}
+
+void prefetch_block::stop()
+{
+    stopped_ = true;
+}
+
+bool prefetch_block::stopped() const
+{
+    return stopped_;
+}
+
+// Prefetch sequence.
+//-----------------------------------------------------------------------------
+
+// Blocks under checkpoint are not populated, so are not prefetched.
+void prefetch_block::prefetch(block_const_ptr block, size_t height) const
+{
+    if (!enabled_ || stopped() || height <= checkpoint_height_)
+        return;
+
+    const auto inputs = block->total_non_coinbase_inputs();
+    const auto buckets = std::min(dispatch_.size(), inputs);
+
+    // Reads are I/O bound, so each thread of the pool issues its own.
+    for (size_t bucket = 0; bucket < buckets; ++bucket)
+        dispatch_.concurrent(&prefetch_block::prefetch_inputs,
+            this, block, bucket, buckets);
+}
+
+// Inputs are bucketed as in population, but are read last to first.
+void prefetch_block::prefetch_inputs(block_const_ptr block, size_t bucket,
+    size_t buckets) const
+{
+    BITCOIN_ASSERT(bucket < buckets);
+    BCB_TRACE_BEGIN(trace_start);
+    const auto& txs = block->transactions();
+    size_t input_position = 0;
+
+    // Must skip coinbase here as it has no prevout.
+    for (auto tx = txs.rbegin(); tx + 1 < txs.rend() && !stopped(); ++tx)
+    {
+        const auto& inputs = tx->inputs();
+
+        for (auto input = inputs.rbegin(); input != inputs.rend();
+            ++input, ++input_position)
+        {
+            if (input_position % buckets == bucket)
+                fast_chain_.prefetch_output(input->previous_output());
+        }
+    }
+
+    BCB_TRACE_END(trace_start, "prefetch", *block);
+}
+
+// private
+size_t prefetch_block::checkpoint_height(const settings& settings)
+{
+    size_t height = 0;
+
+    for (const auto& checkpoint: settings.checkpoints)
+        height = std::max(height, checkpoint.height());
+
+    return height;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -26,12 +26,37 @@ namespace blockchain {
 settings::settings()
   : cores(0),
     priority(true),
+    populate_threads(0),
+    verify_threads(0),
+    query_threads(0),
+    populate_processors(),
+    verify_processors(),
+    query_processors(),
+    prefetch_prevouts(false),
     use_libconsensus(false),
     byte_fee_satoshis(1),
     sigop_fee_satoshis(100),
     minimum_output_satoshis(500),
     notify_limit_hours(24),
+    notification_batch_milliseconds(5),
+    statistics_interval_seconds(0),
+    store_accounting(false),
+    trace_slow_block_milliseconds(0),
+    trace_directory("trace"),
+    validation_fairness_limit(16),
     reorganization_limit(256),
+    prune_depth(0),
+    block_pool_bytes_limit(0),
+    block_pool_file(),
+    orphan_transaction_limit(100),
+    orphan_transaction_bytes_limit(5000000),
+    orphan_block_limit(50),
+    orphan_block_bytes_limit(100000000),
+    transaction_metrics_limit(100000),
+    pooled_transaction_limit(100000),
+    utxo_commitment_rebuild(false),
+    assume_valid(null_hash, 0),
+    minimum_chain_work(null_hash),
     allow_collisions(true),
     easy_blocks(false),
     retarget(true),
@@ -25,6 +25,7 @@
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/tracer.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/validate/validate_input.hpp>
@@ -43,16 +44,22 @@ using namespace std::placeholders;
 // block: { bits, version, timestamp }
 // transaction: { exists, height, output }
 
-// If the priority threadpool is shut down when this is running the handlers
-// will never be invoked, resulting in a threadpool.join indefinite hang.
+// Population (store bound) and verification (processor bound) are dispatched
+// to distinct threadpools. If either threadpool is shut down when this is
+// running the handlers will never be invoked, resulting in a threadpool.join
+// indefinite hang.
 
-validate_block::validate_block(dispatcher& dispatch, const fast_chain& chain,
-    const settings& settings)
+validate_block::validate_block(dispatcher& populate_dispatch,
+    dispatcher& verify_dispatch, const fast_chain& chain,
+    const header_index& headers, const settings& settings)
   : stopped_(true),
     use_libconsensus_(settings.use_libconsensus),
+    assume_valid_(settings.assume_valid),
+    minimum_chain_work_(to_uint256(settings.minimum_chain_work)),
     fast_chain_(chain),
-    priority_dispatch_(dispatch),
-    block_populator_(dispatch, chain)
+    headers_(headers),
+    verify_dispatch_(verify_dispatch),
+    block_populator_(populate_dispatch, chain)
 {
 }
 
@@ -88,7 +95,7 @@ void validate_block::check(block_const_ptr block, result_handler handler) const
 ////
 ////    // TODO: make configurable for each parallel segment.
 ////    // This one is more efficient with one thread than parallel.
-////    const auto threads = std::min(size_t(1), priority_dispatch_.size());
+////    const auto threads = std::min(size_t(1), verify_dispatch_.size());
 ////
 ////    const auto count = block->transactions().size();
 ////    const auto buckets = std::min(threads, count);
@@ -98,7 +105,7 @@ void validate_block::check(block_const_ptr block, result_handler handler) const
 ////        NAME "_check");
 ////
 ////    for (size_t bucket = 0; bucket < buckets; ++bucket)
-////        priority_dispatch_.concurrent(&validate_block::check_block,
+////        verify_dispatch_.concurrent(&validate_block::check_block,
 ////            this, block, bucket, buckets, join_handler);
 ////}
 ////
@@ -191,14 +198,14 @@ void validate_block::handle_populated(const code& ec, block_const_ptr block,
 
     const auto count = block->transactions().size();
     const auto bip16 = state->is_enabled(rule_fork::bip16_rule);
-    const auto buckets = std::min(priority_dispatch_.size(), count);
+    const auto buckets = std::min(verify_dispatch_.size(), count);
     BITCOIN_ASSERT(buckets != 0);
 
     const auto join_handler = synchronize(std::move(complete_handler), buckets,
         NAME "_accept");
 
     for (size_t bucket = 0; bucket < buckets; ++bucket)
-        priority_dispatch_.concurrent(&validate_block::accept_transactions,
+        verify_dispatch_.concurrent(&validate_block::accept_transactions,
             this, block, bucket, buckets, sigops, bip16, bip141, join_handler);
 }
 
@@ -212,6 +219,7 @@ void validate_block::accept_transactions(block_const_ptr block, size_t bucket,
         return;
     }
 
+    BCB_TRACE_BEGIN(trace_start);
     code ec(error::success);
     const auto& state = *block->validation.state;
     const auto& txs = block->transactions();
@@ -222,12 +230,26 @@ void validate_block::accept_transactions(block_const_ptr block, size_t bucket,
     {
         const auto& transaction = txs[tx];
         ec = transaction.accept(state, false);
-        *sigops += transaction.signature_operations(bip16, bip141);
+        *sigops += signature_operations(transaction, bip16, bip141);
     }
 
+    BCB_TRACE_END(trace_start, "accept", *block);
     handler(ec);
 }
 
+// Pool transactions carry sigops computed upon their acceptance to the pool.
+// Witness sigops differ across malleated witnesses of the same txid, so the
+// cached count is used only for the identical (witness hash) transaction.
+size_t validate_block::signature_operations(const transaction& tx, bool bip16,
+    bool bip141) const
+{
+    const auto metrics = fast_chain_.get_transaction_metrics(tx.hash());
+
+    return metrics && metrics->is_sigops(bip16, bip141) &&
+        metrics->witness_hash() == tx.hash(true) ? metrics->sigops() :
+            tx.signature_operations(bip16, bip141);
+}
+
 void validate_block::handle_accepted(const code& ec, block_const_ptr block,
     atomic_counter_ptr sigops, bool bip141, result_handler handler) const
 {
@@ -255,7 +277,9 @@ void validate_block::connect(branch::const_ptr branch,
     // We are reimplementing connect, so must set timer externally.
     block->validation.start_connect = asio::steady_clock::now();
 
-    if (block->validation.state->is_under_checkpoint())
+    // Population and accept are complete, only script validation is skipped.
+    if (block->validation.state->is_under_checkpoint() ||
+        is_assumed_valid(branch))
     {
         handler(error::success);
         return;
@@ -278,7 +302,7 @@ void validate_block::connect(branch::const_ptr branch,
         std::bind(&validate_block::handle_connected,
             this, _1, block, handler);
 
-    const auto threads = priority_dispatch_.size();
+    const auto threads = verify_dispatch_.size();
     const auto buckets = std::min(threads, non_coinbase_inputs);
     BITCOIN_ASSERT(buckets != 0);
 
@@ -286,14 +310,43 @@ void validate_block::connect(branch::const_ptr branch,
         NAME "_validate");
 
     for (size_t bucket = 0; bucket < buckets; ++bucket)
-        priority_dispatch_.concurrent(&validate_block::connect_inputs,
+        verify_dispatch_.concurrent(&validate_block::connect_inputs,
             this, block, bucket, buckets, join_handler);
 }
 
+// Script validation of each block depends only on its populated prevouts, so
+// the blocks of a connected run are validated at once across the pool. The
+// hit rate statistics are shared and so are approximate in this mode.
+void validate_block::connect(const branch::const_ptr_list& branches,
+    result_handler handler) const
+{
+    if (branches.empty())
+    {
+        handler(error::success);
+        return;
+    }
+
+    const auto join_handler = synchronize(std::move(handler), branches.size(),
+        NAME "_connect");
+
+    for (const auto& branch: branches)
+    {
+        const auto block = branch->top();
+
+        // The error is attributed to its block, so the join never fails.
+        connect(branch, [block, join_handler](const code& ec)
+        {
+            block->validation.error = ec;
+            join_handler(error::success);
+        });
+    }
+}
+
 void validate_block::connect_inputs(block_const_ptr block, size_t bucket,
     size_t buckets, result_handler handler) const
 {
     BITCOIN_ASSERT(bucket < buckets);
+    BCB_TRACE_BEGIN(trace_start);
     code ec(error::success);
     const auto forks = block->validation.state->enabled_forks();
     const auto& txs = block->transactions();
@@ -349,6 +402,7 @@ void validate_block::connect_inputs(block_const_ptr block, size_t bucket,
         }
     }
 
+    BCB_TRACE_END(trace_start, "connect", *block);
     handler(ec);
 }
 
@@ -359,6 +413,21 @@ float validate_block::hit_rate() const
     return queries_ == 0 ? 0.0f : (hits_ * 1.0f / queries_);
 }
 
+// Scripts are bypassed only for an ancestor of the assumed valid block, as
+// proven by the header index, and only once the indexed header chain has the
+// configured minimum work. The header index is linked, proof of work checked
+// and checkpoint anchored, and it is not affected by block reorganization.
+// Any other block is fully validated, the assumed valid block never causes a
+// block to be rejected.
+bool validate_block::is_assumed_valid(branch::const_ptr branch) const
+{
+    return assume_valid_.hash() != null_hash &&
+        branch->top_height() <= assume_valid_.height() &&
+        headers_.is_indexed(assume_valid_.hash(), assume_valid_.height()) &&
+        headers_.is_indexed(branch->top()->hash(), branch->top_height()) &&
+        headers_.work() >= minimum_chain_work_;
+}
+
 void validate_block::handle_connected(const code& ec, block_const_ptr block,
     result_handler handler) const
 {
@@ -42,13 +42,14 @@ using namespace std::placeholders;
 // spend: { spender }
 // transaction: { exists, height, output }
 
-validate_transaction::validate_transaction(dispatcher& dispatch,
-    const fast_chain& chain, const settings& settings)
+validate_transaction::validate_transaction(dispatcher& populate_dispatch,
+    dispatcher& verify_dispatch, const fast_chain& chain,
+    const settings& settings)
   : stopped_(true),
     retarget_(settings.retarget),
     use_libconsensus_(settings.use_libconsensus),
-    dispatch_(dispatch),
-    transaction_populator_(dispatch, chain),
+    verify_dispatch_(verify_dispatch),
+    transaction_populator_(populate_dispatch, chain),
     fast_chain_(chain)
 {
 }
@@ -108,6 +109,20 @@ void validate_transaction::handle_populated(const code& ec,
     handler(tx->accept());
 }
 
+// Currency.
+//-----------------------------------------------------------------------------
+// Validation is performed against a pool state snapshot. A new pool state is
+// published on each reorganization, so pointer equality implies no change.
+
+bool validate_transaction::is_current(transaction_const_ptr tx) const
+{
+    if (tx->validation.state == fast_chain_.chain_state())
+        return true;
+
+    // Forks and prevouts are unchanged, so only contextual checks may differ.
+    return transaction_populator_.repopulate(tx) && !tx->accept();
+}
+
 // Connect sequence.
 //-----------------------------------------------------------------------------
 // These checks require chain state, block state and perform script validation.
@@ -125,14 +140,14 @@ void validate_transaction::connect(transaction_const_ptr tx,
         return;
     }
 
-    const auto buckets = std::min(dispatch_.size(), total_inputs);
+    const auto buckets = std::min(verify_dispatch_.size(), total_inputs);
     const auto join_handler = synchronize(handler, buckets, NAME "_validate");
     BITCOIN_ASSERT(buckets != 0);
 
     // If the priority threadpool is shut down when this is called the handler
     // will never be invoked, resulting in a threadpool.join indefinite hang.
     for (size_t bucket = 0; bucket < buckets; ++bucket)
-        dispatch_.concurrent(&validate_transaction::connect_inputs,
+        verify_dispatch_.concurrent(&validate_transaction::connect_inputs,
             this, tx, bucket, buckets, join_handler);
 }
 
@@ -537,6 +537,40 @@ BOOST_AUTO_TEST_CASE(block_chain__fetch_block1__not_exists__error_not_found)
     BOOST_REQUIRE_EQUAL(fetch_block_by_height_result(instance, block1, 1), error::not_found);
 }
 
+BOOST_AUTO_TEST_CASE(block_chain__fetch_block1__pruned__chain_error_pruned)
+{
+    threadpool pool;
+    database::settings database_settings;
+    database_settings.directory = TEST_NAME;
+    BOOST_REQUIRE(create_database(database_settings));
+
+    blockchain::settings blockchain_settings;
+    blockchain_settings.prune_depth = 1;
+    blockchain_settings.reorganization_limit = 0;
+    block_chain instance(pool, blockchain_settings, database_settings);
+    BOOST_REQUIRE(instance.start());
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    const auto block3 = NEW_BLOCK(3);
+    BOOST_REQUIRE(instance.begin_insert());
+    BOOST_REQUIRE(instance.insert(block1, 1));
+    BOOST_REQUIRE(instance.insert(block2, 2));
+    BOOST_REQUIRE(instance.insert(block3, 3));
+    BOOST_REQUIRE(instance.end_insert());
+    BOOST_REQUIRE_EQUAL(instance.pruned_height(), 2u);
+
+    // The code is compared with its category, as its value is not distinct.
+    std::promise<code> promise;
+    const auto handler = [&promise](code ec, block_const_ptr, size_t)
+    {
+        promise.set_value(ec);
+    };
+    instance.fetch_block(1, true, handler);
+    BOOST_REQUIRE(promise.get_future().get() == chain_error::pruned);
+    BOOST_REQUIRE_EQUAL(fetch_block_by_height_result(instance, block2, 2), error::success);
+}
+
 static int fetch_block_by_hash_result(block_chain& instance,
     block_const_ptr block, size_t height)
 {
@@ -813,6 +847,87 @@ BOOST_AUTO_TEST_CASE(block_chain__fetch_locator_block_headers__limited__sequenti
     BOOST_REQUIRE_EQUAL(fetch_locator_block_headers(instance, locator, null_hash, 2), error::success);
 }
 
+// reorganize
+
+static chain::transaction make_coinbase(uint32_t id)
+{
+    const chain::point null_point{ null_hash, chain::point::null_index };
+    return chain::transaction{ 1, 0, { { null_point, {}, id } },
+        { { 50, {} } } };
+}
+
+static chain::transaction make_spend(const chain::output_point& prevout)
+{
+    return chain::transaction{ 1, 0, { { prevout, {}, 0 } }, { { 50, {} } } };
+}
+
+static block_const_ptr make_block(uint32_t id, const hash_digest& parent,
+    size_t height, chain::transaction::list&& txs,
+    chain::chain_state::ptr state)
+{
+    const auto block = std::make_shared<message::block>(
+        chain::header{ 1, parent, null_hash, 0, 0, id }, std::move(txs));
+
+    block->header().validation.height = height;
+    block->validation.state = state;
+    return block;
+}
+
+static code reorganize(block_chain& instance, dispatcher& dispatch,
+    const config::checkpoint& fork_point, block_const_ptr_list&& incoming)
+{
+    std::promise<code> promise;
+    const auto handler = [&promise](const code& ec)
+    {
+        promise.set_value(ec);
+    };
+
+    instance.reorganize(fork_point,
+        std::make_shared<const block_const_ptr_list>(std::move(incoming)),
+        std::make_shared<block_const_ptr_list>(), dispatch, handler);
+    return promise.get_future().get();
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__reorganize__outgoing_dependent_spend__expected_commitment)
+{
+    START_BLOCKCHAIN(instance, false);
+    dispatcher dispatch(pool, TEST_NAME);
+    const auto state = instance.chain_state();
+    const auto genesis = chain::block::genesis_mainnet().hash();
+
+    const auto coinbase1 = make_coinbase(1);
+    const chain::output_point prevout1{ coinbase1.hash(), 0 };
+    const auto spend = make_spend(prevout1);
+    const auto dependent = make_spend({ spend.hash(), 0 });
+    const auto block1 = make_block(1, genesis, 1, { coinbase1 }, state);
+    const auto block2 = make_block(2, block1->hash(), 2,
+        { make_coinbase(2), spend, dependent }, state);
+
+    BOOST_REQUIRE_EQUAL(reorganize(instance, dispatch, { genesis, 0 },
+        { block1, block2 }), error::success);
+
+    hash_digest commitment;
+    size_t height;
+    BOOST_REQUIRE(instance.get_utxo_commitment(commitment, height));
+    BOOST_REQUIRE_EQUAL(height, 2u);
+
+    // The prevout of the dependent spend is created in the outgoing block.
+    const auto coinbase3 = make_coinbase(3);
+    const auto block3 = make_block(3, block1->hash(), 2, { coinbase3 },
+        state);
+
+    BOOST_REQUIRE_EQUAL(reorganize(instance, dispatch,
+        { block1->hash(), 1 }, { block3 }), error::success);
+
+    utxo_commitment expected;
+    expected.add(prevout1, coinbase1.outputs()[0]);
+    expected.add({ coinbase3.hash(), 0 }, coinbase3.outputs()[0]);
+
+    BOOST_REQUIRE(instance.get_utxo_commitment(commitment, height));
+    BOOST_REQUIRE_EQUAL(height, 2u);
+    BOOST_REQUIRE(commitment == expected.value());
+}
+
 // TODO: fetch_template
 // TODO: fetch_mempool
 // TODO: filter_blocks
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(block_orphan_pool_tests)
+
+static const auto parent1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+static const auto parent2 = hash_literal("0000000000000000000000000000000000000000000000000000000000000002");
+
+static block_const_ptr make_block(uint32_t id, const hash_digest& parent)
+{
+    return std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, parent, null_hash, 0, 0, 0 }, {}
+    });
+}
+
+static size_t block_size()
+{
+    return make_block(0, null_hash)->chain::block::serialized_size(true);
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__add__zero_count__false)
+{
+    block_orphan_pool instance(0, 1000);
+    BOOST_REQUIRE(!instance.add(make_block(1, parent1)));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__add__exceeds_bytes__false)
+{
+    block_orphan_pool instance(10, block_size() - 1u);
+    BOOST_REQUIRE(!instance.add(make_block(1, parent1)));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__add__twice__single)
+{
+    block_orphan_pool instance(10, 1000);
+    const auto block = make_block(1, parent1);
+    BOOST_REQUIRE(instance.add(block));
+    BOOST_REQUIRE(!instance.add(block));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), block_size());
+}
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__add__over_count__oldest_evicted)
+{
+    block_orphan_pool instance(2, 1000);
+    BOOST_REQUIRE(instance.add(make_block(1, parent1)));
+    BOOST_REQUIRE(instance.add(make_block(2, parent1)));
+    BOOST_REQUIRE(instance.add(make_block(3, parent2)));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    const auto children = instance.remove(parent1);
+    BOOST_REQUIRE_EQUAL(children.size(), 1u);
+    BOOST_REQUIRE_EQUAL(children.front()->header().version(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__add__over_bytes__oldest_evicted)
+{
+    block_orphan_pool instance(10, 2u * block_size());
+    BOOST_REQUIRE(instance.add(make_block(1, parent1)));
+    BOOST_REQUIRE(instance.add(make_block(2, parent1)));
+    BOOST_REQUIRE(instance.add(make_block(3, parent1)));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), 2u * block_size());
+}
+
+// remove
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__remove__unknown_parent__empty)
+{
+    block_orphan_pool instance(10, 1000);
+    BOOST_REQUIRE(instance.add(make_block(1, parent1)));
+    BOOST_REQUIRE(instance.remove(parent2).empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__remove__siblings__all_released)
+{
+    block_orphan_pool instance(10, 1000);
+    BOOST_REQUIRE(instance.add(make_block(1, parent1)));
+    BOOST_REQUIRE(instance.add(make_block(2, parent1)));
+    BOOST_REQUIRE(instance.add(make_block(3, parent2)));
+
+    const auto children = instance.remove(parent1);
+    BOOST_REQUIRE_EQUAL(children.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), block_size());
+    BOOST_REQUIRE(instance.remove(parent1).empty());
+}
+
+// filter
+
+BOOST_AUTO_TEST_CASE(block_orphan_pool__filter__buffered__removed)
+{
+    block_orphan_pool instance(10, 1000);
+    const auto block1 = make_block(1, parent1);
+    const auto block2 = make_block(2, parent1);
+    BOOST_REQUIRE(instance.add(block1));
+
+    message::get_data data
+    {
+        { message::inventory::type_id::block, block1->hash() },
+        { message::inventory::type_id::block, block2->hash() }
+    };
+    const auto message = std::make_shared<message::get_data>(std::move(data));
+
+    instance.filter(message);
+    BOOST_REQUIRE_EQUAL(message->inventories().size(), 1u);
+    BOOST_REQUIRE(message->inventories().front().hash() == block2->hash());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
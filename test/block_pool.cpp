@@ -36,6 +36,12 @@ public:
     {
     }
 
+    block_pool_fixture(size_t maximum_depth, size_t maximum_bytes,
+        const boost::filesystem::path& scratch_file)
+      : block_pool(maximum_depth, maximum_bytes, scratch_file)
+    {
+    }
+
     void prune(size_t top_height)
     {
         block_pool::prune(top_height);
@@ -56,10 +62,20 @@ public:
         return maximum_depth_;
     }
 
-    block_entries& blocks()
+    block_forest& blocks()
     {
         return blocks_;
     }
+
+    size_t scratch_end() const
+    {
+        return scratch_end_;
+    }
+
+    void lose_spilled(const hash_digest& hash)
+    {
+        extents_.erase(hash);
+    }
 };
 
 block_const_ptr make_block(uint32_t id, size_t height,
@@ -74,6 +90,27 @@ block_const_ptr make_block(uint32_t id, size_t height,
     return block;
 }
 
+// Spillable blocks require a (coinbase) transaction.
+block_const_ptr make_full_block(uint32_t id, size_t height,
+    block_const_ptr parent)
+{
+    const chain::transaction coinbase
+    {
+        1, 0, { { chain::point{ null_hash, chain::point::null_index }, {}, id } },
+        { { 50, {} } }
+    };
+
+    const auto block = std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, parent ? parent->hash() : null_hash, null_hash, 0,
+            0, 0 },
+        { coinbase }
+    });
+
+    block->header().validation.height = height;
+    return block;
+}
+
 block_const_ptr make_block(uint32_t id, size_t height, block_const_ptr parent)
 {
     return make_block(id, height, parent->hash());
@@ -111,10 +148,10 @@ BOOST_AUTO_TEST_CASE(block_pool__add1__one__single)
     instance.add(block1);
     BOOST_REQUIRE_EQUAL(instance.size(), 1u);
 
-    const auto entry = instance.blocks().right.find(height);
-    BOOST_REQUIRE(entry != instance.blocks().right.end());
-    BOOST_REQUIRE(entry->second.block() == block1);
-    BOOST_REQUIRE_EQUAL(entry->first, height);
+    const auto entry = instance.blocks().root(height);
+    BOOST_REQUIRE(entry);
+    BOOST_REQUIRE(entry == block1);
+    BOOST_REQUIRE_EQUAL(instance.blocks().roots(), 1u);
 }
 
 BOOST_AUTO_TEST_CASE(block_pool__add1__twice__single)
@@ -141,9 +178,9 @@ BOOST_AUTO_TEST_CASE(block_pool__add1__two_different_blocks_with_same_hash__firs
     instance.add(block1b);
     BOOST_REQUIRE_EQUAL(instance.size(), 1u);
 
-    const auto entry = instance.blocks().right.find(height1a);
-    BOOST_REQUIRE(entry != instance.blocks().right.end());
-    BOOST_REQUIRE(entry->second.block() == block1a);
+    const auto entry = instance.blocks().root(height1a);
+    BOOST_REQUIRE(entry);
+    BOOST_REQUIRE(entry == block1a);
 }
 
 BOOST_AUTO_TEST_CASE(block_pool__add1__two_distinct_hash__two)
@@ -161,13 +198,13 @@ BOOST_AUTO_TEST_CASE(block_pool__add1__two_distinct_hash__two)
     instance.add(block2);
     BOOST_REQUIRE_EQUAL(instance.size(), 2u);
 
-    const auto& entry1 = instance.blocks().right.find(height1);
-    BOOST_REQUIRE(entry1 != instance.blocks().right.end());
-    BOOST_REQUIRE(entry1->second.block() == block1);
+    const auto entry1 = instance.blocks().root(height1);
+    BOOST_REQUIRE(entry1);
+    BOOST_REQUIRE(entry1 == block1);
 
-    const auto& entry2 = instance.blocks().right.find(height2);
-    BOOST_REQUIRE(entry2 != instance.blocks().right.end());
-    BOOST_REQUIRE(entry2->second.block() == block2);
+    const auto entry2 = instance.blocks().root(height2);
+    BOOST_REQUIRE(entry2);
+    BOOST_REQUIRE(entry2 == block2);
 }
 
 // add2
@@ -192,13 +229,13 @@ BOOST_AUTO_TEST_CASE(block_pool__add2__distinct__expected)
     instance.add(std::make_shared<const block_const_ptr_list>(std::move(blocks)));
     BOOST_REQUIRE_EQUAL(instance.size(), 2u);
 
-    const auto entry1 = instance.blocks().right.find(42);
-    BOOST_REQUIRE(entry1 != instance.blocks().right.end());
-    BOOST_REQUIRE(entry1->second.block() == block1);
+    const auto entry1 = instance.blocks().root(42);
+    BOOST_REQUIRE(entry1);
+    BOOST_REQUIRE(entry1 == block1);
 
-    const auto& entry2 = instance.blocks().right.find(43);
-    BOOST_REQUIRE(entry2 != instance.blocks().right.end());
-    BOOST_REQUIRE(entry2->second.block() == block2);
+    const auto entry2 = instance.blocks().root(43);
+    BOOST_REQUIRE(entry2);
+    BOOST_REQUIRE(entry2 == block2);
 }
 
 // remove
@@ -270,13 +307,12 @@ BOOST_AUTO_TEST_CASE(block_pool__remove__subtree__reorganized)
     BOOST_REQUIRE_EQUAL(instance.size(), 3u);
 
     // Entry3 is the new root block (non-zero height).
-    const auto entry3 = instance.blocks().right.find(44);
-    BOOST_REQUIRE(entry3 != instance.blocks().right.end());
-    BOOST_REQUIRE(entry3->second.block() == block3);
+    const auto entry3 = instance.blocks().root(44);
+    BOOST_REQUIRE(entry3);
+    BOOST_REQUIRE(entry3 == block3);
 
-    // Remaining entries are children (zero height).
-    const auto children = instance.blocks().right.find(0);
-    BOOST_REQUIRE(children != instance.blocks().right.end());
+    // Remaining entries are children (not roots).
+    BOOST_REQUIRE_EQUAL(instance.blocks().roots(), 1u);
 }
 
 // prune
@@ -400,12 +436,12 @@ BOOST_AUTO_TEST_CASE(block_pool__prune__partial_branch_expired__partial_branch_d
     BOOST_REQUIRE_EQUAL(instance.size(), 6u);
 
     // There are four blocks at height 46, make sure at least one exists.
-    const auto entry = instance.blocks().right.find(46);
-    BOOST_REQUIRE(entry != instance.blocks().right.end());
+    const auto entry = instance.blocks().root(46);
+    BOOST_REQUIRE(entry);
 
     // There are two blocks at 47 but neither is a root (not replanted).
-    const auto entry8 = instance.blocks().right.find(47);
-    BOOST_REQUIRE(entry8 == instance.blocks().right.end());
+    const auto entry8 = instance.blocks().root(47);
+    BOOST_REQUIRE(!entry8);
 }
 
 // filter
@@ -672,4 +708,138 @@ BOOST_AUTO_TEST_CASE(block_pool__get_path__connected_multiple_sub_branches__expe
     BOOST_REQUIRE((*path3->blocks())[6] == block23);
 }
 
+// spill
+
+BOOST_AUTO_TEST_CASE(block_pool__spill__no_scratch_file__not_spilled)
+{
+    block_pool_fixture instance(0, 1, {});
+    const auto block1 = make_full_block(1, 42, nullptr);
+    const auto block2 = make_full_block(2, 43, block1);
+
+    instance.add(block1);
+    instance.add(block2);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_pool__spill__over_budget__oldest_spilled)
+{
+    const boost::filesystem::path file = "block_pool__spill__over_budget";
+    const auto block1 = make_full_block(1, 42, nullptr);
+    const auto block2 = make_full_block(2, 43, block1);
+    const auto size = block2->chain::block::serialized_size(true);
+
+    {
+        block_pool_fixture instance(0, size, file);
+        instance.add(block1);
+        instance.add(block2);
+        BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+        BOOST_REQUIRE_EQUAL(instance.spilled(), 1u);
+        BOOST_REQUIRE_EQUAL(instance.bytes(), size);
+        BOOST_REQUIRE(instance.exists(block1));
+        BOOST_REQUIRE(instance.blocks().root(42)->transactions().empty());
+    }
+
+    BOOST_REQUIRE(!boost::filesystem::exists(file));
+}
+
+BOOST_AUTO_TEST_CASE(block_pool__get_path__spilled_ancestors__loaded)
+{
+    const boost::filesystem::path file = "block_pool__get_path__spilled";
+    const auto block1 = make_full_block(1, 42, nullptr);
+    const auto block2 = make_full_block(2, 43, block1);
+    const auto block3 = make_full_block(3, 44, block2);
+    const auto block4 = make_full_block(4, 45, block3);
+    const auto size = block3->chain::block::serialized_size(true);
+
+    block_pool_fixture instance(0, size, file);
+    instance.add(block1);
+    instance.add(block2);
+    instance.add(block3);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 2u);
+
+    const auto path = instance.get_path(block4);
+    BOOST_REQUIRE_EQUAL(path->size(), 4u);
+    BOOST_REQUIRE((*path->blocks())[0]->hash() == block1->hash());
+    BOOST_REQUIRE((*path->blocks())[1]->hash() == block2->hash());
+    BOOST_REQUIRE((*path->blocks())[2] == block3);
+    BOOST_REQUIRE((*path->blocks())[3] == block4);
+    BOOST_REQUIRE(*(*path->blocks())[0] == *block1);
+    BOOST_REQUIRE(*(*path->blocks())[1] == *block2);
+    BOOST_REQUIRE_EQUAL((*path->blocks())[0]->header().validation.height, 42u);
+    BOOST_REQUIRE_EQUAL((*path->blocks())[1]->header().validation.height, 43u);
+
+    // Loading does not spill, the budget is restored on the next add.
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), 3 * size);
+    instance.add(block4);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), size);
+}
+
+BOOST_AUTO_TEST_CASE(block_pool__get_path__unreadable_spilled_ancestor__null)
+{
+    const boost::filesystem::path file = "block_pool__get_path__unreadable";
+    const auto block1 = make_full_block(1, 42, nullptr);
+    const auto block2 = make_full_block(2, 43, block1);
+    const auto block3 = make_full_block(3, 44, block2);
+    const auto size = block2->chain::block::serialized_size(true);
+
+    block_pool_fixture instance(0, size, file);
+    instance.add(block1);
+    instance.add(block2);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 1u);
+
+    instance.lose_spilled(block1->hash());
+    BOOST_REQUIRE(!instance.get_path(block3));
+}
+
+BOOST_AUTO_TEST_CASE(block_pool__remove__spilled__released)
+{
+    const boost::filesystem::path file = "block_pool__remove__spilled";
+    const auto block1 = make_full_block(1, 42, nullptr);
+    const auto block2 = make_full_block(2, 43, block1);
+    const auto size = block2->chain::block::serialized_size(true);
+
+    block_pool_fixture instance(0, size, file);
+    instance.add(block1);
+    instance.add(block2);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 1u);
+
+    const auto accepted = std::make_shared<const block_const_ptr_list>(
+        block_const_ptr_list{ block1 });
+
+    instance.remove(accepted);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), size);
+    BOOST_REQUIRE_EQUAL(instance.scratch_end(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_pool__spill__released_extent__reused)
+{
+    const boost::filesystem::path file = "block_pool__spill__reused";
+    const auto block1 = make_full_block(1, 42, nullptr);
+    const auto block2 = make_full_block(2, 43, block1);
+    const auto block3 = make_full_block(3, 44, block2);
+    const auto block4 = make_full_block(4, 45, block3);
+    const auto size = block1->chain::block::serialized_size(true);
+
+    block_pool_fixture instance(0, size, file);
+    instance.add(block1);
+    instance.add(block2);
+    instance.add(block3);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.scratch_end(), 2 * size);
+
+    // The first extent is released, and reused by the next spill.
+    const auto accepted = std::make_shared<const block_const_ptr_list>(
+        block_const_ptr_list{ block1 });
+
+    instance.remove(accepted);
+    instance.add(block4);
+    BOOST_REQUIRE_EQUAL(instance.spilled(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.scratch_end(), 2 * size);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
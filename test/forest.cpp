@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(forest_tests)
+
+typedef std::shared_ptr<const size_t> element;
+typedef forest<element> test_forest;
+
+static hash_digest make_hash(uint8_t id)
+{
+    auto hash = null_hash;
+    hash.front() = id;
+    return hash;
+}
+
+static element add(test_forest& instance, uint8_t id, uint8_t parent,
+    size_t height)
+{
+    const auto value = std::make_shared<const size_t>(id);
+    instance.add(value, make_hash(id), make_hash(parent), height);
+    return value;
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(forest__add__duplicate_hash__false)
+{
+    test_forest instance;
+    add(instance, 1, 0, 42);
+    BOOST_REQUIRE(!instance.add(nullptr, make_hash(1), null_hash, 43));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(forest__add__connected__one_root)
+{
+    test_forest instance;
+    const auto root = add(instance, 1, 0, 42);
+    add(instance, 2, 1, 43);
+    add(instance, 3, 2, 44);
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+    BOOST_REQUIRE_EQUAL(instance.roots(), 1u);
+    BOOST_REQUIRE(instance.root(42) == root);
+    BOOST_REQUIRE(!instance.root(43));
+}
+
+// contains
+
+BOOST_AUTO_TEST_CASE(forest__contains__added_and_removed__expected)
+{
+    test_forest instance;
+    BOOST_REQUIRE(!instance.contains(make_hash(1)));
+    add(instance, 1, 0, 42);
+    BOOST_REQUIRE(instance.contains(make_hash(1)));
+    instance.remove({ make_hash(1) });
+    BOOST_REQUIRE(!instance.contains(make_hash(1)));
+}
+
+BOOST_AUTO_TEST_CASE(forest__contains__same_shard_removed__other_retained)
+{
+    test_forest instance;
+    auto hash1 = make_hash(7);
+    auto hash2 = make_hash(7);
+    hash1.back() = 1;
+    hash2.back() = 2;
+    instance.add(nullptr, hash1, null_hash, 42);
+    instance.add(nullptr, hash2, null_hash, 42);
+    add(instance, 8, 0, 42);
+    instance.remove({ hash1 });
+    BOOST_REQUIRE(!instance.contains(hash1));
+    BOOST_REQUIRE(instance.contains(hash2));
+    BOOST_REQUIRE(instance.contains(make_hash(8)));
+}
+
+// remove
+
+BOOST_AUTO_TEST_CASE(forest__remove__root__children_replanted)
+{
+    test_forest instance;
+    add(instance, 1, 0, 42);
+    add(instance, 2, 1, 43);
+    add(instance, 3, 1, 43);
+    instance.remove({ make_hash(1) });
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.roots(), 2u);
+    BOOST_REQUIRE(instance.root(43));
+}
+
+// prune
+
+BOOST_AUTO_TEST_CASE(forest__prune__below_minimum__expired_removed)
+{
+    test_forest instance;
+    add(instance, 1, 0, 42);
+    add(instance, 2, 1, 43);
+    const auto current = add(instance, 3, 2, 44);
+    add(instance, 4, 3, 45);
+    add(instance, 5, 0, 50);
+
+    instance.prune(44);
+    BOOST_REQUIRE_EQUAL(instance.size(), 3u);
+    BOOST_REQUIRE_EQUAL(instance.roots(), 2u);
+    BOOST_REQUIRE(instance.root(44) == current);
+    BOOST_REQUIRE(!instance.contains(make_hash(1)));
+    BOOST_REQUIRE(!instance.contains(make_hash(2)));
+}
+
+BOOST_AUTO_TEST_CASE(forest__prune__all_current__unchanged)
+{
+    test_forest instance;
+    add(instance, 1, 0, 42);
+    add(instance, 2, 1, 43);
+    instance.prune(42);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+}
+
+// ancestors
+
+BOOST_AUTO_TEST_CASE(forest__ancestors__exists__false)
+{
+    test_forest instance;
+    add(instance, 1, 0, 42);
+    test_forest::elements ancestors;
+    BOOST_REQUIRE(!instance.ancestors(ancestors, make_hash(1), null_hash));
+}
+
+BOOST_AUTO_TEST_CASE(forest__ancestors__connected__nearest_first)
+{
+    test_forest instance;
+    const auto element1 = add(instance, 1, 0, 42);
+    const auto element2 = add(instance, 2, 1, 43);
+    test_forest::elements ancestors;
+    BOOST_REQUIRE(instance.ancestors(ancestors, make_hash(3), make_hash(2)));
+    BOOST_REQUIRE_EQUAL(ancestors.size(), 2u);
+    BOOST_REQUIRE(ancestors[0] == element2);
+    BOOST_REQUIRE(ancestors[1] == element1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
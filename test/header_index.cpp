@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(header_index_tests)
+
+// Mainnet headers one and two.
+static const std::string header1_hex = "010000006fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000982051fd1e4ba744bbbe680e1fee14677ba1a3c3540bf7b1cdb606e857233e0e61bc6649ffff001d01e36299";
+static const std::string header2_hex = "010000004860eb18bf1b1620e37e9490fc8a427514416fd75159ab86688e9a8300000000d5fdcc541e25de1c7a5addedf24858b8bb665c9f36ef744ee42c316022c90f9bb0bc6649ffff001d08d2bd61";
+
+static chain::header read_header(const std::string& hex)
+{
+    data_chunk data;
+    BOOST_REQUIRE(decode_base16(data, hex));
+    chain::header result;
+    BOOST_REQUIRE(result.from_data(data));
+    return result;
+}
+
+static settings mainnet_settings()
+{
+    settings result;
+    result.retarget = true;
+    result.easy_blocks = false;
+    return result;
+}
+
+// Access to protected members.
+class header_index_fixture
+  : public header_index
+{
+public:
+    header_index_fixture(const settings& settings)
+      : header_index(settings)
+    {
+    }
+
+    // Link without validation, for testing of branch selection.
+    bool link(const hash_digest& hash, const hash_digest& parent,
+        uint32_t bits)
+    {
+        size_t fork;
+        entries branch;
+        uint256_t work;
+
+        if (!trace(fork, branch, work, parent))
+            return false;
+
+        work += chain::block::proof(bits);
+        header_index::link({ hash, bits, 1, 0 }, parent, fork, branch, work);
+        return true;
+    }
+
+    size_t side_size() const
+    {
+        return side_.size();
+    }
+};
+
+static hash_digest make_hash(uint8_t id)
+{
+    auto hash = null_hash;
+    hash[0] = id;
+    return hash;
+}
+
+BOOST_AUTO_TEST_CASE(header_index__start__genesis__indexed_at_zero)
+{
+    header_index instance(mainnet_settings());
+    const auto genesis = chain::block::genesis_mainnet().header();
+    instance.start(genesis);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 0u);
+    BOOST_REQUIRE(instance.is_indexed(genesis.hash(), 0));
+    BOOST_REQUIRE(instance.work() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__add__linked__indexed)
+{
+    header_index instance(mainnet_settings());
+    instance.start(chain::block::genesis_mainnet().header());
+    const auto header1 = read_header(header1_hex);
+    const auto header2 = read_header(header2_hex);
+    const auto work = instance.work();
+    BOOST_REQUIRE_EQUAL(instance.add({ header1, header2 }), error::success);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 2u);
+    BOOST_REQUIRE(instance.is_indexed(header1.hash(), 1));
+    BOOST_REQUIRE(instance.is_indexed(header2.hash(), 2));
+    BOOST_REQUIRE(!instance.is_indexed(header2.hash(), 1));
+    BOOST_REQUIRE(instance.work() > work);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__add__already_indexed__skipped)
+{
+    header_index instance(mainnet_settings());
+    instance.start(chain::block::genesis_mainnet().header());
+    const auto header1 = read_header(header1_hex);
+    BOOST_REQUIRE_EQUAL(instance.add({ header1 }), error::success);
+    const auto work = instance.work();
+    BOOST_REQUIRE_EQUAL(instance.add({ header1 }), error::success);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 1u);
+    BOOST_REQUIRE(instance.work() == work);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__add__unlinked__orphan_block)
+{
+    header_index instance(mainnet_settings());
+    instance.start(chain::block::genesis_mainnet().header());
+    BOOST_REQUIRE_EQUAL(instance.add({ read_header(header2_hex) }),
+        error::orphan_block);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__add__invalid_proof_of_work__not_indexed)
+{
+    header_index instance(mainnet_settings());
+    instance.start(chain::block::genesis_mainnet().header());
+    auto header1 = read_header(header1_hex);
+    header1.set_nonce(header1.nonce() + 1);
+    BOOST_REQUIRE(instance.add({ header1 }) != error::success);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__add__checkpoint_mismatch__checkpoints_failed)
+{
+    auto configuration = mainnet_settings();
+    configuration.checkpoints.emplace_back(null_hash, 1);
+    header_index instance(configuration);
+    instance.start(chain::block::genesis_mainnet().header());
+    BOOST_REQUIRE_EQUAL(instance.add({ read_header(header1_hex) }),
+        error::checkpoints_failed);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__reorganize__incoming__indexed)
+{
+    header_index instance(mainnet_settings());
+    instance.start(chain::block::genesis_mainnet().header());
+    const auto header1 = read_header(header1_hex);
+    const auto header2 = read_header(header2_hex);
+    BOOST_REQUIRE_EQUAL(instance.reorganize({ header1, header2 }, {}),
+        error::success);
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 2u);
+    BOOST_REQUIRE(instance.is_indexed(header2.hash(), 2));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__link__unlinked__false)
+{
+    header_index_fixture instance(mainnet_settings());
+    const auto genesis = chain::block::genesis_mainnet().header();
+    instance.start(genesis);
+    BOOST_REQUIRE(!instance.link(make_hash(2), make_hash(1), genesis.bits()));
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.side_size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__link__competing_branch__retained_until_more_work)
+{
+    header_index_fixture instance(mainnet_settings());
+    const auto genesis = chain::block::genesis_mainnet().header();
+    const auto bits = genesis.bits();
+    instance.start(genesis);
+
+    BOOST_REQUIRE(instance.link(make_hash(1), genesis.hash(), bits));
+    BOOST_REQUIRE(instance.link(make_hash(2), make_hash(1), bits));
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 2u);
+
+    // Equal work does not replace the indexed branch.
+    BOOST_REQUIRE(instance.link(make_hash(11), genesis.hash(), bits));
+    BOOST_REQUIRE(instance.link(make_hash(12), make_hash(11), bits));
+    BOOST_REQUIRE_EQUAL(instance.side_size(), 2u);
+    BOOST_REQUIRE(instance.is_indexed(make_hash(2), 2));
+    BOOST_REQUIRE(!instance.is_indexed(make_hash(12), 2));
+
+    // More work replaces it, and the replaced headers are retained.
+    const auto work = instance.work();
+    BOOST_REQUIRE(instance.link(make_hash(13), make_hash(12), bits));
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 3u);
+    BOOST_REQUIRE(instance.is_indexed(make_hash(11), 1));
+    BOOST_REQUIRE(instance.is_indexed(make_hash(12), 2));
+    BOOST_REQUIRE(instance.is_indexed(make_hash(13), 3));
+    BOOST_REQUIRE(instance.work() == work + chain::block::proof(bits));
+    BOOST_REQUIRE_EQUAL(instance.side_size(), 2u);
+
+    // The replaced branch is indexed again once it has more work.
+    BOOST_REQUIRE(instance.link(make_hash(3), make_hash(2), bits));
+    BOOST_REQUIRE(instance.is_indexed(make_hash(13), 3));
+    BOOST_REQUIRE(instance.link(make_hash(4), make_hash(3), bits));
+    BOOST_REQUIRE_EQUAL(instance.top_height(), 4u);
+    BOOST_REQUIRE(instance.is_indexed(make_hash(1), 1));
+    BOOST_REQUIRE(instance.is_indexed(make_hash(4), 4));
+    BOOST_REQUIRE_EQUAL(instance.side_size(), 3u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
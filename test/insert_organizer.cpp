@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+using namespace boost::system;
+using namespace boost::filesystem;
+
+#define MAINNET_BLOCK1 \
+"010000006fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000982" \
+"051fd1e4ba744bbbe680e1fee14677ba1a3c3540bf7b1cdb606e857233e0e61bc6649ffff00" \
+"1d01e3629901010000000100000000000000000000000000000000000000000000000000000" \
+"00000000000ffffffff0704ffff001d0104ffffffff0100f2052a0100000043410496b538e8" \
+"53519c726a2c91e61ec11600ae1390813a627c66fb8be7947be63c52da7589379515d4e0a60" \
+"4f8141781e62294721166bf621e73a82cbf2342c858eeac00000000"
+
+#define MAINNET_BLOCK2 \
+"010000004860eb18bf1b1620e37e9490fc8a427514416fd75159ab86688e9a8300000000d5f" \
+"dcc541e25de1c7a5addedf24858b8bb665c9f36ef744ee42c316022c90f9bb0bc6649ffff00" \
+"1d08d2bd6101010000000100000000000000000000000000000000000000000000000000000" \
+"00000000000ffffffff0704ffff001d010bffffffff0100f2052a010000004341047211a824" \
+"f55b505228e4c3d5194c1fcfaa15a456abdf37f9b9d97a4040afc073dee6c89064984f03385" \
+"237d92167c13e236446b417ab79a0fcae412ae3316b77ac00000000"
+
+#define MAINNET_BLOCK3 \
+"01000000bddd99ccfda39da1b108ce1a5d70038d0a967bacb68b6b63065f626a0000000044f" \
+"672226090d85db9a9f2fbfe5f0f9609b387af7be5b7fbb7a1767c831c9e995dbe6649ffff00" \
+"1d05e0ed6d01010000000100000000000000000000000000000000000000000000000000000" \
+"00000000000ffffffff0704ffff001d010effffffff0100f2052a0100000043410494b9d3e7" \
+"6c5b1629ecf97fff95d7a4bbdac87cc26099ada28066c6ff1eb9191223cd897194a08d0c272" \
+"6c5747f1db49e8cf90e75dc3e3550ae9b30086f3cd5aaac00000000"
+
+#define TEST_NAME \
+    std::string(boost::unit_test::framework::current_test_case().p_name)
+
+// Blocks one to three are under a checkpoint at block three.
+#define START_BLOCKCHAIN(name) \
+    threadpool pool; \
+    database::settings database_settings; \
+    database_settings.flush_writes = false; \
+    database_settings.directory = TEST_NAME; \
+    BOOST_REQUIRE(create_store(database_settings)); \
+    blockchain::settings blockchain_settings; \
+    blockchain_settings.checkpoints.emplace_back(read_block(MAINNET_BLOCK3).hash(), 3); \
+    block_chain name(pool, blockchain_settings, database_settings); \
+    BOOST_REQUIRE(name.start())
+
+#define NEW_BLOCK(height) \
+    std::make_shared<const message::block>(read_block(MAINNET_BLOCK##height))
+
+static bool create_store(database::settings& out_database)
+{
+    // Blockchain doesn't care about other indexes.
+    out_database.index_start_height = max_uint32;
+
+    // Table optimization parameters, reduced for speed and more collision.
+    out_database.file_growth_rate = 42;
+    out_database.block_table_buckets = 42;
+    out_database.transaction_table_buckets = 42;
+    out_database.spend_table_buckets = 42;
+    out_database.history_table_buckets = 42;
+
+    error_code ec;
+    remove_all(out_database.directory, ec);
+    database::data_base database(out_database);
+    return create_directories(out_database.directory, ec) &&
+        database.create(chain::block::genesis_mainnet());
+}
+
+static chain::block read_block(const std::string hex)
+{
+    data_chunk data;
+    BOOST_REQUIRE(decode_base16(data, hex));
+    chain::block result;
+    BOOST_REQUIRE(result.from_data(data));
+    return result;
+}
+
+static code organize_header(block_chain& instance, block_const_ptr block)
+{
+    std::promise<code> promise;
+    const auto handler = [&promise](const code& ec)
+    {
+        promise.set_value(ec);
+    };
+
+    instance.organize(std::make_shared<const message::header>(
+        block->header()), handler);
+    return promise.get_future().get();
+}
+
+static code organize_block(block_chain& instance, block_const_ptr block,
+    size_t height)
+{
+    std::promise<code> promise;
+    const auto handler = [&promise](const code& ec)
+    {
+        promise.set_value(ec);
+    };
+
+    instance.organize(block, height, handler);
+    return promise.get_future().get();
+}
+
+static void index_headers(block_chain& instance)
+{
+    BOOST_REQUIRE_EQUAL(organize_header(instance, NEW_BLOCK(1)), error::success);
+    BOOST_REQUIRE_EQUAL(organize_header(instance, NEW_BLOCK(2)), error::success);
+    BOOST_REQUIRE_EQUAL(organize_header(instance, NEW_BLOCK(3)), error::success);
+}
+
+class insert_organizer_setup_fixture
+{
+public:
+    insert_organizer_setup_fixture()
+    {
+        log::initialize();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(insert_organizer_tests, insert_organizer_setup_fixture)
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__gaps_in_order__filled)
+{
+    START_BLOCKCHAIN(instance);
+    index_headers(instance);
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    const auto block3 = NEW_BLOCK(3);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block2, 2), error::success);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block3, 3), error::success);
+
+    size_t top;
+    BOOST_REQUIRE(instance.get_last_height(top));
+    BOOST_REQUIRE_EQUAL(top, 3u);
+    BOOST_REQUIRE(instance.get_block_exists(block2->hash()));
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__gaps_out_of_order__filled)
+{
+    START_BLOCKCHAIN(instance);
+    index_headers(instance);
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    const auto block3 = NEW_BLOCK(3);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block3, 3), error::success);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block1, 1), error::success);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block2, 2), error::success);
+
+    size_t top;
+    BOOST_REQUIRE(instance.get_last_height(top));
+    BOOST_REQUIRE_EQUAL(top, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__duplicate__duplicate_block)
+{
+    START_BLOCKCHAIN(instance);
+    index_headers(instance);
+
+    const auto block3 = NEW_BLOCK(3);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block3, 3), error::success);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block3, 3), error::duplicate_block);
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__header_not_indexed__orphan_block)
+{
+    START_BLOCKCHAIN(instance);
+
+    const auto block1 = NEW_BLOCK(1);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block1, 1), error::orphan_block);
+    BOOST_REQUIRE(!instance.get_block_exists(block1->hash()));
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__misordered_height__orphan_block)
+{
+    START_BLOCKCHAIN(instance);
+    index_headers(instance);
+
+    // Each block is offered at its neighbor's height.
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block2, 1), error::orphan_block);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, block1, 2), error::orphan_block);
+    BOOST_REQUIRE(!instance.get_block_exists(block1->hash()));
+    BOOST_REQUIRE(!instance.get_block_exists(block2->hash()));
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__bad_bits__rejected)
+{
+    START_BLOCKCHAIN(instance);
+    index_headers(instance);
+
+    auto block = read_block(MAINNET_BLOCK1);
+    block.header().set_bits(block.header().bits() - 1u);
+    const auto bad = std::make_shared<const message::block>(std::move(block));
+    BOOST_REQUIRE(organize_block(instance, bad, 1) != error::success);
+    BOOST_REQUIRE(!instance.get_block_exists(bad->hash()));
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__organize__above_checkpoint__operation_failed)
+{
+    START_BLOCKCHAIN(instance);
+    BOOST_REQUIRE_EQUAL(organize_block(instance, NEW_BLOCK(1), 4), error::operation_failed);
+}
+
+BOOST_AUTO_TEST_CASE(insert_organizer__stop__during_insert__stopped)
+{
+    START_BLOCKCHAIN(instance);
+    index_headers(instance);
+
+    // The handler may be invoked after the test case returns.
+    const auto promise = std::make_shared<std::promise<code>>();
+    const auto handler = [promise](const code& ec)
+    {
+        promise->set_value(ec);
+    };
+
+    instance.organize(NEW_BLOCK(1), 1, handler);
+    BOOST_REQUIRE(instance.stop());
+
+    // The insert either completed before stop or was refused by it.
+    auto future = promise->get_future();
+    if (future.wait_for(std::chrono::seconds(1)) == std::future_status::ready)
+    {
+        const auto ec = future.get();
+        BOOST_REQUIRE(ec == error::success || ec == error::service_stopped);
+    }
+
+    BOOST_REQUIRE_EQUAL(organize_block(instance, NEW_BLOCK(2), 2), error::service_stopped);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
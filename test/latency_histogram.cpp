@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(latency_histogram_tests)
+
+class latency_histogram_fixture
+  : public latency_histogram
+{
+public:
+    using latency_histogram::bucket;
+    using latency_histogram::value;
+};
+
+// snapshot
+
+BOOST_AUTO_TEST_CASE(latency_histogram__snapshot__empty__zeros)
+{
+    const latency_histogram instance;
+    const auto result = instance.snapshot();
+    BOOST_REQUIRE_EQUAL(result.count, 0u);
+    BOOST_REQUIRE_EQUAL(result.total, 0u);
+    BOOST_REQUIRE_EQUAL(result.mean, 0u);
+    BOOST_REQUIRE_EQUAL(result.p50, 0u);
+    BOOST_REQUIRE_EQUAL(result.p99, 0u);
+    BOOST_REQUIRE_EQUAL(result.maximum, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__snapshot__small_values__exact)
+{
+    latency_histogram instance;
+
+    for (uint64_t value = 1; value <= 10; ++value)
+        instance.record(value);
+
+    const auto result = instance.snapshot();
+    BOOST_REQUIRE_EQUAL(result.count, 10u);
+    BOOST_REQUIRE_EQUAL(result.total, 55u);
+    BOOST_REQUIRE_EQUAL(result.mean, 5u);
+    BOOST_REQUIRE_EQUAL(result.p50, 5u);
+    BOOST_REQUIRE_EQUAL(result.p90, 9u);
+    BOOST_REQUIRE_EQUAL(result.p99, 10u);
+    BOOST_REQUIRE_EQUAL(result.maximum, 10u);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__snapshot__large_value__within_bucket_width)
+{
+    latency_histogram instance;
+    static const uint64_t expected = 1234567;
+    instance.record(expected);
+
+    const auto result = instance.snapshot();
+    BOOST_REQUIRE_EQUAL(result.maximum, expected);
+    BOOST_REQUIRE_LE(result.p50, expected);
+    BOOST_REQUIRE_GE(result.p50, expected - expected / 16);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__record__negative_duration__zero)
+{
+    latency_histogram instance;
+    instance.record(asio::duration(-1));
+
+    const auto result = instance.snapshot();
+    BOOST_REQUIRE_EQUAL(result.count, 1u);
+    BOOST_REQUIRE_EQUAL(result.total, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__record__duration__microseconds)
+{
+    latency_histogram instance;
+    instance.record(asio::milliseconds(3));
+
+    const auto result = instance.snapshot();
+    BOOST_REQUIRE_EQUAL(result.total, 3000u);
+    BOOST_REQUIRE_EQUAL(result.maximum, 3000u);
+}
+
+// bucket
+
+BOOST_AUTO_TEST_CASE(latency_histogram__bucket__value__round_trips_within_bucket)
+{
+    for (uint64_t value = 1; value < (uint64_t(1) << 36); value = value * 3 + 1)
+    {
+        const auto index = latency_histogram_fixture::bucket(value);
+        BOOST_REQUIRE_EQUAL(latency_histogram_fixture::bucket(
+            latency_histogram_fixture::value(index)), index);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(latency_histogram__bucket__overflow__last_bucket)
+{
+    const auto last = latency_histogram_fixture::bucket(uint64_t(1) << 36);
+    BOOST_REQUIRE_EQUAL(latency_histogram_fixture::bucket(max_uint64), last);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <future>
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(notification_queue_tests)
+
+BOOST_AUTO_TEST_CASE(notification_queue__enqueue__unbatched__delivered)
+{
+    threadpool pool(1);
+    const auto instance = std::make_shared<notification_queue>(pool, 10,
+        asio::duration::zero());
+    instance->start();
+
+    std::promise<bool> delivered;
+    instance->enqueue([&]() { delivered.set_value(true); }, false);
+    BOOST_REQUIRE(delivered.get_future().get());
+
+    instance->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(notification_queue__enqueue__batched__delivered_in_order)
+{
+    threadpool pool(2);
+    const auto instance = std::make_shared<notification_queue>(pool, 10,
+        asio::milliseconds(1));
+    instance->start();
+
+    size_t count = 0;
+    std::promise<size_t> last;
+    instance->enqueue([&]() { ++count; }, true);
+    instance->enqueue([&]() { ++count; }, true);
+    instance->enqueue([&]() { last.set_value(++count); }, true);
+    BOOST_REQUIRE_EQUAL(last.get_future().get(), 3u);
+    BOOST_REQUIRE_EQUAL(instance->depth(), 0u);
+
+    instance->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(notification_queue__enqueue__stopped__discarded)
+{
+    threadpool pool(1);
+    const auto instance = std::make_shared<notification_queue>(pool, 10,
+        asio::duration::zero());
+
+    auto invoked = false;
+    BOOST_REQUIRE(!instance->enqueue([&]() { invoked = true; }, false));
+    BOOST_REQUIRE_EQUAL(instance->depth(), 0u);
+
+    pool.shutdown();
+    pool.join();
+    BOOST_REQUIRE(!invoked);
+}
+
+BOOST_AUTO_TEST_CASE(notification_queue__enqueue__full__dropped_without_blocking)
+{
+    threadpool pool(1);
+    const auto instance = std::make_shared<notification_queue>(pool, 1,
+        asio::seconds(60));
+    instance->start();
+
+    auto invoked = false;
+    BOOST_REQUIRE(instance->enqueue([&]() { invoked = true; }, true));
+    BOOST_REQUIRE(!instance->enqueue([&]() { invoked = true; }, true));
+    BOOST_REQUIRE_EQUAL(instance->depth(), 1u);
+    BOOST_REQUIRE_EQUAL(instance->dropped(), 1u);
+
+    instance->stop();
+    BOOST_REQUIRE_EQUAL(instance->depth(), 0u);
+    pool.shutdown();
+    pool.join();
+    BOOST_REQUIRE(!invoked);
+}
+
+BOOST_AUTO_TEST_CASE(notification_queue__enqueue__delivering__depth_excludes_delivered)
+{
+    threadpool pool(1);
+    const auto instance = std::make_shared<notification_queue>(pool, 10,
+        asio::duration::zero());
+    instance->start();
+
+    std::promise<bool> started;
+    std::promise<bool> release;
+    std::promise<bool> delivered;
+    auto released = release.get_future().share();
+
+    instance->enqueue([&]()
+    {
+        started.set_value(true);
+        released.wait();
+    }, false);
+
+    // The first is being delivered and the second is pending behind it.
+    BOOST_REQUIRE(started.get_future().get());
+    instance->enqueue([&]() { delivered.set_value(true); }, false);
+    BOOST_REQUIRE_EQUAL(instance->depth(), 1u);
+
+    release.set_value(true);
+    BOOST_REQUIRE(delivered.get_future().get());
+    BOOST_REQUIRE_EQUAL(instance->depth(), 0u);
+
+    instance->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(orphan_pool_tests)
+
+typedef std::shared_ptr<const size_t> element;
+typedef orphan_pool<element> test_pool;
+
+static hash_digest make_hash(uint8_t id)
+{
+    auto hash = null_hash;
+    hash.front() = id;
+    return hash;
+}
+
+static bool add(test_pool& instance, uint8_t id, const hash_list& parents,
+    size_t size = 1)
+{
+    const auto value = std::make_shared<const size_t>(id);
+    return instance.add(value, make_hash(id), parents, size);
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__no_parents__false)
+{
+    test_pool instance(10, 10);
+    BOOST_REQUIRE(!add(instance, 1, {}));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__twice__single)
+{
+    test_pool instance(10, 10);
+    BOOST_REQUIRE(add(instance, 1, { make_hash(9) }));
+    BOOST_REQUIRE(!add(instance, 1, { make_hash(9) }));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.exists(make_hash(1)));
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__over_bytes__oldest_evicted)
+{
+    test_pool instance(10, 5);
+    BOOST_REQUIRE(add(instance, 1, { make_hash(9) }, 3));
+    BOOST_REQUIRE(add(instance, 2, { make_hash(9) }, 3));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), 3u);
+    BOOST_REQUIRE(!instance.exists(make_hash(1)));
+    BOOST_REQUIRE(instance.exists(make_hash(2)));
+}
+
+// remove
+
+BOOST_AUTO_TEST_CASE(orphan_pool__remove__two_parents__removed_once)
+{
+    test_pool instance(10, 10);
+    BOOST_REQUIRE(add(instance, 1, { make_hash(8), make_hash(9) }));
+    BOOST_REQUIRE_EQUAL(instance.remove(make_hash(8)).size(), 1u);
+    BOOST_REQUIRE(instance.remove(make_hash(9)).empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
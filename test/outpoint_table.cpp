@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(outpoint_table_tests)
+
+static const auto parent1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+static const auto parent2 = hash_literal("0100000000000000000000000000000000000000000000000000000000000000");
+static const auto parent3 = hash_literal("0000000000000000000000000000000000000000000000000000000000000003");
+
+static chain::transaction make_tx(uint32_t id, const hash_digest& parent,
+    uint32_t index)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ parent, index }, chain::script{},
+        0);
+    return chain::transaction{ id, 0, std::move(inputs), {} };
+}
+
+static message::block make_block(const chain::transaction::list& txs)
+{
+    chain::transaction::list all{ make_tx(0, null_hash,
+        chain::point::null_index) };
+    all.insert(all.end(), txs.begin(), txs.end());
+    return message::block{ chain::header{}, std::move(all) };
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__construct__default__empty)
+{
+    const outpoint_table instance;
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.groups(), 0u);
+    BOOST_REQUIRE(!instance.is_double_spend());
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__construct__block__excludes_coinbase)
+{
+    const auto block = make_block({ make_tx(1, parent1, 0) });
+    const outpoint_table instance(block);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(!instance.contains(chain::output_point{ null_hash,
+        chain::point::null_index }));
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__group__shared_parents__grouped_sorted)
+{
+    const auto block = make_block(
+    {
+        make_tx(1, parent2, 0),
+        make_tx(2, parent1, 3),
+        make_tx(3, parent3, 0),
+        make_tx(4, parent1, 1)
+    });
+
+    const outpoint_table instance(block);
+    BOOST_REQUIRE_EQUAL(instance.size(), 4u);
+    BOOST_REQUIRE_EQUAL(instance.groups(), 3u);
+
+    // Hashes are ordered by their (little endian) leading bytes.
+    const auto first = instance.group(0);
+    BOOST_REQUIRE((*first.first)->hash() == parent2);
+
+    const auto second = instance.group(1);
+    BOOST_REQUIRE_EQUAL(std::distance(second.first, second.second), 2);
+    BOOST_REQUIRE((*second.first)->hash() == parent1);
+    BOOST_REQUIRE_EQUAL((*second.first)->index(), 1u);
+    BOOST_REQUIRE_EQUAL((*(second.first + 1))->index(), 3u);
+
+    const auto third = instance.group(2);
+    BOOST_REQUIRE((*third.first)->hash() == parent3);
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__contains__spent_and_unspent__expected)
+{
+    const auto block = make_block({ make_tx(1, parent1, 0),
+        make_tx(2, parent2, 1) });
+    const outpoint_table instance(block);
+    BOOST_REQUIRE(instance.contains(chain::output_point{ parent1, 0 }));
+    BOOST_REQUIRE(instance.contains(chain::output_point{ parent2, 1 }));
+    BOOST_REQUIRE(!instance.contains(chain::output_point{ parent1, 1 }));
+    BOOST_REQUIRE(!instance.contains(chain::output_point{ parent3, 0 }));
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__is_double_spend__distinct__false)
+{
+    const auto block = make_block({ make_tx(1, parent1, 0),
+        make_tx(2, parent1, 1) });
+    BOOST_REQUIRE(!outpoint_table(block).is_double_spend());
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__is_double_spend__same_outpoint__true)
+{
+    const auto block = make_block({ make_tx(1, parent1, 0),
+        make_tx(2, parent2, 0), make_tx(3, parent1, 0) });
+    BOOST_REQUIRE(outpoint_table(block).is_double_spend());
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__group__shared_leading_bytes__sorted)
+{
+    // Parents that differ only in their last byte, spent in reverse order.
+    chain::transaction::list txs;
+    for (uint32_t id = 0; id < 200; ++id)
+    {
+        auto parent = null_hash;
+        parent.back() = static_cast<uint8_t>(199u - id);
+        txs.push_back(make_tx(id + 1u, parent, id % 3u));
+    }
+
+    const outpoint_table instance(make_block(txs));
+    BOOST_REQUIRE_EQUAL(instance.size(), 200u);
+    BOOST_REQUIRE_EQUAL(instance.groups(), 200u);
+
+    for (size_t position = 1; position < instance.groups(); ++position)
+        BOOST_REQUIRE((*instance.group(position - 1u).first)->hash() <
+            (*instance.group(position).first)->hash());
+}
+
+BOOST_AUTO_TEST_CASE(outpoint_table__construct__blocks__spans_blocks)
+{
+    const auto block1 = std::make_shared<const message::block>(
+        make_block({ make_tx(1, parent1, 0) }));
+    const auto block2 = std::make_shared<const message::block>(
+        make_block({ make_tx(2, parent1, 0) }));
+    const outpoint_table instance({ block1, block2 });
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.groups(), 1u);
+    BOOST_REQUIRE(instance.is_double_spend());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
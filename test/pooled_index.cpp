@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(pooled_index_tests)
+
+static const auto parent = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+static const uint32_t forks = 42;
+
+static chain::transaction make_tx(uint32_t id, const hash_digest& parent,
+    uint32_t index)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ parent, index }, chain::script{},
+        0);
+    return chain::transaction{ id, 0, std::move(inputs), {} };
+}
+
+static block_const_ptr_list make_blocks(const chain::transaction& tx)
+{
+    const auto coinbase = make_tx(0, null_hash, chain::point::null_index);
+    return
+    {
+        std::make_shared<const message::block>(message::block
+        {
+            chain::header{}, { coinbase, tx }
+        })
+    };
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__find__empty__false)
+{
+    const pooled_index instance(10);
+    uint32_t out_forks;
+    BOOST_REQUIRE(!instance.find(out_forks, make_tx(1, parent, 0).hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__find__added__forks)
+{
+    pooled_index instance(10);
+    const auto tx = make_tx(1, parent, 0);
+    instance.add(tx, forks);
+
+    uint32_t out_forks;
+    BOOST_REQUIRE(instance.find(out_forks, tx.hash()));
+    BOOST_REQUIRE_EQUAL(out_forks, forks);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__remove__confirmed__not_found)
+{
+    pooled_index instance(10);
+    const auto tx = make_tx(1, parent, 0);
+    instance.add(tx, forks);
+    instance.remove(make_blocks(tx));
+
+    uint32_t out_forks;
+    BOOST_REQUIRE(!instance.find(out_forks, tx.hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__add__popped__unverified_excludes_coinbase)
+{
+    pooled_index instance(10);
+    const auto tx = make_tx(1, parent, 0);
+    const auto blocks = make_blocks(tx);
+    instance.add(blocks);
+
+    uint32_t out_forks;
+    BOOST_REQUIRE(instance.find(out_forks, tx.hash()));
+    BOOST_REQUIRE_EQUAL(out_forks, pooled_index::unverified);
+    BOOST_REQUIRE(!instance.find(out_forks,
+        blocks.front()->transactions().front().hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__remove__evicted__not_found)
+{
+    pooled_index instance(10);
+    const auto tx = make_tx(1, parent, 0);
+    instance.add(tx, forks);
+    instance.remove(tx.hash());
+
+    uint32_t out_forks;
+    BOOST_REQUIRE(!instance.find(out_forks, tx.hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__add__zero_capacity__not_indexed)
+{
+    pooled_index instance(0);
+    instance.add(make_tx(1, parent, 0), forks);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__add__full__oldest_dropped)
+{
+    pooled_index instance(2);
+    const auto tx1 = make_tx(1, parent, 0);
+    const auto tx2 = make_tx(2, parent, 1);
+    const auto tx3 = make_tx(3, parent, 2);
+    instance.add(tx1, forks);
+    instance.add(tx2, forks);
+    instance.add(tx3, forks);
+
+    uint32_t out_forks;
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(!instance.find(out_forks, tx1.hash()));
+    BOOST_REQUIRE(instance.find(out_forks, tx2.hash()));
+    BOOST_REQUIRE(instance.find(out_forks, tx3.hash()));
+}
+
+BOOST_AUTO_TEST_CASE(pooled_index__add__removed_then_readded__not_dropped_by_stale_slot)
+{
+    pooled_index instance(2);
+    const auto tx1 = make_tx(1, parent, 0);
+    const auto tx2 = make_tx(2, parent, 1);
+    instance.add(tx1, forks);
+    instance.remove(tx1.hash());
+    instance.add(tx2, forks);
+    instance.add(tx1, forks);
+
+    uint32_t out_forks;
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(instance.find(out_forks, tx1.hash()));
+    BOOST_REQUIRE(instance.find(out_forks, tx2.hash()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(rate_counter_tests)
+
+class rate_counter_fixture
+  : public rate_counter
+{
+public:
+    rate_counter_fixture(size_t window_seconds)
+      : rate_counter(window_seconds)
+    {
+    }
+
+    using rate_counter::add;
+    using rate_counter::rate;
+};
+
+BOOST_AUTO_TEST_CASE(rate_counter__total__added__sum)
+{
+    rate_counter instance;
+    instance.add(3);
+    instance.add(4);
+    BOOST_REQUIRE_EQUAL(instance.total(), 7u);
+}
+
+BOOST_AUTO_TEST_CASE(rate_counter__rate__empty__zero)
+{
+    const rate_counter_fixture instance(10);
+    BOOST_REQUIRE_EQUAL(instance.rate(100), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(rate_counter__rate__current_second__excluded)
+{
+    rate_counter_fixture instance(10);
+    instance.add(50, 100);
+    BOOST_REQUIRE_EQUAL(instance.rate(100), 0.0);
+    BOOST_REQUIRE_EQUAL(instance.rate(101), 5.0);
+}
+
+BOOST_AUTO_TEST_CASE(rate_counter__rate__outside_window__excluded)
+{
+    rate_counter_fixture instance(2);
+    instance.add(10, 100);
+    instance.add(20, 101);
+    instance.add(40, 102);
+    BOOST_REQUIRE_EQUAL(instance.rate(103), 30.0);
+}
+
+BOOST_AUTO_TEST_CASE(rate_counter__add__reused_slot__reset)
+{
+    rate_counter_fixture instance(4);
+    instance.add(100, 100);
+    instance.add(8, 116);
+    BOOST_REQUIRE_EQUAL(instance.rate(117), 2.0);
+    BOOST_REQUIRE_EQUAL(instance.total(), 108u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <boost/filesystem.hpp>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(spend_index_tests)
+
+static const auto parent1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+static const auto parent2 = hash_literal("0000000000000000000000000000000000000000000000000000000000000002");
+
+static chain::transaction make_tx(uint32_t id, const hash_digest& parent,
+    uint32_t index)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ parent, index }, chain::script{},
+        0);
+    return chain::transaction{ id, 0, std::move(inputs), {} };
+}
+
+static chain::transaction make_parent(uint32_t id, const hash_digest& parent,
+    uint32_t index)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ parent, index }, chain::script{},
+        0);
+    chain::output::list outputs;
+    outputs.emplace_back(1, chain::script{});
+    return chain::transaction{ id, 0, std::move(inputs), std::move(outputs) };
+}
+
+static block_const_ptr_list make_blocks(const chain::transaction& tx)
+{
+    const auto coinbase = make_tx(0, null_hash, chain::point::null_index);
+    return
+    {
+        std::make_shared<const message::block>(message::block
+        {
+            chain::header{}, { coinbase, tx }
+        })
+    };
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(spend_index__add__distinct_spends__true)
+{
+    spend_index instance;
+    const auto tx1 = make_tx(1, parent1, 0);
+    const auto tx2 = make_tx(2, parent1, 1);
+    BOOST_REQUIRE(instance.add(tx1));
+    BOOST_REQUIRE(instance.add(tx2));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(instance.spender({ parent1, 0 }) == tx1.hash());
+    BOOST_REQUIRE(instance.spender({ parent1, 1 }) == tx2.hash());
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__add__conflict__false_unchanged)
+{
+    spend_index instance;
+    const auto tx1 = make_tx(1, parent1, 0);
+    const auto tx2 = make_tx(2, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx1));
+    BOOST_REQUIRE(!instance.add(tx2));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.spender({ parent1, 0 }) == tx1.hash());
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__add__twice__true)
+{
+    spend_index instance;
+    const auto tx = make_tx(1, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx));
+    BOOST_REQUIRE(instance.add(tx));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+// conflicts
+
+BOOST_AUTO_TEST_CASE(spend_index__conflicts__other_spender__true)
+{
+    spend_index instance;
+    BOOST_REQUIRE(instance.add(make_tx(1, parent1, 0)));
+    BOOST_REQUIRE(instance.conflicts(make_tx(2, parent1, 0)));
+    BOOST_REQUIRE(!instance.conflicts(make_tx(2, parent2, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__conflicts__same_spender__false)
+{
+    spend_index instance;
+    const auto tx = make_tx(1, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx));
+    BOOST_REQUIRE(!instance.conflicts(tx));
+}
+
+// remove
+
+BOOST_AUTO_TEST_CASE(spend_index__remove__hash__spends_removed)
+{
+    spend_index instance;
+    const auto tx = make_tx(1, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx));
+    instance.remove(tx.hash());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(instance.spender({ parent1, 0 }) == null_hash);
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__remove__confirmed_block__none_evicted)
+{
+    spend_index instance;
+    const auto tx = make_tx(1, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx));
+    BOOST_REQUIRE(instance.remove(make_blocks(tx)).empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__remove__conflicting_block__evicted)
+{
+    spend_index instance;
+    const auto tx1 = make_tx(1, parent1, 0);
+    const auto tx2 = make_tx(2, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx1));
+
+    const auto evicted = instance.remove(make_blocks(tx2));
+    BOOST_REQUIRE_EQUAL(evicted.size(), 1u);
+    BOOST_REQUIRE(evicted.front() == tx1.hash());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__remove__conflicting_block__descendants_evicted)
+{
+    spend_index instance;
+    const auto tx1 = make_parent(1, parent1, 0);
+    const auto child = make_tx(2, tx1.hash(), 0);
+    const auto tx3 = make_tx(3, parent1, 0);
+    BOOST_REQUIRE(instance.add(tx1));
+    BOOST_REQUIRE(instance.add(child));
+
+    const auto evicted = instance.remove(make_blocks(tx3));
+    BOOST_REQUIRE_EQUAL(evicted.size(), 2u);
+    BOOST_REQUIRE(evicted.front() == tx1.hash());
+    BOOST_REQUIRE(evicted.back() == child.hash());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__remove__confirmed_parent__descendants_retained)
+{
+    spend_index instance;
+    const auto tx1 = make_parent(1, parent1, 0);
+    const auto child = make_tx(2, tx1.hash(), 0);
+    BOOST_REQUIRE(instance.add(tx1));
+    BOOST_REQUIRE(instance.add(child));
+    BOOST_REQUIRE(instance.remove(make_blocks(tx1)).empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.spender({ tx1.hash(), 0 }) == child.hash());
+}
+
+// save/load
+
+BOOST_AUTO_TEST_CASE(spend_index__load__saved__restored_and_deleted)
+{
+    const boost::filesystem::path file("spend_index.test");
+    const auto tx1 = make_parent(1, parent1, 0);
+    const auto tx2 = make_tx(2, parent2, 1);
+
+    spend_index saved;
+    BOOST_REQUIRE(saved.add(tx1));
+    BOOST_REQUIRE(saved.add(tx2));
+    BOOST_REQUIRE(saved.save(file));
+
+    spend_index instance;
+    BOOST_REQUIRE(instance.load(file));
+    BOOST_REQUIRE(!boost::filesystem::exists(file));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(instance.spender({ parent1, 0 }) == tx1.hash());
+    BOOST_REQUIRE(instance.spender({ parent2, 1 }) == tx2.hash());
+}
+
+BOOST_AUTO_TEST_CASE(spend_index__load__missing_file__false)
+{
+    spend_index instance;
+    BOOST_REQUIRE(!instance.load("spend_index.missing"));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+// add (blocks)
+
+BOOST_AUTO_TEST_CASE(spend_index__add_blocks__outgoing__spends_indexed)
+{
+    spend_index instance;
+    const auto tx = make_tx(1, parent1, 0);
+    instance.add(make_blocks(tx));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.conflicts(make_tx(2, parent1, 0)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(store_accounting_tests)
+
+typedef store_accounting::call call;
+
+static const auto output = static_cast<size_t>(call::output);
+static const auto header = static_cast<size_t>(call::header);
+
+// record
+
+BOOST_AUTO_TEST_CASE(store_accounting__record__block__totals_and_block)
+{
+    store_accounting instance(true);
+    instance.record(call::output, true, asio::milliseconds(2), 1);
+    instance.record(call::output, true, asio::milliseconds(3), 0);
+
+    const auto totals = instance.totals();
+    BOOST_REQUIRE_EQUAL(totals[output].count, 2u);
+    BOOST_REQUIRE_EQUAL(totals[output].microseconds, 5000u);
+    BOOST_REQUIRE_EQUAL(totals[output].faults, 1u);
+    BOOST_REQUIRE_EQUAL(totals[header].count, 0u);
+
+    const auto block = instance.take_block();
+    BOOST_REQUIRE_EQUAL(block[output].count, 2u);
+    BOOST_REQUIRE_EQUAL(block[output].microseconds, 5000u);
+    BOOST_REQUIRE_EQUAL(block[output].faults, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(store_accounting__record__not_block__totals_only)
+{
+    store_accounting instance(true);
+    instance.record(call::output, false, asio::milliseconds(1), 0);
+    BOOST_REQUIRE_EQUAL(instance.totals()[output].count, 1u);
+    BOOST_REQUIRE_EQUAL(instance.take_block()[output].count, 0u);
+}
+
+// take_block
+
+BOOST_AUTO_TEST_CASE(store_accounting__take_block__taken__cleared)
+{
+    store_accounting instance(true);
+    instance.record(call::header, true, asio::milliseconds(1), 0);
+    BOOST_REQUIRE_EQUAL(instance.take_block()[header].count, 1u);
+    BOOST_REQUIRE_EQUAL(instance.take_block()[header].count, 0u);
+    BOOST_REQUIRE_EQUAL(instance.totals()[header].count, 1u);
+}
+
+// timer
+
+BOOST_AUTO_TEST_CASE(store_accounting__timer__enabled__recorded)
+{
+    store_accounting instance(true);
+    {
+        store_accounting::timer timer(instance, call::header, true);
+    }
+
+    BOOST_REQUIRE_EQUAL(instance.totals()[header].count, 1u);
+    BOOST_REQUIRE_EQUAL(instance.take_block()[header].count, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(store_accounting__timer__disabled__not_recorded)
+{
+    store_accounting instance(false);
+    {
+        store_accounting::timer timer(instance, call::header, true);
+    }
+
+    BOOST_REQUIRE(!instance.enabled());
+    BOOST_REQUIRE_EQUAL(instance.totals()[header].count, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <boost/filesystem.hpp>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(tracer_tests)
+
+#define TEST_FILE "tracer.json"
+
+BOOST_AUTO_TEST_CASE(tracer__enabled__always__matches_build)
+{
+#ifdef WITH_TRACING
+    BOOST_REQUIRE(tracer::enabled());
+#else
+    BOOST_REQUIRE(!tracer::enabled());
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(tracer__dump__recorded__expected)
+{
+    boost::filesystem::remove(TEST_FILE);
+    tracer::clear();
+
+    const auto now = asio::steady_clock::now();
+    tracer::record({ "test_span", null_hash, 42, now, now });
+
+    if (!tracer::enabled())
+    {
+        BOOST_REQUIRE(!tracer::dump(TEST_FILE));
+        return;
+    }
+
+    BOOST_REQUIRE(tracer::dump(TEST_FILE));
+
+    bc::ifstream file(TEST_FILE);
+    const std::string text((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(text.find("\"traceEvents\"") != std::string::npos);
+    BOOST_REQUIRE(text.find("\"name\":\"test_span\"") != std::string::npos);
+    BOOST_REQUIRE(text.find("\"height\":42") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(tracer__clear__recorded__empty_trace)
+{
+    boost::filesystem::remove(TEST_FILE);
+    const auto now = asio::steady_clock::now();
+    tracer::record({ "test_span", null_hash, 42, now, now });
+    tracer::clear();
+
+    if (!tracer::enabled())
+        return;
+
+    BOOST_REQUIRE(tracer::dump(TEST_FILE));
+
+    bc::ifstream file(TEST_FILE);
+    const std::string text((std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(text.find("test_span") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+using namespace bc::machine;
+
+BOOST_AUTO_TEST_SUITE(transaction_metrics_cache_tests)
+
+static transaction_metrics::const_ptr make_metrics(uint32_t version)
+{
+    const chain::transaction tx{ version, 0, {}, {} };
+    return std::make_shared<const transaction_metrics>(tx,
+        rule_fork::bip16_rule);
+}
+
+// transaction_metrics
+
+BOOST_AUTO_TEST_CASE(transaction_metrics__construct__empty_tx__expected)
+{
+    const chain::transaction tx{ 1, 0, {}, {} };
+    const transaction_metrics instance(tx, rule_fork::bip16_rule);
+    BOOST_REQUIRE(instance.hash() == tx.hash());
+    BOOST_REQUIRE(instance.witness_hash() == tx.hash(true));
+    BOOST_REQUIRE_EQUAL(instance.forks(), rule_fork::bip16_rule);
+    BOOST_REQUIRE_EQUAL(instance.size(), tx.serialized_size(true, false));
+    BOOST_REQUIRE_EQUAL(instance.sigops(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.fees(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.inputs(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.outputs(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics__is_sigops__forks__expected)
+{
+    const auto instance = make_metrics(1);
+    BOOST_REQUIRE(instance->is_sigops(true, false));
+    BOOST_REQUIRE(!instance->is_sigops(true, true));
+    BOOST_REQUIRE(!instance->is_sigops(false, false));
+}
+
+// add/get
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__get__missing__empty)
+{
+    transaction_metrics_cache instance(10);
+    BOOST_REQUIRE(!instance.get(null_hash));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__add__get__round_trips)
+{
+    transaction_metrics_cache instance(10);
+    const auto metrics = make_metrics(1);
+    instance.add(metrics);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.get(metrics->hash()) == metrics);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__add__twice__replaced)
+{
+    transaction_metrics_cache instance(10);
+    const auto metrics1 = make_metrics(1);
+    const auto metrics2 = make_metrics(1);
+    instance.add(metrics1);
+    instance.add(metrics2);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(instance.get(metrics1->hash()) == metrics2);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__add__zero_capacity__not_cached)
+{
+    transaction_metrics_cache instance(0);
+    instance.add(make_metrics(1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__add__full__oldest_dropped)
+{
+    transaction_metrics_cache instance(2);
+    const auto metrics1 = make_metrics(1);
+    const auto metrics2 = make_metrics(2);
+    const auto metrics3 = make_metrics(3);
+    instance.add(metrics1);
+    instance.add(metrics2);
+    instance.add(metrics3);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(!instance.get(metrics1->hash()));
+    BOOST_REQUIRE(instance.get(metrics3->hash()) == metrics3);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__add__removed_then_readded__not_dropped_by_stale_slot)
+{
+    transaction_metrics_cache instance(2);
+    const auto metrics1 = make_metrics(1);
+    const auto metrics2 = make_metrics(2);
+    const auto metrics3 = make_metrics(3);
+    instance.add(metrics1);
+    instance.remove(metrics1->hash());
+    instance.add(metrics1);
+
+    // The stale slot of the first insertion is dropped, not the entry.
+    instance.add(metrics2);
+    BOOST_REQUIRE(instance.get(metrics1->hash()) == metrics1);
+    BOOST_REQUIRE(instance.get(metrics2->hash()) == metrics2);
+
+    // The live slot of the second insertion is dropped.
+    instance.add(metrics3);
+    BOOST_REQUIRE(!instance.get(metrics1->hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+}
+
+// remove
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__remove__hash__removed)
+{
+    transaction_metrics_cache instance(10);
+    const auto metrics = make_metrics(1);
+    instance.add(metrics);
+    instance.remove(metrics->hash());
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!instance.get(metrics->hash()));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_metrics_cache__remove__blocks__removed)
+{
+    transaction_metrics_cache instance(10);
+    const chain::transaction tx{ 1, 0, {}, {} };
+    instance.add(make_metrics(1));
+    instance.add(make_metrics(2));
+
+    const block_const_ptr_list blocks
+    {
+        std::make_shared<const message::block>(message::block
+        {
+            chain::header{}, { tx }
+        })
+    };
+
+    instance.remove(blocks);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE(!instance.get(tx.hash()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
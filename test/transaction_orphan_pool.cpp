@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(transaction_orphan_pool_tests)
+
+static const auto parent1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+static const auto parent2 = hash_literal("0000000000000000000000000000000000000000000000000000000000000002");
+
+// Prevout caches are default (invalid), so each parent is missing.
+static transaction_const_ptr make_tx(uint32_t id, const hash_list& parents)
+{
+    chain::input::list inputs;
+
+    for (const auto& parent: parents)
+        inputs.emplace_back(chain::output_point{ parent, 0 }, chain::script{},
+            0);
+
+    return std::make_shared<const message::transaction>(id, 0,
+        std::move(inputs), chain::output::list{});
+}
+
+static transaction_const_ptr make_tx(uint32_t id, const hash_digest& parent)
+{
+    return make_tx(id, hash_list{ parent });
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__no_inputs__false)
+{
+    transaction_orphan_pool instance(10, 1000);
+    BOOST_REQUIRE(!instance.add(make_tx(1, hash_list{})));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__missing_parent__true)
+{
+    transaction_orphan_pool instance(10, 1000);
+    const auto tx = make_tx(1, parent1);
+    BOOST_REQUIRE(instance.add(tx));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), tx->serialized_size(true, true));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__twice__single)
+{
+    transaction_orphan_pool instance(10, 1000);
+    const auto tx = make_tx(1, parent1);
+    BOOST_REQUIRE(instance.add(tx));
+    BOOST_REQUIRE(!instance.add(tx));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__spent_prevout__false)
+{
+    transaction_orphan_pool instance(10, 1000);
+    const auto tx = make_tx(1, parent1);
+    tx->inputs().front().previous_output().validation.spent = true;
+    BOOST_REQUIRE(!instance.add(tx));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__zero_count_limit__false)
+{
+    transaction_orphan_pool instance(0, 1000);
+    BOOST_REQUIRE(!instance.add(make_tx(1, parent1)));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__exceeds_bytes_limit__false)
+{
+    const auto tx = make_tx(1, parent1);
+    transaction_orphan_pool instance(10, tx->serialized_size(true, true) - 1u);
+    BOOST_REQUIRE(!instance.add(tx));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__count_limit__oldest_evicted)
+{
+    transaction_orphan_pool instance(2, 1000);
+    BOOST_REQUIRE(instance.add(make_tx(1, parent1)));
+    BOOST_REQUIRE(instance.add(make_tx(2, parent2)));
+    BOOST_REQUIRE(instance.add(make_tx(3, parent2)));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(instance.remove(parent1).empty());
+    BOOST_REQUIRE_EQUAL(instance.remove(parent2).size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__add__bytes_limit__oldest_evicted)
+{
+    const auto tx1 = make_tx(1, parent1);
+    const auto tx2 = make_tx(2, parent2);
+    const auto size = tx1->serialized_size(true, true);
+    transaction_orphan_pool instance(10, 2 * size - 1u);
+    BOOST_REQUIRE(instance.add(tx1));
+    BOOST_REQUIRE(instance.add(tx2));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), size);
+    BOOST_REQUIRE(instance.remove(parent1).empty());
+}
+
+// remove
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__remove__unknown_parent__empty)
+{
+    transaction_orphan_pool instance(10, 1000);
+    BOOST_REQUIRE(instance.add(make_tx(1, parent1)));
+    BOOST_REQUIRE(instance.remove(parent2).empty());
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__remove__parent__children_removed)
+{
+    transaction_orphan_pool instance(10, 1000);
+    const auto tx1 = make_tx(1, parent1);
+    const auto tx2 = make_tx(2, parent1);
+    BOOST_REQUIRE(instance.add(tx1));
+    BOOST_REQUIRE(instance.add(tx2));
+
+    const auto children = instance.remove(parent1);
+    BOOST_REQUIRE_EQUAL(children.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.bytes(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(transaction_orphan_pool__remove__two_parents__removed_once)
+{
+    transaction_orphan_pool instance(10, 1000);
+    const auto tx = make_tx(1, hash_list{ parent1, parent2 });
+    BOOST_REQUIRE(instance.add(tx));
+
+    const auto children = instance.remove(parent2);
+    BOOST_REQUIRE_EQUAL(children.size(), 1u);
+    BOOST_REQUIRE(children.front() == tx);
+    BOOST_REQUIRE(instance.remove(parent1).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
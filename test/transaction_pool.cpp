@@ -18,6 +18,8 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <memory>
+#include <utility>
 #include <bitcoin/blockchain.hpp>
 
 using namespace bc;
@@ -25,6 +27,20 @@ using namespace bc::blockchain;
 
 BOOST_AUTO_TEST_SUITE(transaction_pool_tests)
 
+static const auto funding = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+
+static transaction_const_ptr make_tx(const hash_digest& parent, uint32_t index,
+    uint64_t value)
+{
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ parent, index }, chain::script{},
+        0);
+    chain::output::list outputs;
+    outputs.emplace_back(value, chain::script{});
+    return std::make_shared<const message::transaction>(
+        chain::transaction{ 1, 0, std::move(inputs), std::move(outputs) });
+}
+
 BOOST_AUTO_TEST_CASE(transaction_pool__construct__foo__bar)
 {
     // TODO
@@ -40,6 +56,42 @@ BOOST_AUTO_TEST_CASE(transaction_pool__add_unconfirmed_transactions__empty_list_
     BOOST_REQUIRE_EQUAL(true, true);
 }
 
+// The pool end iterator was dereferenced on the first add to an empty pool.
+BOOST_AUTO_TEST_CASE(transaction_pool__add_unconfirmed_transactions__empty_pool__no_end_dereference)
+{
+    settings blockchain_settings;
+    transaction_pool pool(blockchain_settings);
+
+    const transaction_const_ptr_list txs{ make_tx(funding, 0, 100) };
+    BOOST_REQUIRE_NO_THROW(pool.add_unconfirmed_transactions(txs));
+}
+
+// The maximum entry iterator was retained across inserts that may rehash.
+BOOST_AUTO_TEST_CASE(transaction_pool__add_unconfirmed_transactions__many__no_stale_iterator)
+{
+    settings blockchain_settings;
+    transaction_pool pool(blockchain_settings);
+
+    transaction_const_ptr_list txs;
+    for (uint32_t index = 0; index < 1000; ++index)
+        txs.push_back(make_tx(funding, index, index));
+
+    BOOST_REQUIRE_NO_THROW(pool.add_unconfirmed_transactions(txs));
+}
+
+// The template walk dereferenced the end of the child closure cache for
+// entries without a cached closure.
+BOOST_AUTO_TEST_CASE(transaction_pool__add_unconfirmed_transactions__parent_then_child__no_closure_end_dereference)
+{
+    settings blockchain_settings;
+    transaction_pool pool(blockchain_settings);
+
+    const auto parent = make_tx(funding, 0, 100);
+    const auto child = make_tx(parent->hash(), 0, 50);
+    BOOST_REQUIRE_NO_THROW(pool.add_unconfirmed_transactions({ parent }));
+    BOOST_REQUIRE_NO_THROW(pool.add_unconfirmed_transactions({ child }));
+}
+
 //BOOST_AUTO_TEST_CASE(transaction_pool__add_unconfirmed_transactions__empty_list__noop)
 //{
 //    settings blockchain_settings;
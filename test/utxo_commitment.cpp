@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(utxo_commitment_tests)
+
+static const auto hash1 = hash_literal("0000000000000000000000000000000000000000000000000000000000000001");
+static const auto hash2 = hash_literal("0000000000000000000000000000000000000000000000000000000000000002");
+
+static const chain::output_point point1{ hash1, 0 };
+static const chain::output_point point2{ hash2, 1 };
+static const chain::output output1{ 1, {} };
+static const chain::output output2{ 2, {} };
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__construct__default__null_value)
+{
+    const utxo_commitment instance;
+    BOOST_REQUIRE(instance.value() == null_hash);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__construct__value__round_trips)
+{
+    utxo_commitment instance;
+    instance.add(point1, output1);
+    const utxo_commitment copy(instance.value());
+    BOOST_REQUIRE(copy == instance);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__add__any_order__equal)
+{
+    utxo_commitment instance1;
+    instance1.add(point1, output1);
+    instance1.add(point2, output2);
+
+    utxo_commitment instance2;
+    instance2.add(point2, output2);
+    instance2.add(point1, output1);
+    BOOST_REQUIRE(instance1 == instance2);
+    BOOST_REQUIRE(instance1.value() != null_hash);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__add__distinct_outputs__not_equal)
+{
+    utxo_commitment instance1;
+    instance1.add(point1, output1);
+
+    utxo_commitment instance2;
+    instance2.add(point1, output2);
+    BOOST_REQUIRE(instance1 != instance2);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__remove__added__empty)
+{
+    utxo_commitment instance;
+    instance.add(point1, output1);
+    instance.add(point2, output2);
+    instance.remove(point1, output1);
+    instance.remove(point2, output2);
+    BOOST_REQUIRE(instance == utxo_commitment());
+}
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__remove__before_add__empty)
+{
+    utxo_commitment instance;
+    instance.remove(point1, output1);
+    instance.add(point1, output1);
+    BOOST_REQUIRE(instance.value() == null_hash);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_commitment__merge__delta__equals_direct)
+{
+    utxo_commitment direct;
+    direct.add(point1, output1);
+    direct.remove(point1, output1);
+    direct.add(point2, output2);
+
+    utxo_commitment instance;
+    instance.add(point1, output1);
+
+    utxo_commitment delta;
+    delta.remove(point1, output1);
+    delta.add(point2, output2);
+    instance.merge(delta);
+    BOOST_REQUIRE(instance == direct);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(validation_mutex_tests)
+
+typedef validation_mutex::caller caller;
+typedef validation_mutex::priority priority;
+
+static const auto settle = std::chrono::milliseconds(50);
+
+// Lock order of one low and two high waiters queued behind a high holder.
+static std::vector<caller> admission_order(validation_mutex& instance)
+{
+    std::mutex order_mutex;
+    std::vector<caller> order;
+
+    const auto locker = [&](caller who, bool high)
+    {
+        high ? instance.lock_high_priority(who) :
+            instance.lock_low_priority(who);
+
+        order_mutex.lock();
+        order.push_back(who);
+        order_mutex.unlock();
+
+        high ? instance.unlock_high_priority() :
+            instance.unlock_low_priority();
+    };
+
+    instance.lock_high_priority(caller::chain);
+    std::thread low(locker, caller::transaction, false);
+    std::this_thread::sleep_for(settle);
+    std::thread high1(locker, caller::block, true);
+    std::thread high2(locker, caller::header, true);
+    std::this_thread::sleep_for(settle);
+    instance.unlock_high_priority();
+
+    low.join();
+    high1.join();
+    high2.join();
+    return order;
+}
+
+// statistics
+
+BOOST_AUTO_TEST_CASE(validation_mutex__statistics__locked__recorded_by_caller_and_priority)
+{
+    validation_mutex instance(true, 16);
+    instance.lock_high_priority(caller::block);
+    instance.unlock_high_priority();
+    instance.lock_low_priority(caller::transaction);
+    instance.unlock_low_priority();
+    instance.lock_low_priority(caller::transaction);
+    instance.unlock_low_priority();
+
+    const auto result = instance.statistics();
+    const auto block = static_cast<size_t>(caller::block);
+    const auto transaction = static_cast<size_t>(caller::transaction);
+    const auto high = static_cast<size_t>(priority::high);
+    const auto low = static_cast<size_t>(priority::low);
+    BOOST_REQUIRE_EQUAL(result.caller_waits[block].count, 1u);
+    BOOST_REQUIRE_EQUAL(result.caller_holds[block].count, 1u);
+    BOOST_REQUIRE_EQUAL(result.caller_waits[transaction].count, 2u);
+    BOOST_REQUIRE_EQUAL(result.caller_holds[transaction].count, 2u);
+    BOOST_REQUIRE_EQUAL(result.priority_waits[high].count, 1u);
+    BOOST_REQUIRE_EQUAL(result.priority_holds[low].count, 2u);
+    BOOST_REQUIRE_EQUAL(result.fair_grants, 0u);
+}
+
+// fairness
+
+BOOST_AUTO_TEST_CASE(validation_mutex__lock__strict_priority__low_last)
+{
+    validation_mutex instance(true, 0);
+    const auto order = admission_order(instance);
+    BOOST_REQUIRE_EQUAL(order.size(), 3u);
+    BOOST_REQUIRE(order[2] == caller::transaction);
+    BOOST_REQUIRE_EQUAL(instance.statistics().fair_grants, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(validation_mutex__lock__fairness_limit_one__low_after_one_high)
+{
+    validation_mutex instance(true, 1);
+    const auto order = admission_order(instance);
+    BOOST_REQUIRE_EQUAL(order.size(), 3u);
+    BOOST_REQUIRE(order[0] != caller::transaction);
+    BOOST_REQUIRE(order[1] == caller::transaction);
+    BOOST_REQUIRE_EQUAL(instance.statistics().fair_grants, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(validation_pools_tests)
+
+typedef validation_pools::pool pool;
+
+static settings two_threads()
+{
+    settings configuration;
+    configuration.populate_threads = 2;
+    configuration.verify_threads = 2;
+    configuration.query_threads = 2;
+    return configuration;
+}
+
+BOOST_AUTO_TEST_CASE(validation_pools__construct__configured_threads__sized)
+{
+    auto configuration = two_threads();
+    configuration.verify_threads = 3;
+    validation_pools instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.populate().size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.verify().size(), 3u);
+    BOOST_REQUIRE_EQUAL(instance.query().size(), 2u);
+    instance.shutdown();
+    instance.join();
+}
+
+BOOST_AUTO_TEST_CASE(validation_pools__start__unpinned__true)
+{
+    validation_pools instance(two_threads());
+    BOOST_REQUIRE(instance.start());
+    instance.shutdown();
+    instance.join();
+}
+
+BOOST_AUTO_TEST_CASE(validation_pools__utilization__idle__bounded)
+{
+    validation_pools instance(two_threads());
+    BOOST_REQUIRE(instance.start());
+
+    for (const auto value: instance.utilization())
+    {
+        BOOST_REQUIRE_GE(value, 0.0);
+        BOOST_REQUIRE_LE(value, 1.0);
+    }
+
+    instance.shutdown();
+    instance.join();
+}
+
+BOOST_AUTO_TEST_CASE(validation_pools__verify__dispatched__invoked)
+{
+    validation_pools instance(two_threads());
+    BOOST_REQUIRE(instance.start());
+
+    std::mutex mutex;
+    std::condition_variable invoked;
+    auto done = false;
+
+    instance.verify().concurrent([&]()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        invoked.notify_one();
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    invoked.wait(lock, [&]() { return done; });
+    lock.unlock();
+
+    instance.shutdown();
+    instance.join();
+}
+
+BOOST_AUTO_TEST_CASE(validation_pools__to_string__pool__name)
+{
+    BOOST_REQUIRE_EQUAL(validation_pools::to_string(pool::populate),
+        "populate");
+    BOOST_REQUIRE_EQUAL(validation_pools::to_string(pool::verify), "verify");
+    BOOST_REQUIRE_EQUAL(validation_pools::to_string(pool::query), "query");
+}
+
+BOOST_AUTO_TEST_CASE(validation_pools__to_string__utilizations__percentages)
+{
+    const validation_pools::utilizations values{ { 0.5, 0.25, 0.0 } };
+    BOOST_REQUIRE_EQUAL(validation_pools::to_string(values),
+        "populate 50.0%, verify 25.0%, query 0.0%");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
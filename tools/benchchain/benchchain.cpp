@@ -0,0 +1,726 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/blockchain.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_BENCHCHAIN_USAGE \
+    "Usage: benchchain <store> [--blocks <count>] [--transactions <count>]\n" \
+    "    [--inputs <count>] [--outputs <count>] [--script true|p2sh|p2pkh]\n" \
+    "    [--depth <count>] [--fork-interval <count>] [--fork-depth <count>]\n" \
+    "    [--seed <value>]\n"
+#define BS_BENCHCHAIN_CREATE_FAIL \
+    "Failed to create the store in %1%.\n"
+#define BS_BENCHCHAIN_START_FAIL \
+    "Failed to start the blockchain in %1%.\n"
+#define BS_BENCHCHAIN_ORGANIZE_FAIL \
+    "Failed to organize block [%1%] at height %2% with error, '%3%'.\n"
+#define BS_BENCHCHAIN_GENERATED \
+    "Generated %1% blocks, %2% txs, %3% inputs in %4% ms.\n"
+
+using namespace bc;
+using namespace bc::blockchain;
+using namespace bc::chain;
+using namespace bc::database;
+using namespace bc::machine;
+using namespace boost::filesystem;
+using boost::format;
+
+typedef std::chrono::steady_clock clock_type;
+typedef std::chrono::microseconds microseconds;
+typedef std::chrono::milliseconds milliseconds;
+
+// The synthetic chain is deterministic for a given set of options and seed.
+// It extends the regtest genesis block (no retarget, trivial proof of work).
+// Coinbase outputs mature before they are spent, so the first blocks are a
+// warm-up that is organized but excluded from the stage statistics.
+
+static const uint32_t block_version = 4;
+static const uint32_t timestamp_base = 1500000000;
+static const uint64_t transaction_fee = 1000;
+static const size_t regtest_subsidy_interval = 150;
+static const auto notify_timeout = std::chrono::seconds(10);
+
+enum class script_type
+{
+    anyone,
+    pay_script_hash,
+    pay_key_hash
+};
+
+struct options
+{
+    size_t blocks = 1000;
+    size_t transactions = 100;
+    size_t inputs = 2;
+    size_t outputs = 2;
+    script_type type = script_type::anyone;
+    size_t depth = 1;
+    size_t fork_interval = 0;
+    size_t fork_depth = 0;
+    uint64_t seed = 0;
+};
+
+struct spendable
+{
+    output_point point;
+    uint64_t value;
+    size_t height;
+};
+
+// The generator state at a given top, restorable at a fork point.
+struct generator_state
+{
+    hash_digest top;
+    size_t height;
+    std::vector<spendable> unspent;
+    std::deque<spendable> immature;
+};
+
+class generator
+{
+public:
+    generator(const options& settings, const chain::block& genesis)
+      : options_(settings), random_(settings.seed),
+        bits_(genesis.header().bits()), forks_(0)
+    {
+        secret_ = sha256_hash(to_chunk(std::string("benchchain")));
+        secret_to_public(point_, secret_);
+        redeem_ = script(operation::list{ { opcode::push_positive_1 } });
+        state_.top = genesis.hash();
+        state_.height = 0;
+    }
+
+    // The number of blocks required to mature the first coinbase.
+    size_t warmup() const
+    {
+        return coinbase_maturity;
+    }
+
+    // Generate the next block, or the blocks of a reorganizing fork.
+    block_const_ptr_list next()
+    {
+        block_const_ptr_list blocks;
+        const auto fork = options_.fork_interval != 0 &&
+            options_.fork_depth != 0 && state_.height > warmup() &&
+            state_.height % options_.fork_interval == 0 &&
+            history_.size() >= options_.fork_depth;
+
+        if (!fork)
+        {
+            blocks.push_back(generate(0));
+            return blocks;
+        }
+
+        // Restore the fork point and extend it beyond the current top.
+        // The history holds the state preceding each of the recent blocks.
+        ++forks_;
+        history_.resize(history_.size() - options_.fork_depth + 1);
+        state_ = history_.back();
+        history_.pop_back();
+
+        for (size_t block = 0; block <= options_.fork_depth; ++block)
+            blocks.push_back(generate(forks_));
+
+        return blocks;
+    }
+
+private:
+    // The regtest subsidy is a lower bound on that of any other network.
+    static uint64_t subsidy(size_t height)
+    {
+        const auto halvings = height / regtest_subsidy_interval;
+        return halvings >= 64 ? 0 :
+            initial_block_subsidy_satoshi() >> halvings;
+    }
+
+    script output_script() const
+    {
+        switch (options_.type)
+        {
+            case script_type::pay_script_hash:
+                return script(script::to_pay_script_hash_pattern(
+                    bitcoin_short_hash(redeem_.to_data(false))));
+            case script_type::pay_key_hash:
+                return script(script::to_pay_key_hash_pattern(
+                    bitcoin_short_hash(point_)));
+            default:
+            case script_type::anyone:
+                return script(operation::list{ { opcode::push_positive_1 } });
+        }
+    }
+
+    script input_script(const transaction& tx, uint32_t index,
+        const script& prevout_script) const
+    {
+        switch (options_.type)
+        {
+            case script_type::pay_script_hash:
+                return script(operation::list{ { redeem_.to_data(false) } });
+            case script_type::pay_key_hash:
+            {
+                endorsement signature;
+                script::create_endorsement(signature, secret_,
+                    prevout_script, tx, index,
+                    static_cast<uint8_t>(sighash_algorithm::all));
+                return script(operation::list{ { signature },
+                    { to_chunk(point_) } });
+            }
+            default:
+            case script_type::anyone:
+                return{};
+        }
+    }
+
+    // Split value over the output count, leaving at least one output.
+    output::list split(uint64_t value, size_t count) const
+    {
+        const auto outputs = std::max<size_t>(std::min<uint64_t>(count,
+            value), 1);
+        const auto script = output_script();
+        output::list result;
+        result.reserve(outputs);
+
+        for (size_t output = 0; output < outputs; ++output)
+            result.emplace_back(value / outputs + (output == 0 ?
+                value % outputs : 0), script);
+
+        return result;
+    }
+
+    // Draw a random mature output, if any.
+    bool draw(spendable& out)
+    {
+        auto& unspent = state_.unspent;
+
+        if (unspent.empty())
+            return false;
+
+        std::uniform_int_distribution<size_t> distribution(0,
+            unspent.size() - 1);
+        auto& drawn = unspent[distribution(random_)];
+        out = drawn;
+        drawn = unspent.back();
+        unspent.pop_back();
+        return true;
+    }
+
+    transaction spend(const std::vector<spendable>& prevouts,
+        uint64_t& fees) const
+    {
+        uint64_t value = 0;
+        input::list inputs;
+        inputs.reserve(prevouts.size());
+
+        for (const auto& prevout: prevouts)
+        {
+            value += prevout.value;
+            inputs.emplace_back(prevout.point, script{}, max_input_sequence);
+        }
+
+        const auto fee = std::min(value, transaction_fee);
+        fees += fee;
+        transaction tx(1, 0, std::move(inputs),
+            split(value - fee, options_.outputs));
+
+        if (options_.type == script_type::anyone)
+            return tx;
+
+        // Sign each input against the completed transaction.
+        const auto prevout_script = output_script();
+        auto signed_inputs = tx.inputs();
+
+        for (uint32_t index = 0; index < signed_inputs.size(); ++index)
+            signed_inputs[index].set_script(input_script(tx, index,
+                prevout_script));
+
+        tx.set_inputs(std::move(signed_inputs));
+        return tx;
+    }
+
+    block_const_ptr generate(uint32_t variant)
+    {
+        // Retain the state preceding each block that a fork may replace.
+        if (options_.fork_depth != 0)
+        {
+            history_.push_back(state_);
+            if (history_.size() > options_.fork_depth)
+                history_.pop_front();
+        }
+
+        const auto height = state_.height + 1;
+
+        // Move coinbase outputs that have matured into the spendable set.
+        while (!state_.immature.empty() &&
+            state_.immature.front().height + coinbase_maturity <= height)
+        {
+            state_.unspent.push_back(state_.immature.front());
+            state_.immature.pop_front();
+        }
+
+        uint64_t fees = 0;
+        transaction::list txs(1);
+        std::vector<spendable> created;
+
+        for (size_t count = 1; count < options_.transactions; ++count)
+        {
+            std::vector<spendable> prevouts;
+
+            // Chain to the previous transaction up to the dependency depth.
+            if ((count - 1) % options_.depth != 0 && !created.empty())
+            {
+                prevouts.push_back(created.back());
+                created.pop_back();
+            }
+
+            spendable prevout;
+            while (prevouts.size() < options_.inputs && draw(prevout))
+                prevouts.push_back(prevout);
+
+            if (prevouts.empty())
+                break;
+
+            txs.push_back(spend(prevouts, fees));
+            const auto& tx = txs.back();
+            const auto hash = tx.hash();
+            const auto& outputs = tx.outputs();
+
+            // The first output is last so that it is the one chained.
+            for (auto index = outputs.size(); index > 0; --index)
+            {
+                const auto position = static_cast<uint32_t>(index - 1);
+                created.push_back({ output_point{ hash, position },
+                    outputs[position].value(), height });
+            }
+        }
+
+        // Each coinbase funds the inputs of one full block when matured.
+        const auto coinbase_outputs = std::max(options_.outputs,
+            options_.transactions * options_.inputs);
+
+        // The height is pushed non-minimally as required by bip34.
+        const operation::list coinbase_script
+        {
+            { number(height).data(), false },
+            { to_chunk(to_little_endian(variant)) }
+        };
+
+        txs.front() = transaction(1, 0,
+            { { output_point{ null_hash, point::null_index },
+                script(coinbase_script),
+                max_input_sequence } },
+            split(subsidy(height) + fees, coinbase_outputs));
+
+        const auto coinbase = txs.front().hash();
+        const auto& outputs = txs.front().outputs();
+
+        for (uint32_t index = 0; index < outputs.size(); ++index)
+            state_.immature.push_back({ output_point{ coinbase, index },
+                outputs[index].value(), height });
+
+        state_.unspent.insert(state_.unspent.end(), created.begin(),
+            created.end());
+
+        chain::block block;
+        block.set_transactions(std::move(txs));
+
+        chain::header header(block_version, state_.top,
+            block.generate_merkle_root(), timestamp_base + height, bits_, 0);
+
+        // Regtest proof of work is satisfied by about half of all nonces.
+        while (!header.is_valid_proof_of_work(false))
+            header.set_nonce(header.nonce() + 1);
+
+        block.set_header(header);
+        state_.top = header.hash();
+        state_.height = height;
+        return std::make_shared<const message::block>(std::move(block));
+    }
+
+    const options& options_;
+    std::mt19937_64 random_;
+    const uint32_t bits_;
+    uint32_t forks_;
+    ec_secret secret_;
+    ec_compressed point_;
+    script redeem_;
+    generator_state state_;
+    std::deque<generator_state> history_;
+};
+
+// Stage timing.
+// ----------------------------------------------------------------------------
+
+// Stages are measured from the block validation timestamps, from the call to
+// organize (wait) through the subscriber notification (notify).
+static const std::vector<std::string> stage_names
+{
+    "wait", "check", "populate", "accept", "connect", "reorganize", "notify"
+};
+
+typedef std::map<std::string, std::vector<double>> stage_samples;
+
+static double span(const asio::time_point& begin, const asio::time_point& end)
+{
+    if (end <= begin)
+        return 0;
+
+    const auto duration = end - begin;
+    return std::chrono::duration_cast<microseconds>(duration).count();
+}
+
+class notifications
+{
+public:
+    bool handle(const code& ec, size_t, block_const_ptr_list_const_ptr incoming,
+        block_const_ptr_list_const_ptr outgoing)
+    {
+        if (ec == error::service_stopped)
+            return false;
+
+        if (ec || !incoming || incoming->empty())
+            return true;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        delivered_[incoming->back()->hash()] = asio::steady_clock::now();
+        reorganizations_ += (outgoing && !outgoing->empty()) ? 1 : 0;
+        delivery_.notify_all();
+        return true;
+    }
+
+    asio::time_point wait(const hash_digest& hash)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        delivery_.wait_for(lock, notify_timeout, [&]()
+        {
+            return delivered_.find(hash) != delivered_.end();
+        });
+
+        const auto it = delivered_.find(hash);
+        if (it == delivered_.end())
+            return{};
+
+        const auto time = it->second;
+        delivered_.erase(it);
+        return time;
+    }
+
+    size_t reorganizations() const
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return reorganizations_;
+    }
+
+private:
+    size_t reorganizations_ = 0;
+    std::unordered_map<hash_digest, asio::time_point> delivered_;
+    mutable std::mutex mutex_;
+    std::condition_variable delivery_;
+};
+
+static void record(stage_samples& samples, const message::block& block,
+    const asio::time_point& start, const asio::time_point& organized,
+    const asio::time_point& delivered)
+{
+    const auto& times = block.validation;
+    samples["wait"].push_back(span(start, times.start_check));
+    samples["check"].push_back(span(times.start_check, times.start_populate));
+    samples["populate"].push_back(span(times.start_populate,
+        times.start_accept));
+    samples["accept"].push_back(span(times.start_accept, times.start_connect));
+    samples["connect"].push_back(span(times.start_connect,
+        times.start_notify));
+
+    // Pooled blocks are not written to the store or notified.
+    if (delivered == asio::time_point{})
+        return;
+
+    samples["reorganize"].push_back(span(times.start_notify, organized));
+    samples["notify"].push_back(span(organized, delivered));
+}
+
+// Nearest rank percentile of sorted samples.
+static double percentile(const std::vector<double>& sorted, size_t percent)
+{
+    if (sorted.empty())
+        return 0;
+
+    const auto rank = (percent * sorted.size() + 99) / 100;
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static void write_stage(std::ostream& out, const std::string& name,
+    std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    double total = 0;
+    for (const auto sample: samples)
+        total += sample;
+
+    const auto count = samples.size();
+    out << format("    \"%1%\": { \"count\": %2%, \"total_us\": %3$.0f, "
+        "\"mean_us\": %4$.1f, \"p50_us\": %5$.0f, \"p90_us\": %6$.0f, "
+        "\"p99_us\": %7$.0f, \"max_us\": %8$.0f }") % name % count % total %
+        (count == 0 ? 0.0 : total / count) % percentile(samples, 50) %
+        percentile(samples, 90) % percentile(samples, 99) %
+        (count == 0 ? 0.0 : samples.back());
+}
+
+static std::string script_name(script_type type)
+{
+    switch (type)
+    {
+        case script_type::pay_script_hash:
+            return "p2sh";
+        case script_type::pay_key_hash:
+            return "p2pkh";
+        default:
+        case script_type::anyone:
+            return "true";
+    }
+}
+
+static bool parse(options& out, int argc, char** argv)
+{
+    for (auto arg = 2; arg < argc; ++arg)
+    {
+        const std::string option(argv[arg]);
+
+        if (arg + 1 == argc)
+            return false;
+
+        const std::string value(argv[++arg]);
+
+        if (option == "--blocks")
+            out.blocks = std::stoul(value);
+        else if (option == "--transactions")
+            out.transactions = std::max<size_t>(std::stoul(value), 1);
+        else if (option == "--inputs")
+            out.inputs = std::max<size_t>(std::stoul(value), 1);
+        else if (option == "--outputs")
+            out.outputs = std::max<size_t>(std::stoul(value), 1);
+        else if (option == "--depth")
+            out.depth = std::max<size_t>(std::stoul(value), 1);
+        else if (option == "--fork-interval")
+            out.fork_interval = std::stoul(value);
+        else if (option == "--fork-depth")
+            out.fork_depth = std::stoul(value);
+        else if (option == "--seed")
+            out.seed = std::stoull(value);
+        else if (option == "--script" && value == "true")
+            out.type = script_type::anyone;
+        else if (option == "--script" && value == "p2sh")
+            out.type = script_type::pay_script_hash;
+        else if (option == "--script" && value == "p2pkh")
+            out.type = script_type::pay_key_hash;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+static bool create(const path& prefix, const chain::block& genesis)
+{
+    boost::system::error_code code;
+    remove_all(prefix, code);
+
+    if (!create_directories(prefix, code))
+        return false;
+
+    database::settings settings(config::settings::regtest);
+    settings.directory = prefix;
+    return data_base(settings).create(genesis);
+}
+
+static code organize(block_chain& chain, block_const_ptr block)
+{
+    std::promise<code> complete;
+    chain.organize(block, [&](const code& ec) { complete.set_value(ec); });
+    return complete.get_future().get();
+}
+
+// Benchmark block organization over a synthetic chain, reporting JSON.
+int main(int argc, char** argv)
+{
+    options settings;
+    if (argc < 2 || !parse(settings, argc, argv))
+    {
+        std::cerr << BS_BENCHCHAIN_USAGE;
+        return -1;
+    }
+
+    const path store(argv[1]);
+    const auto genesis = chain::block::genesis_regtest();
+
+    if (!create(store, genesis))
+    {
+        std::cerr << format(BS_BENCHCHAIN_CREATE_FAIL) % store;
+        return -1;
+    }
+
+    // Generate the chain in advance so that it is excluded from timing.
+    generator source(settings, genesis);
+    std::vector<block_const_ptr_list> sequence;
+    const auto total = source.warmup() + settings.blocks;
+    size_t generated = 0;
+    size_t transactions = 0;
+    size_t inputs = 0;
+    const auto generate_start = clock_type::now();
+
+    while (generated < total)
+    {
+        sequence.push_back(source.next());
+
+        for (const auto& block: sequence.back())
+        {
+            ++generated;
+            transactions += block->transactions().size();
+            inputs += block->total_inputs(false);
+        }
+    }
+
+    const auto generate_span = clock_type::now() - generate_start;
+    std::cerr << format(BS_BENCHCHAIN_GENERATED) % generated % transactions %
+        inputs % std::chrono::duration_cast<milliseconds>(
+            generate_span).count();
+
+    threadpool pool(2);
+    database::settings database_settings(config::settings::regtest);
+    database_settings.directory = store;
+    blockchain::settings chain_settings(config::settings::regtest);
+    block_chain chain(pool, chain_settings, database_settings);
+
+    if (!chain.start())
+    {
+        std::cerr << format(BS_BENCHCHAIN_START_FAIL) % store;
+        return -1;
+    }
+
+    notifications delivery;
+    chain.subscribe_blockchain(std::bind(&notifications::handle, &delivery,
+        std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
+        std::placeholders::_4));
+
+    stage_samples samples;
+    size_t height = 0;
+    size_t measured = 0;
+    size_t pooled = 0;
+    transactions = 0;
+    inputs = 0;
+    size_t bytes = 0;
+    clock_type::duration elapsed{};
+    auto result = 0;
+
+    for (const auto& blocks: sequence)
+    {
+        // The fork blocks reuse heights of the blocks that they replace.
+        height -= blocks.size() - 1;
+
+        for (const auto& block: blocks)
+        {
+            const auto block_height = ++height;
+            const auto start = asio::steady_clock::now();
+            const auto ec = organize(chain, block);
+            const auto organized = asio::steady_clock::now();
+
+            if (ec && ec != error::insufficient_work)
+            {
+                std::cerr << format(BS_BENCHCHAIN_ORGANIZE_FAIL) %
+                    encode_hash(block->hash()) % block_height % ec.message();
+                result = -1;
+                break;
+            }
+
+            const auto delivered = ec ? asio::time_point{} :
+                delivery.wait(block->hash());
+
+            if (block_height <= source.warmup())
+                continue;
+
+            ++measured;
+            pooled += ec ? 1 : 0;
+            transactions += block->transactions().size();
+            inputs += block->total_inputs(false);
+            bytes += block->chain::block::serialized_size(true);
+            elapsed += organized - start;
+            record(samples, *block, start, organized, delivered);
+        }
+
+        if (result != 0)
+            break;
+    }
+
+    const auto seconds = std::max(std::chrono::duration_cast<microseconds>(
+        elapsed).count(), microseconds::rep(1)) / 1e6;
+
+    std::cout << "{\n";
+    std::cout << format("  \"options\": { \"blocks\": %1%, "
+        "\"transactions\": %2%, \"inputs\": %3%, \"outputs\": %4%, "
+        "\"script\": \"%5%\", \"depth\": %6%, \"fork_interval\": %7%, "
+        "\"fork_depth\": %8%, \"seed\": %9% },\n") % settings.blocks %
+        settings.transactions % settings.inputs % settings.outputs %
+        script_name(settings.type) % settings.depth % settings.fork_interval %
+        settings.fork_depth % settings.seed;
+    std::cout << format("  \"blocks\": %1%,\n  \"pooled\": %2%,\n"
+        "  \"reorganizations\": %3%,\n  \"transactions\": %4%,\n"
+        "  \"inputs\": %5%,\n  \"bytes\": %6%,\n  \"seconds\": %7$.3f,\n") %
+        measured % pooled % delivery.reorganizations() % transactions %
+        inputs % bytes % seconds;
+    std::cout << format("  \"blocks_per_second\": %1$.1f,\n"
+        "  \"transactions_per_second\": %2$.1f,\n"
+        "  \"inputs_per_second\": %3$.1f,\n"
+        "  \"bytes_per_second\": %4$.1f,\n") % (measured / seconds) %
+        (transactions / seconds) % (inputs / seconds) % (bytes / seconds);
+    std::cout << "  \"stages\": {\n";
+
+    for (size_t stage = 0; stage < stage_names.size(); ++stage)
+    {
+        const auto& name = stage_names[stage];
+        write_stage(std::cout, name, samples[name]);
+        std::cout << (stage + 1 < stage_names.size() ? ",\n" : "\n");
+    }
+
+    std::cout << "  }\n}\n";
+
+    chain.stop();
+    pool.shutdown();
+    pool.join();
+    chain.close();
+    return result;
+}
@@ -0,0 +1,248 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/format.hpp>
+#include <bitcoin/blockchain.hpp>
+
+#define BS_BENCHLOCK_USAGE \
+    "Usage: benchlock [--transactions <threads>] [--blocks <count>]\n" \
+    "    [--block-hold <us>] [--block-gap <us>] [--transaction-hold <us>]\n" \
+    "    [--fairness <limit>]\n"
+
+using namespace bc;
+using namespace bc::blockchain;
+using boost::format;
+
+typedef validation_mutex::caller caller;
+
+// Measurement.
+// ----------------------------------------------------------------------------
+
+struct options
+{
+    size_t transactions = 4;
+    size_t blocks = 200;
+    size_t block_hold = 2000;
+    size_t block_gap = 500;
+    size_t transaction_hold = 50;
+    size_t fairness = 16;
+};
+
+struct result
+{
+    std::string name;
+    double seconds;
+    latency_histogram::summary block_waits;
+    latency_histogram::summary transaction_waits;
+};
+
+static std::vector<result> results;
+
+// Lock work is simulated by spinning, as validation is compute bound.
+static void spin(size_t microseconds)
+{
+    const auto end = asio::steady_clock::now() +
+        std::chrono::microseconds(microseconds);
+
+    while (asio::steady_clock::now() < end);
+}
+
+// A single block thread organizes blocks with a gap between arrivals, while
+// transaction threads contend continuously until the blocks are complete.
+template <typename Lock, typename Unlock>
+static void measure(const std::string& name, const options& settings,
+    Lock lock, Unlock unlock)
+{
+    latency_histogram block_waits;
+    latency_histogram transaction_waits;
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+    const auto start = asio::steady_clock::now();
+
+    for (size_t thread = 0; thread < settings.transactions; ++thread)
+    {
+        threads.emplace_back([&]()
+        {
+            while (!done)
+            {
+                const auto waiting = asio::steady_clock::now();
+                lock(false);
+                transaction_waits.record(asio::steady_clock::now() - waiting);
+                spin(settings.transaction_hold);
+                unlock(false);
+            }
+        });
+    }
+
+    for (size_t block = 0; block < settings.blocks; ++block)
+    {
+        spin(settings.block_gap);
+        const auto waiting = asio::steady_clock::now();
+        lock(true);
+        block_waits.record(asio::steady_clock::now() - waiting);
+        spin(settings.block_hold);
+        unlock(true);
+    }
+
+    done = true;
+
+    for (auto& thread: threads)
+        thread.join();
+
+    const auto span = asio::steady_clock::now() - start;
+    results.push_back(
+    {
+        name,
+        std::chrono::duration_cast<std::chrono::microseconds>(span).count() /
+            1e6,
+        block_waits.snapshot(),
+        transaction_waits.snapshot()
+    });
+
+    std::cerr << name << std::endl;
+}
+
+static std::string to_json(const latency_histogram::summary& value)
+{
+    return (format("{ \"count\": %1%, \"p50\": %2%, \"p90\": %3%, "
+        "\"p99\": %4%, \"maximum\": %5% }") % value.count % value.p50 %
+        value.p90 % value.p99 % value.maximum).str();
+}
+
+static void write_results(std::ostream& out, const options& settings)
+{
+    out << "{\n";
+    out << format("  \"options\": { \"transactions\": %1%, \"blocks\": %2%, "
+        "\"block_hold\": %3%, \"block_gap\": %4%, \"transaction_hold\": %5%, "
+        "\"fairness\": %6% },\n") % settings.transactions % settings.blocks %
+        settings.block_hold % settings.block_gap % settings.transaction_hold %
+        settings.fairness;
+    out << "  \"benchmarks\": [\n";
+
+    for (size_t index = 0; index < results.size(); ++index)
+    {
+        const auto& item = results[index];
+        const auto seconds = std::max(item.seconds, 1e-6);
+
+        out << format("    { \"name\": \"%1%\", \"seconds\": %2$.6f, "
+            "\"transactions_per_second\": %3$.1f,\n"
+            "      \"block_wait_us\": %4%,\n"
+            "      \"transaction_wait_us\": %5% }") %
+            item.name % seconds %
+            (item.transaction_waits.count / seconds) %
+            to_json(item.block_waits) % to_json(item.transaction_waits);
+
+        out << (index + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n}\n";
+}
+
+// Locks.
+// ----------------------------------------------------------------------------
+
+static void prioritized(const options& settings)
+{
+    prioritized_mutex mutex(true);
+
+    measure("prioritized_mutex", settings,
+        [&](bool high)
+        {
+            high ? mutex.lock_high_priority() : mutex.lock_low_priority();
+        },
+        [&](bool high)
+        {
+            high ? mutex.unlock_high_priority() : mutex.unlock_low_priority();
+        });
+}
+
+static void validation(const std::string& name, const options& settings,
+    size_t fairness)
+{
+    validation_mutex mutex(true, fairness);
+
+    measure(name, settings,
+        [&](bool high)
+        {
+            high ? mutex.lock_high_priority(caller::block) :
+                mutex.lock_low_priority(caller::transaction);
+        },
+        [&](bool high)
+        {
+            high ? mutex.unlock_high_priority() : mutex.unlock_low_priority();
+        });
+
+    std::cerr << validation_mutex::to_string(mutex.statistics()) << std::endl;
+}
+
+static bool parse(options& out, int argc, char** argv)
+{
+    for (auto arg = 1; arg < argc; ++arg)
+    {
+        const std::string option(argv[arg]);
+
+        if (arg + 1 == argc)
+            return false;
+
+        const auto value = std::stoul(argv[++arg]);
+
+        if (option == "--transactions")
+            out.transactions = value;
+        else if (option == "--blocks")
+            out.blocks = std::max<size_t>(value, 1);
+        else if (option == "--block-hold")
+            out.block_hold = value;
+        else if (option == "--block-gap")
+            out.block_gap = value;
+        else if (option == "--transaction-hold")
+            out.transaction_hold = value;
+        else if (option == "--fairness")
+            out.fairness = value;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+// Benchmark the validation lock under mixed block/transaction contention,
+// against the prioritized mutex it replaces, reporting JSON.
+int main(int argc, char** argv)
+{
+    options settings;
+    if (!parse(settings, argc, argv))
+    {
+        std::cerr << BS_BENCHLOCK_USAGE;
+        return -1;
+    }
+
+    prioritized(settings);
+    validation("validation_mutex.strict", settings, 0);
+    validation("validation_mutex.fair", settings, settings.fairness);
+    write_results(std::cout, settings);
+    return 0;
+}
@@ -0,0 +1,601 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <boost/format.hpp>
+#include <bitcoin/blockchain.hpp>
+
+#define BS_BENCHPOOL_USAGE \
+    "Usage: benchpool [--chain <count>] [--fanout <count>] [--pool <count>]\n" \
+    "    [--batch <count>] [--fork <count>] [--repeat <count>]\n"
+
+using namespace bc;
+using namespace bc::blockchain;
+using namespace bc::chain;
+using boost::format;
+
+typedef std::chrono::steady_clock clock_type;
+typedef std::chrono::nanoseconds nanoseconds;
+
+// Allocation accounting.
+// ----------------------------------------------------------------------------
+// The global allocator is replaced in order to count allocations and to track
+// the peak of allocated bytes. Each allocation is prefixed with its size.
+
+static const size_t prefix_size = 16;
+static std::atomic<size_t> allocations(0);
+static std::atomic<size_t> allocated_bytes(0);
+static std::atomic<size_t> current_bytes(0);
+static std::atomic<size_t> peak_bytes(0);
+
+static void* allocate(size_t size) noexcept
+{
+    const auto block = static_cast<uint8_t*>(std::malloc(size + prefix_size));
+
+    if (block == nullptr)
+        return nullptr;
+
+    *reinterpret_cast<size_t*>(block) = size;
+    ++allocations;
+    allocated_bytes += size;
+    const auto current = current_bytes += size;
+    auto peak = peak_bytes.load();
+
+    while (current > peak && !peak_bytes.compare_exchange_weak(peak, current));
+    return block + prefix_size;
+}
+
+static void deallocate(void* pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+
+    const auto block = static_cast<uint8_t*>(pointer) - prefix_size;
+    current_bytes -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+void* operator new(size_t size)
+{
+    const auto pointer = allocate(size);
+
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+
+    return pointer;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    deallocate(pointer);
+}
+
+// Measurement.
+// ----------------------------------------------------------------------------
+
+struct options
+{
+    size_t chain = 1000;
+    size_t fanout = 1000;
+    size_t pool = 300000;
+    size_t batch = 1000;
+    size_t fork = 1000;
+    size_t repeat = 100;
+};
+
+struct result
+{
+    std::string name;
+    size_t operations;
+    uint64_t nanoseconds;
+    size_t allocations;
+    size_t bytes;
+    size_t peak;
+};
+
+static std::vector<result> results;
+
+// Setup is performed by the caller, only the operation loop is measured.
+// The peak is the high water mark of allocated bytes above the baseline.
+static void measure(const std::string& name, size_t operations,
+    std::function<void()> operation)
+{
+    const auto baseline = current_bytes.load();
+    peak_bytes = baseline;
+    const auto allocations_start = allocations.load();
+    const auto bytes_start = allocated_bytes.load();
+    const auto start = clock_type::now();
+
+    operation();
+
+    const auto span = clock_type::now() - start;
+    results.push_back(
+    {
+        name,
+        operations,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<nanoseconds>(span).count()),
+        allocations - allocations_start,
+        allocated_bytes - bytes_start,
+        peak_bytes - baseline
+    });
+
+    std::cerr << name << std::endl;
+}
+
+static void write_results(std::ostream& out, const options& settings)
+{
+    out << "{\n";
+    out << format("  \"options\": { \"chain\": %1%, \"fanout\": %2%, "
+        "\"pool\": %3%, \"batch\": %4%, \"fork\": %5%, \"repeat\": %6% },\n") %
+        settings.chain % settings.fanout % settings.pool % settings.batch %
+        settings.fork % settings.repeat;
+    out << "  \"benchmarks\": [\n";
+
+    for (size_t index = 0; index < results.size(); ++index)
+    {
+        const auto& item = results[index];
+        const auto operations = std::max<size_t>(item.operations, 1);
+        const auto seconds = std::max<uint64_t>(item.nanoseconds, 1) / 1e9;
+
+        out << format("    { \"name\": \"%1%\", \"operations\": %2%, "
+            "\"seconds\": %3$.6f, \"operations_per_second\": %4$.1f, "
+            "\"allocations_per_operation\": %5$.1f, "
+            "\"bytes_per_operation\": %6$.1f, \"peak_bytes\": %7% }") %
+            item.name % item.operations % seconds %
+            (item.operations / seconds) %
+            (static_cast<double>(item.allocations) / operations) %
+            (static_cast<double>(item.bytes) / operations) % item.peak;
+
+        out << (index + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n}\n";
+}
+
+// Transaction shapes.
+// ----------------------------------------------------------------------------
+
+static const uint64_t prevout_value = 100000;
+static const uint64_t transaction_fee = 1000;
+
+static chain_state::ptr make_state()
+{
+    chain_state::data data;
+    data.height = 1;
+    data.bits = { 0, { 0 } };
+    data.version = { 1, { 0 } };
+    data.timestamp = { 0, 0, { 0 } };
+    return std::make_shared<chain_state>(chain_state{ std::move(data), {},
+        0u });
+}
+
+// Prevout values are cached on the points so that fees are computable.
+static transaction_const_ptr make_transaction(chain_state::ptr state,
+    const std::vector<output_point>& prevouts, size_t outputs)
+{
+    input::list inputs;
+    inputs.reserve(prevouts.size());
+
+    for (auto prevout: prevouts)
+    {
+        prevout.validation.cache.set_value(prevout_value);
+        inputs.emplace_back(std::move(prevout), script{}, max_input_sequence);
+    }
+
+    const auto value = (prevout_value * prevouts.size() - transaction_fee) /
+        outputs;
+
+    output::list outs;
+    outs.reserve(outputs);
+
+    for (size_t output = 0; output < outputs; ++output)
+        outs.emplace_back(value, script{});
+
+    const auto tx = std::make_shared<const message::transaction>(
+        message::transaction{ 1, 0, std::move(inputs), std::move(outs) });
+
+    tx->validation.state = state;
+    tx->hash();
+    return tx;
+}
+
+// An external (confirmed) prevout, unique for each value of the seed.
+static output_point external(size_t seed)
+{
+    return{ sha256_hash(to_chunk(to_little_endian<uint64_t>(seed))), 0 };
+}
+
+// Each transaction spends the first output of its predecessor (CPFP).
+static transaction_const_ptr_list make_chain(chain_state::ptr state,
+    size_t length, size_t seed)
+{
+    transaction_const_ptr_list txs;
+    txs.reserve(length);
+    txs.push_back(make_transaction(state, { external(seed) }, 1));
+
+    for (size_t tx = 1; tx < length; ++tx)
+        txs.push_back(make_transaction(state,
+            { { txs.back()->hash(), 0 } }, 1));
+
+    return txs;
+}
+
+// The first transaction is spent by each of the others, one output each.
+static transaction_const_ptr_list make_fanout(chain_state::ptr state,
+    size_t width, size_t seed)
+{
+    transaction_const_ptr_list txs;
+    txs.reserve(width + 1);
+    txs.push_back(make_transaction(state, { external(seed) }, width));
+
+    for (uint32_t index = 0; index < width; ++index)
+        txs.push_back(make_transaction(state,
+            { { txs.front()->hash(), index } }, 1));
+
+    return txs;
+}
+
+// Each transaction spends a distinct external output.
+static transaction_const_ptr_list make_independent(chain_state::ptr state,
+    size_t count, size_t seed)
+{
+    transaction_const_ptr_list txs;
+    txs.reserve(count);
+
+    for (size_t tx = 0; tx < count; ++tx)
+        txs.push_back(make_transaction(state, { external(seed + tx) }, 2));
+
+    return txs;
+}
+
+// Entry graphs, linked parent to child as in the calculator tests.
+static transaction_entry::list make_entries(
+    const transaction_const_ptr_list& txs)
+{
+    transaction_entry::list entries;
+    entries.reserve(txs.size());
+
+    for (const auto& tx: txs)
+    {
+        entries.push_back(std::make_shared<transaction_entry>(tx));
+        const auto& child = entries.back();
+        uint32_t index = 0;
+
+        for (const auto& input: tx->inputs())
+        {
+            const auto& hash = input.previous_output().hash();
+            const auto parent = std::find_if(entries.begin(), entries.end(),
+                [&](const transaction_entry::ptr& entry)
+                {
+                    return entry->hash() == hash;
+                });
+
+            if (parent != entries.end() && *parent != child)
+            {
+                (*parent)->add_child(index, child);
+                child->add_parent(*parent);
+            }
+
+            ++index;
+        }
+    }
+
+    return entries;
+}
+
+static void sever(transaction_entry::list& entries)
+{
+    for (const auto& entry: entries)
+    {
+        entry->remove_children();
+        entry->remove_parents();
+    }
+}
+
+static transaction_const_ptr_list slice(const transaction_const_ptr_list& txs,
+    size_t begin, size_t end)
+{
+    return{ txs.begin() + begin, txs.begin() + std::min(end, txs.size()) };
+}
+
+// Block shapes.
+// ----------------------------------------------------------------------------
+
+static block_const_ptr make_block(uint32_t id, size_t height,
+    const hash_digest& parent)
+{
+    const auto block = std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, parent, null_hash, 0, 0, 0 }, {}
+    });
+
+    block->header().validation.height = height;
+    return block;
+}
+
+// A side fork of the given depth rooted above height one.
+static block_const_ptr_list make_fork(size_t depth)
+{
+    block_const_ptr_list blocks;
+    blocks.reserve(depth);
+    auto parent = null_hash;
+
+    for (size_t block = 0; block < depth; ++block)
+    {
+        blocks.push_back(make_block(block, block + 1, parent));
+        parent = blocks.back()->hash();
+    }
+
+    return blocks;
+}
+
+// Benchmarks.
+// ----------------------------------------------------------------------------
+
+static void transaction_pool_add(const options& settings,
+    chain_state::ptr state)
+{
+    blockchain::settings chain_settings;
+
+    {
+        transaction_pool pool(chain_settings);
+        const auto txs = make_chain(state, settings.chain, 0);
+        measure("transaction_pool.add.cpfp_chain", txs.size(), [&]()
+        {
+            for (const auto& tx: txs)
+                pool.add_unconfirmed_transactions({ tx });
+        });
+
+        auto confirmed = txs;
+        measure("transaction_pool.remove.cpfp_chain", 1, [&]()
+        {
+            pool.remove_transactions(confirmed);
+        });
+    }
+
+    {
+        transaction_pool pool(chain_settings);
+        const auto txs = make_fanout(state, settings.fanout, 1);
+        measure("transaction_pool.add.fan_out", txs.size(), [&]()
+        {
+            for (const auto& tx: txs)
+                pool.add_unconfirmed_transactions({ tx });
+        });
+
+        auto confirmed = slice(txs, 0, 1);
+        measure("transaction_pool.remove.fan_out_parent", 1, [&]()
+        {
+            pool.remove_transactions(confirmed);
+        });
+    }
+
+    {
+        transaction_pool pool(chain_settings);
+        const auto txs = make_independent(state, settings.pool, 2);
+        const auto batches = (txs.size() + settings.batch - 1) /
+            settings.batch;
+
+        measure("transaction_pool.add.large_pool", txs.size(), [&]()
+        {
+            for (size_t batch = 0; batch < batches; ++batch)
+                pool.add_unconfirmed_transactions(slice(txs,
+                    batch * settings.batch, (batch + 1) * settings.batch));
+        });
+
+        // Confirm one batch, as in a block, against the full pool.
+        auto confirmed = slice(txs, 0, settings.batch);
+        measure("transaction_pool.remove.large_pool", confirmed.size(), [&]()
+        {
+            pool.remove_transactions(confirmed);
+        });
+    }
+}
+
+static void calculators(const options& settings, chain_state::ptr state)
+{
+    transaction_pool_state pool_state;
+
+    auto chain = make_entries(make_chain(state, settings.chain, 3));
+    measure("priority_calculator.cpfp_chain", settings.repeat, [&]()
+    {
+        for (size_t repeat = 0; repeat < settings.repeat; ++repeat)
+        {
+            priority_calculator calculator;
+            calculator.enqueue(chain.back());
+            calculator.prioritize();
+        }
+    });
+
+    measure("parent_closure_calculator.cpfp_chain", settings.repeat, [&]()
+    {
+        for (size_t repeat = 0; repeat < settings.repeat; ++repeat)
+        {
+            parent_closure_calculator calculator(pool_state);
+            calculator.get_closure(chain.back());
+        }
+    });
+
+    measure("transaction_order_calculator.cpfp_chain", settings.repeat, [&]()
+    {
+        for (size_t repeat = 0; repeat < settings.repeat; ++repeat)
+        {
+            transaction_order_calculator calculator;
+            for (const auto& entry: chain)
+                calculator.enqueue(entry);
+
+            calculator.order_transactions();
+        }
+    });
+
+    sever(chain);
+
+    auto fanout = make_entries(make_fanout(state, settings.fanout, 4));
+    measure("child_closure_calculator.fan_out", settings.repeat, [&]()
+    {
+        for (size_t repeat = 0; repeat < settings.repeat; ++repeat)
+        {
+            child_closure_calculator calculator(pool_state);
+            calculator.get_closure(fanout.front());
+        }
+    });
+
+    sever(fanout);
+}
+
+static void block_pool_fork(const options& settings)
+{
+    const auto fork = make_fork(settings.fork);
+
+    {
+        block_pool pool(settings.fork + 1);
+        measure("block_pool.add.side_fork", fork.size(), [&]()
+        {
+            for (const auto& block: fork)
+                pool.add(block);
+        });
+
+        const auto tip = make_block(settings.fork, settings.fork + 1,
+            fork.empty() ? null_hash : fork.back()->hash());
+
+        measure("block_pool.get_path.side_fork", settings.repeat, [&]()
+        {
+            for (size_t repeat = 0; repeat < settings.repeat; ++repeat)
+                pool.get_path(tip);
+        });
+
+        // Each filter mutates its message, so copies are made in advance.
+        message::get_data request;
+        for (const auto& block: fork)
+            request.inventories().push_back(
+                { message::inventory::type_id::block, block->hash() });
+
+        std::vector<get_data_ptr> requests;
+        for (size_t repeat = 0; repeat < settings.repeat; ++repeat)
+            requests.push_back(std::make_shared<message::get_data>(request));
+
+        measure("block_pool.filter.side_fork", settings.repeat, [&]()
+        {
+            for (const auto& message: requests)
+                pool.filter(message);
+        });
+    }
+
+    {
+        // Independent roots, one pruned by each successive top height.
+        block_pool pool(1);
+        for (size_t root = 0; root < settings.fork; ++root)
+            pool.add(make_block(root, root + 1, sha256_hash(
+                to_chunk(to_little_endian<uint64_t>(root)))));
+
+        measure("block_pool.prune.roots", settings.fork, [&]()
+        {
+            for (size_t top = 3; top < settings.fork + 3; ++top)
+                pool.prune(top);
+        });
+    }
+}
+
+static bool parse(options& out, int argc, char** argv)
+{
+    for (auto arg = 1; arg < argc; ++arg)
+    {
+        const std::string option(argv[arg]);
+
+        if (arg + 1 == argc)
+            return false;
+
+        const auto value = std::max<size_t>(std::stoul(argv[++arg]), 1);
+
+        if (option == "--chain")
+            out.chain = value;
+        else if (option == "--fanout")
+            out.fanout = value;
+        else if (option == "--pool")
+            out.pool = value;
+        else if (option == "--batch")
+            out.batch = value;
+        else if (option == "--fork")
+            out.fork = value;
+        else if (option == "--repeat")
+            out.repeat = value;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+// Benchmark the transaction and block pools, reporting JSON.
+int main(int argc, char** argv)
+{
+    options settings;
+    if (!parse(settings, argc, argv))
+    {
+        std::cerr << BS_BENCHPOOL_USAGE;
+        return -1;
+    }
+
+    const auto state = make_state();
+    transaction_pool_add(settings, state);
+    calculators(settings, state);
+    block_pool_fork(settings);
+    write_results(std::cout, settings);
+    return 0;
+}
@@ -0,0 +1,502 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/filesystem.hpp>
+#include <bitcoin/blockchain.hpp>
+#include <bitcoin/database.hpp>
+
+#define BS_IMPORTCHAIN_USAGE \
+    "Usage: importchain <store> <blocks> [--insert] [--threads <count>]\n"
+#define BS_IMPORTCHAIN_START_FAIL \
+    "Failed to start the blockchain in %1%.\n"
+#define BS_IMPORTCHAIN_BLOCKS_FAIL \
+    "Failed to read block files in %1%.\n"
+#define BS_IMPORTCHAIN_ORGANIZE_FAIL \
+    "Failed to organize block [%1%] at height %2% with error, '%3%'.\n"
+#define BS_IMPORTCHAIN_HEADER_FAIL \
+    "Failed to organize header [%1%] at height %2% with error, '%3%'.\n"
+#define BS_IMPORTCHAIN_PROGRESS \
+    "[%1%] %2% blocks/s, %3% txs/s, %4% inputs/s " \
+    "(read %5% ms, deserialize %6% ms, organize %7% ms)\n"
+#define BS_IMPORTCHAIN_COMPLETE \
+    "Imported %1% blocks, %2% txs, %3% inputs in %4% s, %5% unlinked.\n"
+
+using namespace bc;
+using namespace bc::blockchain;
+using namespace bc::chain;
+using namespace bc::database;
+using namespace boost::filesystem;
+using boost::format;
+
+typedef std::chrono::steady_clock clock_type;
+typedef std::chrono::milliseconds milliseconds;
+
+// Stages: one reader, multiple deserializers, one organizer (this thread).
+// Block files are not in height order, so blocks are linked to organized
+// blocks by previous block hash before being organized (or inserted under
+// checkpoint). Block files also contain stale blocks, so every child of an
+// organized block is organized, and the organizer selects the branch by
+// work. The header of each block is organized first, as insertion requires
+// the block to be in the header index.
+
+static const size_t queue_limit = 1024;
+static const size_t insert_limit = 256;
+static const size_t report_interval = 10000;
+
+/// Bounded blocking queue, closed by the producer(s).
+template <typename Element>
+class pipe
+{
+public:
+    pipe(size_t limit, size_t producers)
+      : limit_(limit), producers_(producers)
+    {
+    }
+
+    void push(Element&& element)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return queue_.size() < limit_; });
+        queue_.push_back(std::move(element));
+        not_empty_.notify_one();
+    }
+
+    bool pop(Element& out)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]()
+        {
+            return !queue_.empty() || producers_ == 0;
+        });
+
+        if (queue_.empty())
+            return false;
+
+        out = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        --producers_;
+        not_empty_.notify_all();
+    }
+
+private:
+    const size_t limit_;
+    size_t producers_;
+    std::deque<Element> queue_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
+struct statistics
+{
+    std::atomic<size_t> blocks;
+    std::atomic<size_t> transactions;
+    std::atomic<size_t> inputs;
+    std::atomic<size_t> read_ms;
+    std::atomic<size_t> deserialize_ms;
+    std::atomic<size_t> organize_ms;
+};
+
+static size_t elapsed(const clock_type::time_point& start)
+{
+    const auto span = clock_type::now() - start;
+    return std::chrono::duration_cast<milliseconds>(span).count();
+}
+
+static void report(const statistics& stats, size_t height,
+    const clock_type::time_point& start)
+{
+    const auto seconds = std::max(elapsed(start), size_t(1)) / 1000.0;
+
+    std::cout << format(BS_IMPORTCHAIN_PROGRESS) % height %
+        static_cast<size_t>(stats.blocks / seconds) %
+        static_cast<size_t>(stats.transactions / seconds) %
+        static_cast<size_t>(stats.inputs / seconds) %
+        stats.read_ms % stats.deserialize_ms % stats.organize_ms;
+}
+
+// The blk*.dat files in name order.
+static bool block_files(std::vector<path>& out, const path& directory)
+{
+    boost::system::error_code ec;
+    if (!is_directory(directory, ec))
+        return false;
+
+    for (directory_iterator it(directory), end; it != end; ++it)
+    {
+        const auto name = it->path().filename().string();
+
+        if (name.size() > 3 && name.substr(0, 3) == "blk" &&
+            it->path().extension() == ".dat")
+            out.push_back(it->path());
+    }
+
+    std::sort(out.begin(), out.end());
+    return !out.empty();
+}
+
+// Each record is { magic[4], size[4], block[size] }, zero padded at end.
+static void read_files(const std::vector<path>& files,
+    pipe<data_chunk>& raw, statistics& stats)
+{
+    for (const auto& file: files)
+    {
+        auto start = clock_type::now();
+        bc::ifstream stream(file.string(), std::ios::binary);
+        istream_reader source(stream);
+
+        while (true)
+        {
+            const auto magic = source.read_4_bytes_little_endian();
+            const auto size = source.read_4_bytes_little_endian();
+
+            if (!source || magic == 0 || size == 0)
+                break;
+
+            auto data = source.read_bytes(size);
+
+            if (!source)
+                break;
+
+            stats.read_ms += elapsed(start);
+            raw.push(std::move(data));
+            start = clock_type::now();
+        }
+    }
+
+    raw.close();
+}
+
+static void deserialize(pipe<data_chunk>& raw,
+    pipe<block_const_ptr>& blocks, statistics& stats)
+{
+    data_chunk data;
+
+    while (raw.pop(data))
+    {
+        const auto start = clock_type::now();
+        const auto block = std::make_shared<message::block>();
+
+        if (!block->chain::block::from_data(data, true))
+            continue;
+
+        // Cache block and transaction hashes ahead of the organizer.
+        block->hash();
+        for (const auto& tx: block->transactions())
+            tx.hash();
+
+        stats.deserialize_ms += elapsed(start);
+        blocks.push(block);
+    }
+
+    blocks.close();
+}
+
+// Insert asynchronously under the top checkpoint, with bounded concurrency.
+class inserter
+{
+public:
+    inserter(block_chain& chain)
+      : chain_(chain), pending_(0), failed_(false)
+    {
+    }
+
+    void insert(block_const_ptr block, size_t height)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_.wait(lock, [this]() { return pending_ < insert_limit; });
+        ++pending_;
+        lock.unlock();
+
+        chain_.organize(block, height, [=](const code& ec)
+        {
+            if (ec)
+            {
+                std::cerr << format(BS_IMPORTCHAIN_ORGANIZE_FAIL) %
+                    encode_hash(block->hash()) % height % ec.message();
+                failed_ = true;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            --pending_;
+            drained_.notify_all();
+        });
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    // True if any insert has failed, after which the import must stop.
+    bool failed() const
+    {
+        return failed_;
+    }
+
+private:
+    block_chain& chain_;
+    size_t pending_;
+    std::atomic<bool> failed_;
+    std::mutex mutex_;
+    std::condition_variable drained_;
+};
+
+static code organize(block_chain& chain, block_const_ptr block)
+{
+    std::promise<code> complete;
+    chain.organize(block, [&](const code& ec) { complete.set_value(ec); });
+    return complete.get_future().get();
+}
+
+static code organize(block_chain& chain, header_const_ptr header)
+{
+    std::promise<code> complete;
+    chain.organize(header, [&](const code& ec) { complete.set_value(ec); });
+    return complete.get_future().get();
+}
+
+// A stale block is pooled, and a stored block or header is a duplicate.
+static bool is_organized(const code& ec)
+{
+    return !ec || ec == error::insufficient_work ||
+        ec == error::duplicate_block;
+}
+
+// Import blocks from a directory of raw block files into the store.
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << BS_IMPORTCHAIN_USAGE;
+        return -1;
+    }
+
+    const path store(argv[1]);
+    const path directory(argv[2]);
+    auto insert = false;
+    size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (auto arg = 3; arg < argc; ++arg)
+    {
+        const std::string option(argv[arg]);
+
+        if (option == "--insert")
+            insert = true;
+        else if (option == "--threads" && arg + 1 < argc)
+            threads = std::max<size_t>(std::stoul(argv[++arg]), 1);
+        else
+        {
+            std::cerr << BS_IMPORTCHAIN_USAGE;
+            return -1;
+        }
+    }
+
+    std::vector<path> files;
+    if (!block_files(files, directory))
+    {
+        std::cerr << format(BS_IMPORTCHAIN_BLOCKS_FAIL) % directory;
+        return -1;
+    }
+
+    threadpool pool(2);
+    database::settings database_settings(config::settings::mainnet);
+    database_settings.directory = store;
+    blockchain::settings chain_settings(config::settings::mainnet);
+    block_chain chain(pool, chain_settings, database_settings);
+
+    size_t height;
+    hash_digest top;
+
+    if (!chain.start() || !chain.get_last_height(height) ||
+        !chain.get_block_hash(top, height))
+    {
+        std::cerr << format(BS_IMPORTCHAIN_START_FAIL) % store;
+        return -1;
+    }
+
+    const auto checkpoints = config::checkpoint::sort(
+        chain_settings.checkpoints);
+    const auto checkpoint = checkpoints.empty() ? 0 :
+        checkpoints.back().height();
+
+    statistics stats{};
+    pipe<data_chunk> raw(queue_limit, 1);
+    pipe<block_const_ptr> blocks(queue_limit, threads);
+    std::vector<std::thread> workers;
+
+    const auto start = clock_type::now();
+    workers.emplace_back(read_files, std::cref(files), std::ref(raw),
+        std::ref(stats));
+
+    for (size_t thread = 0; thread < threads; ++thread)
+        workers.emplace_back(deserialize, std::ref(raw), std::ref(blocks),
+            std::ref(stats));
+
+    inserter inserts(chain);
+    std::unordered_multimap<hash_digest, block_const_ptr> unlinked;
+    std::unordered_map<hash_digest, size_t> heights{ { top, height } };
+    std::vector<hash_digest> linked;
+    block_const_ptr block;
+    auto result = 0;
+    auto reported = height;
+
+    while (result == 0 && blocks.pop(block))
+    {
+        const auto& parent = block->header().previous_block_hash();
+        unlinked.emplace(parent, block);
+
+        if (heights.find(parent) != heights.end())
+            linked.push_back(parent);
+
+        // Organize every block that now links to an organized block.
+        while (result == 0 && !linked.empty())
+        {
+            const auto hash = linked.back();
+            linked.pop_back();
+            const auto children = unlinked.equal_range(hash);
+            const auto siblings = std::distance(children.first,
+                children.second);
+            const auto next_height = heights[hash] + 1u;
+
+            std::vector<block_const_ptr> nexts;
+            for (auto it = children.first; it != children.second; ++it)
+                nexts.push_back(it->second);
+
+            unlinked.erase(children.first, children.second);
+
+            for (const auto& next: nexts)
+            {
+                const auto organize_start = clock_type::now();
+                const auto header = std::make_shared<const message::header>(
+                    next->header());
+
+                auto ec = organize(chain, header);
+
+                if (!is_organized(ec))
+                {
+                    std::cerr << format(BS_IMPORTCHAIN_HEADER_FAIL) %
+                        encode_hash(next->hash()) % next_height %
+                        ec.message();
+                    result = -1;
+                    break;
+                }
+
+                // Only a single child of the top can be inserted, as the
+                // insert path does not select between competing branches.
+                if (insert && next_height <= checkpoint && hash == top &&
+                    siblings == 1)
+                {
+                    inserts.insert(next, next_height);
+                    top = next->hash();
+                }
+                else
+                {
+                    // Organization requires all inserts to be complete.
+                    inserts.wait();
+                    ec = organize(chain, next);
+
+                    if (!is_organized(ec))
+                    {
+                        std::cerr << format(BS_IMPORTCHAIN_ORGANIZE_FAIL) %
+                            encode_hash(next->hash()) % next_height %
+                            ec.message();
+                        result = -1;
+                        break;
+                    }
+
+                    size_t top_height;
+                    if (!chain.get_last_height(top_height) ||
+                        !chain.get_block_hash(top, top_height))
+                    {
+                        std::cerr << format(BS_IMPORTCHAIN_START_FAIL) % store;
+                        result = -1;
+                        break;
+                    }
+                }
+
+                if (inserts.failed())
+                {
+                    result = -1;
+                    break;
+                }
+
+                stats.organize_ms += elapsed(organize_start);
+                stats.blocks++;
+                stats.transactions += next->transactions().size();
+                stats.inputs += next->total_inputs(false);
+                heights[next->hash()] = next_height;
+                linked.push_back(next->hash());
+                height = std::max(height, next_height);
+
+                if (height >= reported + report_interval)
+                {
+                    reported = height;
+                    report(stats, height, start);
+                }
+            }
+        }
+    }
+
+    // Drain the pipeline so that the stages can be joined.
+    while (blocks.pop(block));
+    for (auto& worker: workers)
+        worker.join();
+
+    inserts.wait();
+
+    if (inserts.failed())
+        result = -1;
+
+    report(stats, height, start);
+    std::cout << format(BS_IMPORTCHAIN_COMPLETE) % stats.blocks %
+        stats.transactions % stats.inputs % (elapsed(start) / 1000) %
+        unlinked.size();
+
+    chain.stop();
+    pool.shutdown();
+    pool.join();
+    chain.close();
+    return result;
+}
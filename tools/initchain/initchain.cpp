@@ -16,7 +16,14 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 #include <boost/format.hpp>
 #include <boost/filesystem.hpp>
 #include <bitcoin/blockchain.hpp>
@@ -28,6 +35,27 @@
     "Failed because the directory %1% already exists.\n"
 #define BS_INITCHAIN_FAIL \
     "Failed to initialize blockchain files.\n"
+#define BS_INITCHAIN_OPEN_FAIL \
+    "Failed to open blockchain files in %1%.\n"
+#define BS_INITCHAIN_HEIGHT_FAIL \
+    "Failed because height %1% is above the top block.\n"
+#define BS_INITCHAIN_SNAPSHOT_OPEN_FAIL \
+    "Failed to open snapshot file %1%.\n"
+#define BS_INITCHAIN_SNAPSHOT_READ_FAIL \
+    "Failed reading snapshot at height %1%.\n"
+#define BS_INITCHAIN_SNAPSHOT_WRITE_FAIL \
+    "Failed writing snapshot at height %1%.\n"
+#define BS_INITCHAIN_SNAPSHOT_ANCHOR_FAIL \
+    "Failed because snapshot block [%1%] is not the expected block.\n"
+#define BS_INITCHAIN_SNAPSHOT_HEADER_FAIL \
+    "Failed verifying snapshot header %1% with error, '%2%'.\n"
+#define BS_INITCHAIN_SNAPSHOT_DIGEST_FAIL \
+    "Failed because snapshot digest [%1%] is not the expected value.\n"
+#define BS_INITCHAIN_HASH_FAIL \
+    "Failed because '%1%' is not a valid hash.\n"
+#define BS_INITCHAIN_SNAPSHOT_COMPLETE \
+    "Snapshot to height %1% [%2%] digest [%3%] commitment [%4%], " \
+    "%5% transactions, %6% outputs.\n"
 
 using namespace bc;
 using namespace bc::blockchain;
@@ -37,17 +65,57 @@ using namespace boost::filesystem;
 using namespace boost::system;
 using boost::format;
 
-// Create a new mainnet blockchain database.
-int main(int argc, char** argv)
-{
-    std::string prefix("mainnet");
+// UTXO snapshot format (all integers little endian):
+// file:   magic[4] version[4] height[4] hash[32] frame[height + 1]
+// frame:  size[varint] block[size] checksum[4]
+// block:  header[80] count[varint] transaction[count]
+// transaction: hash[32] count[varint] { unspent[1] (output) }[count]
+// A frame is written for each block, with the coinbase always included so
+// that positions retain coinbase identity. Spent outputs are elided.
+//
+// A snapshot is not self-authenticating. Bootstrap requires the expected
+// snapshot digest (as printed by export from a trusted store), verifies the
+// digest and the header chain to the snapshot block, and only then creates
+// the store. The digest is a sequential sha256 over the file, each frame
+// hashed with the digest of the preceding bytes:
+// digest: sha256(magic version height hash), then sha256(digest frame).
+// The utxo commitment is a sum of output hashes, so a set of outputs with a
+// chosen sum can be found (generalized birthday), and it is not used to
+// authenticate a snapshot. It is computed from the authenticated outputs.
+// The bootstrapped transactions have no inputs, so bodies to the snapshot
+// height are marked as unavailable (see block_chain::pruned_height) and are
+// never served.
 
-    if (argc > 1)
-        prefix = argv[1];
+static const uint32_t snapshot_magic = 0x6f787475;
+static const uint32_t snapshot_version = 1;
+static const size_t median_time_past_interval = 11;
 
-    if (argc > 2 && std::string("--clean") == argv[2])
-        boost::filesystem::remove_all(prefix);
+// These files are read by block_chain at start.
+static const std::string bootstrap_file = "bootstrap";
+static const std::string commitment_file = "utxo_commitment";
+
+// The digest of the snapshot preamble, which anchors the frame chain.
+static hash_digest preamble_digest(size_t height, const hash_digest& hash)
+{
+    data_chunk preamble;
+    data_sink stream(preamble);
+    ostream_writer sink(stream);
+    sink.write_4_bytes_little_endian(snapshot_magic);
+    sink.write_4_bytes_little_endian(snapshot_version);
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    sink.write_hash(hash);
+    stream.flush();
+    return sha256_hash(preamble);
+}
 
+// Chain the frame to the digest of the preceding snapshot bytes.
+static void chain_digest(hash_digest& digest, const data_chunk& frame)
+{
+    digest = sha256_hash(build_chunk({ digest, frame }));
+}
+
+static bool create(const path& prefix)
+{
     error_code code;
     if (!create_directories(prefix, code))
     {
@@ -57,16 +125,463 @@ int main(int argc, char** argv)
             std::cerr << format(BS_INITCHAIN_DIR_NEW) % prefix %
                 code.message();
 
-        return -1;
+        return false;
     }
 
     database::settings settings(config::settings::mainnet);
+    settings.directory = prefix;
 
     if (!data_base(settings).create(block::genesis_mainnet()))
     {
         std::cerr << BS_INITCHAIN_FAIL;
+        return false;
+    }
+
+    return true;
+}
+
+// Serialize the block frame with spent (at the snapshot height) outputs
+// elided, and increment the transaction and output counts.
+static bool write_frame(writer& sink, block_chain& chain, const block& block,
+    size_t snapshot_height, hash_digest& digest, utxo_commitment& commitment,
+    size_t& transactions, size_t& outputs)
+{
+    // The genesis coinbase is not spendable, so it is not committed.
+    const auto committed = block.hash() != block::genesis_mainnet().hash();
+
+    data_chunk frame;
+    data_sink stream(frame);
+    ostream_writer frame_sink(stream);
+    block.header().to_data(frame_sink);
+
+    std::vector<std::pair<const transaction*, std::vector<bool>>> unspents;
+    const auto& txs = block.transactions();
+
+    for (size_t position = 0; position < txs.size(); ++position)
+    {
+        const auto& tx = txs[position];
+        std::vector<bool> unspent(tx.outputs().size(), false);
+        auto any = (position == 0);
+
+        for (uint32_t index = 0; index < unspent.size(); ++index)
+        {
+            output out;
+            size_t height;
+            uint32_t median_time_past;
+            bool coinbase;
+            const output_point point{ tx.hash(), index };
+
+            if (!chain.get_output(out, height, median_time_past, coinbase,
+                point, snapshot_height, true))
+                return false;
+
+            const auto spender = out.validation.spender_height;
+            unspent[index] = (spender == output::validation::not_spent ||
+                spender > snapshot_height);
+            any |= unspent[index];
+        }
+
+        if (any)
+            unspents.emplace_back(&tx, std::move(unspent));
+    }
+
+    frame_sink.write_variable_little_endian(unspents.size());
+
+    for (const auto& entry: unspents)
+    {
+        const auto& tx = *entry.first;
+        frame_sink.write_hash(tx.hash());
+        frame_sink.write_variable_little_endian(entry.second.size());
+
+        for (size_t index = 0; index < entry.second.size(); ++index)
+        {
+            frame_sink.write_byte(entry.second[index] ? 1 : 0);
+
+            if (entry.second[index])
+            {
+                const auto& out = tx.outputs()[index];
+                out.to_data(frame_sink);
+                ++outputs;
+
+                if (committed)
+                    commitment.add({ tx.hash(), static_cast<uint32_t>(index) },
+                        out);
+            }
+        }
+
+        ++transactions;
+    }
+
+    stream.flush();
+    chain_digest(digest, frame);
+    sink.write_variable_little_endian(frame.size());
+    sink.write_bytes(frame);
+    sink.write_4_bytes_little_endian(bitcoin_checksum(frame));
+    return static_cast<bool>(sink);
+}
+
+// Export the unspent output set at the given height.
+static int export_snapshot(const path& prefix, size_t height,
+    const path& file)
+{
+    threadpool pool(1);
+    database::settings database_settings(config::settings::mainnet);
+    database_settings.directory = prefix;
+    blockchain::settings chain_settings(config::settings::mainnet);
+    block_chain chain(pool, chain_settings, database_settings);
+
+    size_t top;
+    hash_digest hash;
+
+    if (!chain.start() || !chain.get_last_height(top))
+    {
+        std::cerr << format(BS_INITCHAIN_OPEN_FAIL) % prefix;
         return -1;
     }
 
+    if (height > top || !chain.get_block_hash(hash, height))
+    {
+        std::cerr << format(BS_INITCHAIN_HEIGHT_FAIL) % height;
+        return -1;
+    }
+
+    bc::ofstream stream(file.string(), std::ios::binary);
+    ostream_writer sink(stream);
+
+    if (stream.bad())
+    {
+        std::cerr << format(BS_INITCHAIN_SNAPSHOT_OPEN_FAIL) % file;
+        return -1;
+    }
+
+    sink.write_4_bytes_little_endian(snapshot_magic);
+    sink.write_4_bytes_little_endian(snapshot_version);
+    sink.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    sink.write_hash(hash);
+
+    size_t transactions = 0;
+    size_t outputs = 0;
+    utxo_commitment commitment;
+    auto digest = preamble_digest(height, hash);
+
+    for (size_t current = 0; current <= height; ++current)
+    {
+        block_const_ptr block;
+        const auto handler = [&](const code& ec, block_const_ptr result,
+            size_t)
+        {
+            block = ec ? nullptr : result;
+        };
+
+        // The block fetch handler is invoked on the calling thread.
+        chain.fetch_block(current, false, handler);
+
+        if (!block || !write_frame(sink, chain, *block, height, digest,
+            commitment, transactions, outputs))
+        {
+            std::cerr << format(BS_INITCHAIN_SNAPSHOT_WRITE_FAIL) % current;
+            return -1;
+        }
+    }
+
+    stream.flush();
+    std::cout << format(BS_INITCHAIN_SNAPSHOT_COMPLETE) % height %
+        encode_hash(hash) % encode_hash(digest) %
+        encode_hash(commitment.value()) % transactions % outputs;
+
+    chain.stop();
+    pool.shutdown();
+    pool.join();
+    return chain.close() ? 0 : -1;
+}
+
+// Deserialize a checksummed frame into a block of pruned transactions, with the
+// original transaction hashes. Elided outputs are replaced by unspendable
+// placeholders so that output indexes are preserved.
+static bool read_frame(reader& source, block& out_block, hash_digest& digest,
+    utxo_commitment& commitment, size_t& transactions, size_t& outputs)
+{
+    const auto size = source.read_size_little_endian();
+    const auto frame = source.read_bytes(size);
+    const auto checksum = source.read_4_bytes_little_endian();
+
+    if (!source || bitcoin_checksum(frame) != checksum)
+        return false;
+
+    chain_digest(digest, frame);
+
+    data_source stream(frame);
+    istream_reader frame_source(stream);
+    const script unspendable(machine::operation::list
+    {
+        { machine::opcode::return_ }
+    });
+
+    header header;
+    if (!header.from_data(frame_source))
+        return false;
+
+    // The genesis coinbase is not spendable, so it is not committed.
+    const auto committed = header.hash() != block::genesis_mainnet().hash();
+
+    transaction::list txs;
+    const auto count = frame_source.read_size_little_endian();
+
+    for (size_t tx = 0; tx < count && frame_source; ++tx)
+    {
+        auto hash = frame_source.read_hash();
+        output::list outs(frame_source.read_size_little_endian());
+
+        for (uint32_t index = 0; index < outs.size(); ++index)
+        {
+            auto& out = outs[index];
+
+            if (frame_source.read_byte() == 0)
+            {
+                out = output{ 0, unspendable };
+                continue;
+            }
+
+            if (!out.from_data(frame_source))
+                return false;
+
+            if (committed)
+                commitment.add({ hash, index }, out);
+
+            ++outputs;
+        }
+
+        txs.emplace_back(transaction{ 1, 0, input::list{}, std::move(outs) },
+            std::move(hash));
+        ++transactions;
+    }
+
+    out_block = block{ std::move(header), std::move(txs) };
+    return static_cast<bool>(frame_source);
+}
+
+// Open the snapshot and read its height and top block hash.
+static bool open_snapshot(bc::ifstream& stream, reader& source,
+    size_t& out_height, hash_digest& out_hash)
+{
+    if (stream.bad() ||
+        source.read_4_bytes_little_endian() != snapshot_magic ||
+        source.read_4_bytes_little_endian() != snapshot_version)
+        return false;
+
+    out_height = source.read_4_bytes_little_endian();
+    out_hash = source.read_hash();
+    return static_cast<bool>(source);
+}
+
+// Verify the digest of the snapshot and the header chain from genesis to the
+// snapshot block, before anything is stored.
+static bool verify_snapshot(const path& file,
+    const hash_digest& expected_digest)
+{
+    bc::ifstream stream(file.string(), std::ios::binary);
+    istream_reader source(stream);
+
+    size_t height;
+    hash_digest hash;
+
+    if (!open_snapshot(stream, source, height, hash))
+    {
+        std::cerr << format(BS_INITCHAIN_SNAPSHOT_OPEN_FAIL) % file;
+        return false;
+    }
+
+    // The index links, retargets and checkpoints each header.
+    const blockchain::settings settings(config::settings::mainnet);
+    header_index headers(settings);
+    headers.start(block::genesis_mainnet().header());
+
+    size_t transactions = 0;
+    size_t outputs = 0;
+    utxo_commitment commitment;
+    auto digest = preamble_digest(height, hash);
+
+    for (size_t current = 0; current <= height; ++current)
+    {
+        block next;
+
+        if (!read_frame(source, next, digest, commitment, transactions,
+            outputs))
+        {
+            std::cerr << format(BS_INITCHAIN_SNAPSHOT_READ_FAIL) % current;
+            return false;
+        }
+
+        const auto ec = current == 0 ?
+            (next.hash() == block::genesis_mainnet().hash() ?
+                error::success : error::checkpoints_failed) :
+            headers.add({ next.header() });
+
+        if (ec)
+        {
+            std::cerr << format(BS_INITCHAIN_SNAPSHOT_HEADER_FAIL) % current %
+                ec.message();
+            return false;
+        }
+    }
+
+    if (digest != expected_digest)
+    {
+        std::cerr << format(BS_INITCHAIN_SNAPSHOT_DIGEST_FAIL) %
+            encode_hash(digest);
+        return false;
+    }
+
+    if (!headers.is_indexed(hash, height))
+    {
+        std::cerr << format(BS_INITCHAIN_SNAPSHOT_ANCHOR_FAIL) %
+            encode_hash(hash);
+        return false;
+    }
+
+    return true;
+}
+
+// Record the snapshot height, below which bodies are unavailable, and the
+// verified commitment at the snapshot top.
+static bool mark_bootstrap(const path& prefix, size_t height,
+    const hash_digest& hash, const hash_digest& commitment)
+{
+    bc::ofstream bootstrap((prefix / bootstrap_file).string(),
+        std::ios::binary);
+    ostream_writer bootstrap_sink(bootstrap);
+    bootstrap_sink.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    bootstrap.flush();
+
+    bc::ofstream committed((prefix / commitment_file).string(),
+        std::ios::binary);
+    ostream_writer commitment_sink(committed);
+    commitment_sink.write_hash(hash);
+    commitment_sink.write_4_bytes_little_endian(static_cast<uint32_t>(height));
+    commitment_sink.write_hash(commitment);
+    committed.flush();
+
+    return bootstrap_sink && commitment_sink && !bootstrap.bad() &&
+        !committed.bad();
+}
+
+// Create a new store from a verified snapshot, to the snapshot height.
+static int bootstrap(const path& prefix, const path& file,
+    const hash_digest& expected_digest)
+{
+    if (!verify_snapshot(file, expected_digest))
+        return -1;
+
+    bc::ifstream stream(file.string(), std::ios::binary);
+    istream_reader source(stream);
+
+    size_t height;
+    hash_digest hash;
+
+    if (!open_snapshot(stream, source, height, hash) || !create(prefix))
+        return -1;
+
+    database::settings settings(config::settings::mainnet);
+    settings.directory = prefix;
+    data_base database(settings);
+
+    if (!database.open() || !database.begin_insert())
+    {
+        std::cerr << format(BS_INITCHAIN_OPEN_FAIL) % prefix;
+        return -1;
+    }
+
+    size_t transactions = 0;
+    size_t outputs = 0;
+    utxo_commitment commitment;
+    auto digest = preamble_digest(height, hash);
+    std::deque<uint32_t> timestamps;
+
+    for (size_t current = 0; current <= height; ++current)
+    {
+        block next;
+
+        // The file is verified, but may not be changed while reading.
+        if (!read_frame(source, next, digest, commitment, transactions,
+            outputs))
+        {
+            std::cerr << format(BS_INITCHAIN_SNAPSHOT_READ_FAIL) % current;
+            return -1;
+        }
+
+        // The median time past is the median of the preceding timestamps.
+        auto window = timestamps;
+        std::sort(window.begin(), window.end());
+        next.header().validation.median_time_past =
+            window.empty() ? 0 : window[window.size() / 2];
+
+        timestamps.push_back(next.header().timestamp());
+        if (timestamps.size() > median_time_past_interval)
+            timestamps.pop_front();
+
+        // The genesis block is stored at creation.
+        if (current == 0)
+            continue;
+
+        if (database.insert(next, current) != error::success)
+        {
+            std::cerr << format(BS_INITCHAIN_SNAPSHOT_WRITE_FAIL) % current;
+            return -1;
+        }
+    }
+
+    if (digest != expected_digest)
+    {
+        std::cerr << format(BS_INITCHAIN_SNAPSHOT_DIGEST_FAIL) %
+            encode_hash(digest);
+        return -1;
+    }
+
+    if (!database.end_insert() || !database.close() ||
+        !mark_bootstrap(prefix, height, hash, commitment.value()))
+    {
+        std::cerr << BS_INITCHAIN_FAIL;
+        return -1;
+    }
+
+    std::cout << format(BS_INITCHAIN_SNAPSHOT_COMPLETE) % height %
+        encode_hash(hash) % encode_hash(digest) %
+        encode_hash(commitment.value()) % transactions % outputs;
     return 0;
 }
+
+static bool parse_hash(hash_digest& out_hash, const std::string& text)
+{
+    if (decode_hash(out_hash, text))
+        return true;
+
+    std::cerr << format(BS_INITCHAIN_HASH_FAIL) % text;
+    return false;
+}
+
+// Create a new mainnet blockchain database.
+// initchain [prefix] [--clean]
+// initchain <prefix> --export <height> <file>
+// initchain <prefix> --bootstrap <file> <snapshot digest>
+int main(int argc, char** argv)
+{
+    std::string prefix("mainnet");
+
+    if (argc > 1)
+        prefix = argv[1];
+
+    if (argc > 4 && std::string("--export") == argv[2])
+        return export_snapshot(prefix, std::stoul(argv[3]), argv[4]);
+
+    if (argc > 4 && std::string("--bootstrap") == argv[2])
+    {
+        hash_digest digest;
+        return parse_hash(digest, argv[4]) ?
+            bootstrap(prefix, argv[3], digest) : -1;
+    }
+
+    if (argc > 2 && std::string("--clean") == argv[2])
+        boost::filesystem::remove_all(prefix);
+
+    return create(prefix) ? 0 : -1;
+}